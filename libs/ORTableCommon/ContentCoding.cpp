@@ -0,0 +1,371 @@
+#include "ContentCoding.h"
+
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <limits>
+
+#ifdef ORTABLE_WITH_ZLIB
+#include <zlib.h>
+#endif
+#ifdef ORTABLE_WITH_ZSTD
+#include <zstd.h>
+#endif
+
+using namespace ORTable;
+
+namespace
+{
+    constexpr std::size_t DECOMPRESS_CHUNK_SIZE{64 * 1024};
+
+    std::string trim(const std::string& p_value)
+    {
+        const auto first = p_value.find_first_not_of(" \t");
+        if(first == std::string::npos)
+        {
+            return std::string();
+        }
+        const auto last = p_value.find_last_not_of(" \t");
+        return p_value.substr(first, last - first + 1);
+    }
+
+    std::string toLower(std::string p_value)
+    {
+        std::transform(p_value.begin(), p_value.end(), p_value.begin(), [](unsigned char p_char) {
+            return static_cast<char>(std::tolower(p_char));
+        });
+        return p_value;
+    }
+
+    struct AcceptedCoding
+    {
+        std::string name;
+        double quality;
+    };
+
+    // "gzip;q=0.8, zstd, *;q=0" -> {gzip, 0.8}, {zstd, 1}, {*, 0}
+    std::vector<AcceptedCoding> parseAcceptEncoding(const std::string& p_header)
+    {
+        std::vector<AcceptedCoding> result;
+        std::size_t start = 0;
+        while(start <= p_header.size())
+        {
+            auto end = p_header.find(',', start);
+            if(end == std::string::npos)
+            {
+                end = p_header.size();
+            }
+            const auto element = p_header.substr(start, end - start);
+            start = end + 1;
+
+            const auto separator = element.find(';');
+            AcceptedCoding coding{toLower(trim(element.substr(0, separator))), 1.0};
+            if(coding.name.empty())
+            {
+                continue;
+            }
+            if(separator != std::string::npos)
+            {
+                const auto parameter = trim(element.substr(separator + 1));
+                if(parameter.size() > 2 && (parameter[0] == 'q' || parameter[0] == 'Q') && parameter[1] == '=')
+                {
+                    coding.quality = std::strtod(parameter.c_str() + 2, nullptr);
+                }
+            }
+            result.push_back(coding);
+        }
+        return result;
+    }
+
+#if defined(ORTABLE_WITH_ZLIB) || defined(ORTABLE_WITH_ZSTD)
+    // Only the compressors take a level, unused (and warned about) without them
+    int clampLevel(int p_level, int p_min, int p_max)
+    {
+        return std::max(p_min, std::min(p_level, p_max));
+    }
+#endif
+} // namespace
+
+bool ContentCoding::isSupported(ContentEncoding p_encoding)
+{
+    switch(p_encoding)
+    {
+        case ContentEncoding::Identity:
+            return true;
+        case ContentEncoding::Gzip:
+#ifdef ORTABLE_WITH_ZLIB
+            return true;
+#else
+            return false;
+#endif
+        case ContentEncoding::Zstd:
+#ifdef ORTABLE_WITH_ZSTD
+            return true;
+#else
+            return false;
+#endif
+    }
+    return false;
+}
+
+const char* ContentCoding::toString(ContentEncoding p_encoding)
+{
+    switch(p_encoding)
+    {
+        case ContentEncoding::Gzip:
+            return "gzip";
+        case ContentEncoding::Zstd:
+            return "zstd";
+        case ContentEncoding::Identity:
+            break;
+    }
+    return "identity";
+}
+
+bool ContentCoding::fromString(const std::string& p_name, ContentEncoding& p_encoding)
+{
+    const auto name = toLower(trim(p_name));
+    if(name == "gzip" || name == "x-gzip")
+    {
+        p_encoding = ContentEncoding::Gzip;
+    }
+    else if(name == "zstd")
+    {
+        p_encoding = ContentEncoding::Zstd;
+    }
+    else if(name == "identity" || name.empty())
+    {
+        p_encoding = ContentEncoding::Identity;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+std::string ContentCoding::makeAcceptEncoding(const CompressionConfig& p_config)
+{
+    std::string header;
+    if(!p_config.enabled)
+    {
+        return header;
+    }
+    // q-values step down in preference order: 1, 0.9, 0.8, ...
+    int quality = 10;
+    for(const auto encoding : p_config.preferred)
+    {
+        if(encoding == ContentEncoding::Identity || !isSupported(encoding) || quality <= 1)
+        {
+            continue;
+        }
+        if(!header.empty())
+        {
+            header += ", ";
+        }
+        header += toString(encoding);
+        if(quality < 10)
+        {
+            header += ";q=0." + std::to_string(quality);
+        }
+        --quality;
+    }
+    return header;
+}
+
+ContentEncoding ContentCoding::negotiate(const std::string& p_acceptEncoding, const CompressionConfig& p_config, std::size_t p_bodySize)
+{
+    if(!p_config.enabled || p_bodySize < p_config.threshold || p_acceptEncoding.empty())
+    {
+        return ContentEncoding::Identity;
+    }
+
+    const auto accepted = parseAcceptEncoding(p_acceptEncoding);
+    auto best = ContentEncoding::Identity;
+    double bestQuality = 0.0;
+    for(const auto encoding : p_config.preferred)
+    {
+        if(encoding == ContentEncoding::Identity || !isSupported(encoding))
+        {
+            continue;
+        }
+        // An explicit entry wins over the wildcard
+        double quality = 0.0;
+        bool explicitEntry = false;
+        for(const auto& coding : accepted)
+        {
+            ContentEncoding parsed;
+            if(fromString(coding.name, parsed) && parsed == encoding)
+            {
+                quality = coding.quality;
+                explicitEntry = true;
+            }
+            else if(coding.name == "*" && !explicitEntry)
+            {
+                quality = coding.quality;
+            }
+        }
+        if(quality > bestQuality)
+        {
+            best = encoding;
+            bestQuality = quality;
+        }
+    }
+    return best;
+}
+
+bool ContentCoding::compress(ContentEncoding p_encoding, int p_level, const std::string& p_input, std::string& p_output)
+{
+    // Unused if neither codec library is available
+    static_cast<void>(p_level);
+    switch(p_encoding)
+    {
+        case ContentEncoding::Identity:
+            p_output = p_input;
+            return true;
+
+        case ContentEncoding::Gzip:
+        {
+#ifdef ORTABLE_WITH_ZLIB
+            if(p_input.size() > std::numeric_limits<uInt>::max())
+            {
+                return false;
+            }
+            z_stream stream{};
+            // 15 window bits + 16 selects the gzip wrapper
+            if(deflateInit2(&stream, clampLevel(p_level, 1, 9), Z_DEFLATED, 15 + 16, 8, Z_DEFAULT_STRATEGY) != Z_OK)
+            {
+                return false;
+            }
+            std::string output(deflateBound(&stream, static_cast<uLong>(p_input.size())), '\0');
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p_input.data()));
+            stream.avail_in = static_cast<uInt>(p_input.size());
+            stream.next_out = reinterpret_cast<Bytef*>(&output[0]);
+            stream.avail_out = static_cast<uInt>(output.size());
+            const auto result = deflate(&stream, Z_FINISH);
+            output.resize(stream.total_out);
+            deflateEnd(&stream);
+            if(result != Z_STREAM_END)
+            {
+                return false;
+            }
+            p_output = std::move(output);
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        case ContentEncoding::Zstd:
+        {
+#ifdef ORTABLE_WITH_ZSTD
+            std::string output(ZSTD_compressBound(p_input.size()), '\0');
+            const auto size = ZSTD_compress(&output[0], output.size(), p_input.data(), p_input.size(), clampLevel(p_level, 1, 19));
+            if(ZSTD_isError(size))
+            {
+                return false;
+            }
+            output.resize(size);
+            p_output = std::move(output);
+            return true;
+#else
+            return false;
+#endif
+        }
+    }
+    return false;
+}
+
+bool ContentCoding::decompress(ContentEncoding p_encoding, const std::string& p_input, std::string& p_output, std::size_t p_maxSize)
+{
+    switch(p_encoding)
+    {
+        case ContentEncoding::Identity:
+            if(p_input.size() > p_maxSize)
+            {
+                return false;
+            }
+            p_output = p_input;
+            return true;
+
+        case ContentEncoding::Gzip:
+        {
+#ifdef ORTABLE_WITH_ZLIB
+            if(p_input.size() > std::numeric_limits<uInt>::max())
+            {
+                return false;
+            }
+            z_stream stream{};
+            // 15 window bits + 32 accepts gzip and zlib wrappers
+            if(inflateInit2(&stream, 15 + 32) != Z_OK)
+            {
+                return false;
+            }
+            stream.next_in = reinterpret_cast<Bytef*>(const_cast<char*>(p_input.data()));
+            stream.avail_in = static_cast<uInt>(p_input.size());
+
+            std::string output;
+            int result = Z_OK;
+            while(result == Z_OK)
+            {
+                const auto offset = output.size();
+                if(offset >= p_maxSize)
+                {
+                    break;
+                }
+                output.resize(offset + std::min(DECOMPRESS_CHUNK_SIZE, p_maxSize - offset));
+                stream.next_out = reinterpret_cast<Bytef*>(&output[offset]);
+                stream.avail_out = static_cast<uInt>(output.size() - offset);
+                result = inflate(&stream, Z_NO_FLUSH);
+                output.resize(stream.total_out);
+            }
+            inflateEnd(&stream);
+            if(result != Z_STREAM_END)
+            {
+                return false;
+            }
+            p_output = std::move(output);
+            return true;
+#else
+            return false;
+#endif
+        }
+
+        case ContentEncoding::Zstd:
+        {
+#ifdef ORTABLE_WITH_ZSTD
+            auto context = ZSTD_createDCtx();
+            if(context == nullptr)
+            {
+                return false;
+            }
+            ZSTD_inBuffer input{p_input.data(), p_input.size(), 0};
+            std::string output;
+            std::size_t result = 1;
+            // result == 0 marks a completely decoded frame
+            while(result != 0 && output.size() < p_maxSize)
+            {
+                const auto offset = output.size();
+                output.resize(offset + std::min(DECOMPRESS_CHUNK_SIZE, p_maxSize - offset));
+                ZSTD_outBuffer buffer{&output[offset], output.size() - offset, 0};
+                result = ZSTD_decompressStream(context, &buffer, &input);
+                output.resize(offset + buffer.pos);
+                if(ZSTD_isError(result) || (buffer.pos == 0 && input.pos == input.size && result != 0))
+                {
+                    break;
+                }
+            }
+            ZSTD_freeDCtx(context);
+            if(result != 0)
+            {
+                return false;
+            }
+            p_output = std::move(output);
+            return true;
+#else
+            return false;
+#endif
+        }
+    }
+    return false;
+}
@@ -0,0 +1,67 @@
+/**
+ * @brief HTTP content-coding helpers: Accept-Encoding negotiation, a size threshold below which bodies stay
+ * uncompressed, and gzip/zstd codecs. gzip needs zlib (ORTABLE_WITH_ZLIB), zstd needs libzstd (ORTABLE_WITH_ZSTD).
+ * Codings whose library was not found at configure time are never negotiated.
+ *
+ * The only user is the DescriptionCache of the consumer, which compresses the descriptions it stores on disk. The
+ * HTTP transport of sdcX does not go through these helpers, so no request or response on the wire is compressed.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ORTable
+{
+    enum class ContentEncoding
+    {
+        Identity,
+        Gzip,
+        Zstd
+    };
+
+    // Applies to what the description cache writes to disk, not to the HTTP transport
+    struct CompressionConfig
+    {
+        bool enabled{false};
+        // Most preferred first
+        std::vector<ContentEncoding> preferred{ContentEncoding::Zstd, ContentEncoding::Gzip};
+        // Passed through to the codec: 1-9 for gzip, 1-19 for zstd. Values out of range are clamped
+        int level{3};
+        // Bodies below this size are stored as is, compressing small ones costs more than it saves
+        std::size_t threshold{8 * 1024};
+        // Upper bound for decompressed bodies, protects against compression bombs
+        std::size_t maxDecompressedSize{64 * 1024 * 1024};
+    };
+
+    class ContentCoding
+    {
+    public:
+        static bool isSupported(ContentEncoding p_encoding);
+
+        // "gzip", "zstd" or "identity"
+        static const char* toString(ContentEncoding p_encoding);
+        static bool fromString(const std::string& p_name, ContentEncoding& p_encoding);
+
+        // Accept-Encoding header value a client sends, e.g. "zstd, gzip;q=0.9"
+        static std::string makeAcceptEncoding(const CompressionConfig& p_config);
+
+        /**
+         * @brief Picks the coding for a response of the given size.
+         * Follows the q-values of the Accept-Encoding header, ties are broken by the preference order of the config.
+         * Returns Identity for disabled configs, small bodies or if nothing acceptable is supported.
+         */
+        static ContentEncoding negotiate(const std::string& p_acceptEncoding, const CompressionConfig& p_config, std::size_t p_bodySize);
+
+        static bool compress(ContentEncoding p_encoding, int p_level, const std::string& p_input, std::string& p_output);
+        static bool decompress(ContentEncoding p_encoding,
+                               const std::string& p_input,
+                               std::string& p_output,
+                               std::size_t p_maxSize);
+    };
+} // namespace ORTable
@@ -0,0 +1,59 @@
+#include "LatencyRecorder.h"
+
+#include <algorithm>
+
+using namespace ORTable;
+
+void LatencyRecorder::reserve(std::size_t p_count)
+{
+    m_samples.reserve(p_count);
+}
+
+void LatencyRecorder::record(std::chrono::nanoseconds p_latency)
+{
+    m_samples.push_back(p_latency.count());
+}
+
+void LatencyRecorder::merge(const LatencyRecorder& p_other)
+{
+    m_samples.insert(m_samples.end(), p_other.m_samples.begin(), p_other.m_samples.end());
+}
+
+void LatencyRecorder::clear()
+{
+    m_samples.clear();
+}
+
+std::size_t LatencyRecorder::size() const
+{
+    return m_samples.size();
+}
+
+LatencySummary LatencyRecorder::summarize()
+{
+    LatencySummary summary;
+    if(m_samples.empty())
+    {
+        return summary;
+    }
+    std::sort(m_samples.begin(), m_samples.end());
+
+    const auto at = [this](double p_quantile) {
+        const auto index = static_cast<std::size_t>(p_quantile * static_cast<double>(m_samples.size() - 1) + 0.5);
+        return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::nanoseconds(m_samples[index]));
+    };
+    long double total{0};
+    for(const auto sample : m_samples)
+    {
+        total += sample;
+    }
+
+    summary.count = m_samples.size();
+    summary.p50 = at(0.5);
+    summary.p90 = at(0.9);
+    summary.p99 = at(0.99);
+    summary.maximum = at(1.0);
+    summary.mean = std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::nanoseconds(static_cast<std::int64_t>(total / static_cast<long double>(m_samples.size()))));
+    return summary;
+}
@@ -0,0 +1,43 @@
+/**
+ * @brief Collects latency samples of a benchmark phase and summarizes them (count, percentiles, maximum). Samples are
+ * kept, not bucketed, so percentiles are exact; reserve() up front keeps the recording path free of allocations.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+namespace ORTable
+{
+    struct LatencySummary
+    {
+        std::uint64_t count{0};
+        std::chrono::microseconds p50{0};
+        std::chrono::microseconds p90{0};
+        std::chrono::microseconds p99{0};
+        std::chrono::microseconds maximum{0};
+        std::chrono::microseconds mean{0};
+    };
+
+    class LatencyRecorder
+    {
+    private:
+        std::vector<std::int64_t> m_samples;
+
+    public:
+        void reserve(std::size_t p_count);
+        void record(std::chrono::nanoseconds p_latency);
+        // Adds the samples of another recorder, e.g. to summarize all subscribers of a phase
+        void merge(const LatencyRecorder& p_other);
+        void clear();
+        std::size_t size() const;
+
+        // Sorts the samples
+        LatencySummary summarize();
+    };
+} // namespace ORTable
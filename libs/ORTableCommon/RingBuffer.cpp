@@ -0,0 +1,103 @@
+#include "RingBuffer.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace ORTable;
+
+namespace
+{
+    std::size_t nextPowerOfTwo(std::size_t p_value)
+    {
+        std::size_t result{1};
+        while(result < p_value)
+        {
+            result <<= 1;
+        }
+        return result;
+    }
+} // namespace
+
+RingBuffer::RingBuffer(std::size_t p_capacity)
+    : m_buffer(nextPowerOfTwo(std::max<std::size_t>(p_capacity, 2)))
+    , m_mask(m_buffer.size() - 1)
+{
+}
+
+std::size_t RingBuffer::capacity() const
+{
+    return m_buffer.size();
+}
+
+std::size_t RingBuffer::size() const
+{
+    return m_writePosition - m_readPosition;
+}
+
+std::size_t RingBuffer::freeSpace() const
+{
+    return capacity() - size();
+}
+
+bool RingBuffer::empty() const
+{
+    return m_writePosition == m_readPosition;
+}
+
+std::array<RingBuffer::Region, 2> RingBuffer::writable()
+{
+    const auto start = m_writePosition & m_mask;
+    const auto free = freeSpace();
+    const auto first = std::min(free, capacity() - start);
+    return {{{m_buffer.data() + start, first}, {m_buffer.data(), free - first}}};
+}
+
+void RingBuffer::produce(std::size_t p_count)
+{
+    m_writePosition += std::min(p_count, freeSpace());
+}
+
+std::array<RingBuffer::ConstRegion, 2> RingBuffer::readable() const
+{
+    const auto start = m_readPosition & m_mask;
+    const auto filled = size();
+    const auto first = std::min(filled, capacity() - start);
+    return {{{m_buffer.data() + start, first}, {m_buffer.data(), filled - first}}};
+}
+
+void RingBuffer::consume(std::size_t p_count)
+{
+    m_readPosition += std::min(p_count, size());
+}
+
+bool RingBuffer::write(const std::uint8_t* p_data, std::size_t p_count)
+{
+    if(p_count > freeSpace())
+    {
+        return false;
+    }
+    const auto regions = writable();
+    const auto first = std::min(p_count, regions[0].size);
+    std::memcpy(regions[0].data, p_data, first);
+    std::memcpy(regions[1].data, p_data + first, p_count - first);
+    produce(p_count);
+    return true;
+}
+
+std::uint8_t RingBuffer::peek(std::size_t p_offset) const
+{
+    return m_buffer[(m_readPosition + p_offset) & m_mask];
+}
+
+const std::uint8_t* RingBuffer::view(std::size_t p_offset, std::size_t p_count, std::uint8_t* p_scratch) const
+{
+    const auto start = (m_readPosition + p_offset) & m_mask;
+    if(start + p_count <= capacity())
+    {
+        return m_buffer.data() + start;
+    }
+    const auto first = capacity() - start;
+    std::memcpy(p_scratch, m_buffer.data() + start, first);
+    std::memcpy(p_scratch + first, m_buffer.data(), p_count - first);
+    return p_scratch;
+}
@@ -0,0 +1,72 @@
+/**
+ * @brief Byte ring buffer for device I/O. Instead of copying through intermediate buffers, callers read from and write
+ * to the device directly via the (at most two) contiguous regions of free or filled space, e.g. with readv()/writev().
+ * The capacity is a power of two, so positions wrap by masking.
+ *
+ * Not synchronized, the owner serializes access.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ORTable
+{
+    class RingBuffer
+    {
+    public:
+        struct Region
+        {
+            std::uint8_t* data;
+            std::size_t size;
+        };
+
+        struct ConstRegion
+        {
+            const std::uint8_t* data;
+            std::size_t size;
+        };
+
+    private:
+        std::vector<std::uint8_t> m_buffer;
+        std::size_t m_mask;
+        // Free running positions, the difference is the filled size
+        std::size_t m_readPosition{0};
+        std::size_t m_writePosition{0};
+
+    public:
+        // The capacity is rounded up to the next power of two
+        explicit RingBuffer(std::size_t p_capacity);
+
+        std::size_t capacity() const;
+        std::size_t size() const;
+        std::size_t freeSpace() const;
+        bool empty() const;
+
+        // Free space, the second region is empty unless the space wraps around. Call produce() after filling it
+        std::array<Region, 2> writable();
+        void produce(std::size_t p_count);
+
+        // Filled space in order, the second region is empty unless the data wraps around. Call consume() when done
+        std::array<ConstRegion, 2> readable() const;
+        void consume(std::size_t p_count);
+
+        // Appends all bytes or nothing, returns false if the free space is too small
+        bool write(const std::uint8_t* p_data, std::size_t p_count);
+
+        // Byte at the given offset from the read position, the offset must be below size()
+        std::uint8_t peek(std::size_t p_offset) const;
+
+        /**
+         * @brief Returns a pointer to p_count bytes starting at p_offset from the read position. If they wrap around,
+         * they are copied to p_scratch, which must hold p_count bytes, and p_scratch is returned.
+         */
+        const std::uint8_t* view(std::size_t p_offset, std::size_t p_count, std::uint8_t* p_scratch) const;
+    };
+} // namespace ORTable
@@ -0,0 +1,218 @@
+/**
+ * @brief Non-owning views for the handle and parsing paths, independent of the C++ standard the project is built with
+ * (CMAKE_CXX_STANDARD 14, 17 or 20). StringView is std::string_view from C++17 on and Span std::span from C++20 on,
+ * before that both are minimal stand-ins with the subset of the interface the project uses. Code written against the
+ * stand-ins compiles unchanged with the standard types.
+ *
+ * ORTABLE_IF_CONSTEXPR is "if constexpr" where available. Both branches have to compile either way, the C++14 build
+ * just leaves discarding the dead one to the optimizer.
+ *
+ * ORTABLE_COROUTINES is set where the compiler implements coroutines and ships <coroutine>, which C++20 alone does not
+ * guarantee: GCC 10 needs -fcoroutines and Clang 10 has neither.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#if defined(_MSVC_LANG)
+    #define ORTABLE_CPLUSPLUS _MSVC_LANG
+#else
+    #define ORTABLE_CPLUSPLUS __cplusplus
+#endif
+
+#if ORTABLE_CPLUSPLUS >= 201703L
+    #define ORTABLE_CXX17
+    #include <string_view>
+#endif
+#if ORTABLE_CPLUSPLUS >= 202002L
+    #define ORTABLE_CXX20
+    #include <span>
+#endif
+#if defined(ORTABLE_CXX20) && defined(__cpp_impl_coroutine) && defined(__has_include)
+    #if __has_include(<coroutine>)
+        #define ORTABLE_COROUTINES
+    #endif
+#endif
+
+#ifdef ORTABLE_CXX17
+    #define ORTABLE_IF_CONSTEXPR if constexpr
+#else
+    #define ORTABLE_IF_CONSTEXPR if
+#endif
+
+namespace ORTable
+{
+#ifdef ORTABLE_CXX17
+    using StringView = std::string_view;
+#else
+    class StringView
+    {
+    private:
+        const char* m_data{nullptr};
+        std::size_t m_size{0};
+
+    public:
+        static constexpr std::size_t npos{static_cast<std::size_t>(-1)};
+
+        constexpr StringView() = default;
+        constexpr StringView(const char* p_data, std::size_t p_size)
+            : m_data(p_data)
+            , m_size(p_size)
+        {
+        }
+        StringView(const char* p_string)
+            : m_data(p_string)
+            , m_size(std::strlen(p_string))
+        {
+        }
+        StringView(const std::string& p_string)
+            : m_data(p_string.data())
+            , m_size(p_string.size())
+        {
+        }
+
+        // std::string_view needs an explicit std::string(view), this one converts implicitly for assignments
+        operator std::string() const
+        {
+            return std::string(m_data, m_size);
+        }
+
+        constexpr const char* data() const
+        {
+            return m_data;
+        }
+        constexpr std::size_t size() const
+        {
+            return m_size;
+        }
+        constexpr bool empty() const
+        {
+            return m_size == 0;
+        }
+        constexpr const char* begin() const
+        {
+            return m_data;
+        }
+        constexpr const char* end() const
+        {
+            return m_data + m_size;
+        }
+        constexpr char operator[](std::size_t p_position) const
+        {
+            return m_data[p_position];
+        }
+
+        void remove_prefix(std::size_t p_count)
+        {
+            m_data += p_count;
+            m_size -= p_count;
+        }
+        StringView substr(std::size_t p_position, std::size_t p_count = npos) const
+        {
+            p_position = std::min(p_position, m_size);
+            return StringView(m_data + p_position, std::min(p_count, m_size - p_position));
+        }
+        std::size_t find(char p_character, std::size_t p_position = 0) const
+        {
+            for(; p_position < m_size; ++p_position)
+            {
+                if(m_data[p_position] == p_character)
+                {
+                    return p_position;
+                }
+            }
+            return npos;
+        }
+        int compare(StringView p_other) const
+        {
+            const auto result = std::char_traits<char>::compare(m_data, p_other.m_data, std::min(m_size, p_other.m_size));
+            if(result != 0)
+            {
+                return result;
+            }
+            return m_size < p_other.m_size ? -1 : (m_size > p_other.m_size ? 1 : 0);
+        }
+
+        friend bool operator==(StringView p_lhs, StringView p_rhs)
+        {
+            return p_lhs.m_size == p_rhs.m_size && std::char_traits<char>::compare(p_lhs.m_data, p_rhs.m_data, p_lhs.m_size) == 0;
+        }
+        friend bool operator!=(StringView p_lhs, StringView p_rhs)
+        {
+            return !(p_lhs == p_rhs);
+        }
+        friend bool operator<(StringView p_lhs, StringView p_rhs)
+        {
+            return p_lhs.compare(p_rhs) < 0;
+        }
+    };
+#endif
+
+#ifdef ORTABLE_CXX20
+    template<typename T>
+    using Span = std::span<T>;
+#else
+    template<typename T>
+    class Span
+    {
+    private:
+        T* m_data{nullptr};
+        std::size_t m_size{0};
+
+    public:
+        constexpr Span() = default;
+        constexpr Span(T* p_data, std::size_t p_size)
+            : m_data(p_data)
+            , m_size(p_size)
+        {
+        }
+        // Like std::span, a span of const elements views a const vector
+        template<typename Allocator>
+        Span(std::vector<typename std::remove_const<T>::type, Allocator>& p_vector)
+            : m_data(p_vector.data())
+            , m_size(p_vector.size())
+        {
+        }
+        template<typename Allocator, typename U = T, typename = typename std::enable_if<std::is_const<U>::value>::type>
+        Span(const std::vector<typename std::remove_const<T>::type, Allocator>& p_vector)
+            : m_data(p_vector.data())
+            , m_size(p_vector.size())
+        {
+        }
+
+        constexpr T* data() const
+        {
+            return m_data;
+        }
+        constexpr std::size_t size() const
+        {
+            return m_size;
+        }
+        constexpr bool empty() const
+        {
+            return m_size == 0;
+        }
+        constexpr T* begin() const
+        {
+            return m_data;
+        }
+        constexpr T* end() const
+        {
+            return m_data + m_size;
+        }
+        constexpr T& operator[](std::size_t p_position) const
+        {
+            return m_data[p_position];
+        }
+    };
+#endif
+} // namespace ORTable
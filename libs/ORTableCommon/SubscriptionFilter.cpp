@@ -0,0 +1,184 @@
+#include "SubscriptionFilter.h"
+
+#include <algorithm>
+#include <sstream>
+
+using namespace ORTable;
+
+const char* const ORTable::SUBSCRIPTION_FILTER_DIALECT = "urn:surgitaix:ortable:filter:action-handle";
+const char* const ORTable::ACTION_FILTER_DIALECT = "http://docs.oasis-open.org/ws-dd/ns/dpws/2009/01/Action";
+
+namespace
+{
+    const char* const ACTION_URIS[] = {
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/StateEventService/EpisodicMetricReport",
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/StateEventService/EpisodicAlertReport",
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/ContextService/EpisodicContextReport",
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/StateEventService/EpisodicOperationalStateReport",
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/SetService/OperationInvokedReport",
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/DescriptionEventService/DescriptionModificationReport",
+        "http://standards.ieee.org/downloads/11073/11073-20701-2018/WaveformService/WaveformStream"};
+    static_assert(sizeof(ACTION_URIS) / sizeof(ACTION_URIS[0]) == REPORT_ACTION_COUNT, "One URI per report action");
+} // namespace
+
+SubscriptionFilter::SubscriptionFilter(std::initializer_list<ReportAction> p_actions, std::vector<std::string> p_handles)
+{
+    for(const auto action : p_actions)
+    {
+        addAction(action);
+    }
+    for(auto& handle : p_handles)
+    {
+        addHandle(std::move(handle));
+    }
+}
+
+SubscriptionFilter SubscriptionFilter::all()
+{
+    SubscriptionFilter filter;
+    filter.m_actions = (1u << REPORT_ACTION_COUNT) - 1;
+    return filter;
+}
+
+std::uint32_t SubscriptionFilter::bitOf(ReportAction p_action)
+{
+    return 1u << static_cast<std::uint32_t>(p_action);
+}
+
+void SubscriptionFilter::addAction(ReportAction p_action)
+{
+    m_actions |= bitOf(p_action);
+}
+
+void SubscriptionFilter::addHandle(std::string p_handle)
+{
+    const auto it = std::lower_bound(m_handles.begin(), m_handles.end(), p_handle);
+    if(it == m_handles.end() || *it != p_handle)
+    {
+        m_handles.insert(it, std::move(p_handle));
+    }
+}
+
+bool SubscriptionFilter::isStateAction(ReportAction p_action)
+{
+    return p_action != ReportAction::OperationInvoked && p_action != ReportAction::DescriptionModification;
+}
+
+bool SubscriptionFilter::hasAction(ReportAction p_action) const
+{
+    return (m_actions & bitOf(p_action)) != 0;
+}
+
+bool SubscriptionFilter::hasHandles() const
+{
+    return !m_handles.empty();
+}
+
+const std::vector<std::string>& SubscriptionFilter::getHandles() const
+{
+    return m_handles;
+}
+
+SubscriptionFilter SubscriptionFilter::actionsOnly() const
+{
+    SubscriptionFilter filter;
+    filter.m_actions = m_actions;
+    return filter;
+}
+
+bool SubscriptionFilter::matches(ReportAction p_action, StringView p_handle) const
+{
+    return hasAction(p_action)
+           && (m_handles.empty() || !isStateAction(p_action) || std::binary_search(m_handles.begin(), m_handles.end(), p_handle));
+}
+
+bool SubscriptionFilter::matchesAny(ReportAction p_action, Span<const std::string> p_handles) const
+{
+    if(!hasAction(p_action))
+    {
+        return false;
+    }
+    if(m_handles.empty() || !isStateAction(p_action))
+    {
+        return true;
+    }
+    return std::any_of(p_handles.begin(), p_handles.end(), [this](const std::string& p_handle) {
+        return std::binary_search(m_handles.begin(), m_handles.end(), p_handle);
+    });
+}
+
+std::string SubscriptionFilter::encode() const
+{
+    std::string encoded;
+    for(std::size_t i = 0; i < REPORT_ACTION_COUNT; ++i)
+    {
+        if(hasAction(static_cast<ReportAction>(i)))
+        {
+            if(!encoded.empty())
+            {
+                encoded += ' ';
+            }
+            encoded += ACTION_URIS[i];
+        }
+    }
+    if(!m_handles.empty())
+    {
+        encoded += " |";
+        for(const auto& handle : m_handles)
+        {
+            encoded += ' ';
+            encoded += handle;
+        }
+    }
+    return encoded;
+}
+
+const char* SubscriptionFilter::getDialect() const
+{
+    return m_handles.empty() ? ACTION_FILTER_DIALECT : SUBSCRIPTION_FILTER_DIALECT;
+}
+
+bool SubscriptionFilter::decode(const std::string& p_encoded, SubscriptionFilter& p_filter)
+{
+    p_filter = SubscriptionFilter();
+    std::istringstream stream(p_encoded);
+    std::string token;
+    bool handles{false};
+    while(stream >> token)
+    {
+        if(token == "|")
+        {
+            handles = true;
+            continue;
+        }
+        if(handles)
+        {
+            p_filter.addHandle(token);
+            continue;
+        }
+        ReportAction action;
+        if(fromActionUri(token, action))
+        {
+            p_filter.addAction(action);
+        }
+    }
+    return p_filter.m_actions != 0;
+}
+
+const char* SubscriptionFilter::toActionUri(ReportAction p_action)
+{
+    return ACTION_URIS[static_cast<std::size_t>(p_action)];
+}
+
+bool SubscriptionFilter::fromActionUri(StringView p_uri, ReportAction& p_action)
+{
+    for(std::size_t i = 0; i < REPORT_ACTION_COUNT; ++i)
+    {
+        if(p_uri == ACTION_URIS[i])
+        {
+            p_action = static_cast<ReportAction>(i);
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,87 @@
+/**
+ * @brief Filter of a report subscription: the report actions a consumer wants and, optionally, the descriptor handles
+ * it is interested in. Without handles every report of the chosen actions matches. The handles only restrict the state
+ * reports (metric, alert, context, operational state and waveform): OperationInvoked and DescriptionModification
+ * reports always match, so a consumer watching a few metrics still completes its operations and learns about
+ * descriptor changes.
+ *
+ * The filter travels in the Subscribe request as a space separated list of action URIs, followed by "|" and the
+ * handles if there are any, e.g. ".../EpisodicMetricReport | MDC_OR_TABLE_HEIGHT". Only a filter with handles needs
+ * SUBSCRIPTION_FILTER_DIALECT, without handles the encoding is a plain action list in the standard action dialect,
+ * which every SDC provider understands (see getDialect()). A consumer whose filtered subscription is rejected
+ * subscribes again with actionsOnly(). Plain action lists decode as well.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "StringView.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <vector>
+
+namespace ORTable
+{
+    // Filter dialect of an encoded filter with handles, providers not knowing it reject the subscription
+    extern const char* const SUBSCRIPTION_FILTER_DIALECT;
+    // Standard DPWS action dialect, space separated action URIs
+    extern const char* const ACTION_FILTER_DIALECT;
+
+    enum class ReportAction : std::uint8_t
+    {
+        EpisodicMetric,
+        EpisodicAlert,
+        EpisodicContext,
+        EpisodicOperationalState,
+        OperationInvoked,
+        DescriptionModification,
+        Waveform
+    };
+    constexpr std::size_t REPORT_ACTION_COUNT{7};
+
+    class SubscriptionFilter
+    {
+    private:
+        std::uint32_t m_actions{0};
+        // Sorted, empty matches all handles
+        std::vector<std::string> m_handles;
+
+        static std::uint32_t bitOf(ReportAction p_action);
+
+    public:
+        SubscriptionFilter() = default;
+        SubscriptionFilter(std::initializer_list<ReportAction> p_actions, std::vector<std::string> p_handles = {});
+        // All actions and handles, e.g. for subscriptions without a filter the provider understands
+        static SubscriptionFilter all();
+
+        void addAction(ReportAction p_action);
+        void addHandle(std::string p_handle);
+
+        // True for the actions whose reports carry states, the only ones the handles apply to
+        static bool isStateAction(ReportAction p_action);
+
+        bool hasAction(ReportAction p_action) const;
+        bool hasHandles() const;
+        const std::vector<std::string>& getHandles() const;
+        // Same actions without handles, the fallback for providers that do not know SUBSCRIPTION_FILTER_DIALECT
+        SubscriptionFilter actionsOnly() const;
+
+        bool matches(ReportAction p_action, StringView p_handle) const;
+        // True if the report of the given action carries at least one state of interest
+        bool matchesAny(ReportAction p_action, Span<const std::string> p_handles) const;
+
+        std::string encode() const;
+        // Dialect of encode(): SUBSCRIPTION_FILTER_DIALECT with handles, ACTION_FILTER_DIALECT without
+        const char* getDialect() const;
+        // Unknown action URIs are skipped, false if no known action remains
+        static bool decode(const std::string& p_encoded, SubscriptionFilter& p_filter);
+
+        static const char* toActionUri(ReportAction p_action);
+        static bool fromActionUri(StringView p_uri, ReportAction& p_action);
+    };
+} // namespace ORTable
@@ -0,0 +1,220 @@
+#include "TableProtocol.h"
+
+#include <cmath>
+
+using namespace ORTable;
+
+constexpr std::uint8_t TableProtocol::START_OF_FRAME;
+constexpr std::size_t TableProtocol::HEADER_SIZE;
+constexpr std::size_t TableProtocol::TRAILER_SIZE;
+constexpr std::size_t TableProtocol::MAX_PAYLOAD_SIZE;
+constexpr std::size_t TableProtocol::MAX_FRAME_SIZE;
+constexpr std::size_t TableProtocol::TELEMETRY_SIZE;
+constexpr std::size_t TableProtocol::COMMAND_SIZE;
+constexpr std::size_t TableProtocol::ACK_SIZE;
+
+namespace
+{
+    struct CrcTable
+    {
+        std::uint16_t values[256];
+
+        CrcTable()
+        {
+            for(unsigned int i = 0; i < 256; ++i)
+            {
+                std::uint16_t crc = static_cast<std::uint16_t>(i << 8);
+                for(int bit = 0; bit < 8; ++bit)
+                {
+                    crc = (crc & 0x8000) ? static_cast<std::uint16_t>((crc << 1) ^ 0x1021) : static_cast<std::uint16_t>(crc << 1);
+                }
+                values[i] = crc;
+            }
+        }
+    };
+
+    // Payload length of the frame type, 0 for unknown types
+    std::size_t payloadSizeOf(std::uint8_t p_type)
+    {
+        switch(static_cast<FrameType>(p_type))
+        {
+            case FrameType::Telemetry:
+                return TableProtocol::TELEMETRY_SIZE;
+            case FrameType::Command:
+                return TableProtocol::COMMAND_SIZE;
+            case FrameType::Ack:
+                return TableProtocol::ACK_SIZE;
+        }
+        return 0;
+    }
+
+    void writeInt32(std::uint8_t* p_output, double p_value)
+    {
+        const auto value = static_cast<std::uint32_t>(static_cast<std::int32_t>(std::lround(p_value * 100.0)));
+        p_output[0] = static_cast<std::uint8_t>(value);
+        p_output[1] = static_cast<std::uint8_t>(value >> 8);
+        p_output[2] = static_cast<std::uint8_t>(value >> 16);
+        p_output[3] = static_cast<std::uint8_t>(value >> 24);
+    }
+
+    double readInt32(const std::uint8_t* p_input)
+    {
+        const auto value = static_cast<std::uint32_t>(p_input[0]) | (static_cast<std::uint32_t>(p_input[1]) << 8)
+                           | (static_cast<std::uint32_t>(p_input[2]) << 16) | (static_cast<std::uint32_t>(p_input[3]) << 24);
+        return static_cast<std::int32_t>(value) / 100.0;
+    }
+} // namespace
+
+std::uint16_t TableProtocol::crc16(const std::uint8_t* p_data, std::size_t p_size, std::uint16_t p_crc)
+{
+    static const CrcTable table;
+    for(std::size_t i = 0; i < p_size; ++i)
+    {
+        p_crc = static_cast<std::uint16_t>((p_crc << 8) ^ table.values[((p_crc >> 8) ^ p_data[i]) & 0xFF]);
+    }
+    return p_crc;
+}
+
+std::size_t TableProtocol::encode(FrameType p_type,
+                                  std::uint16_t p_sequence,
+                                  const std::uint8_t* p_payload,
+                                  std::size_t p_length,
+                                  std::uint8_t* p_output)
+{
+    if(p_length > MAX_PAYLOAD_SIZE)
+    {
+        return 0;
+    }
+    p_output[0] = START_OF_FRAME;
+    p_output[1] = static_cast<std::uint8_t>(p_type);
+    p_output[2] = static_cast<std::uint8_t>(p_sequence);
+    p_output[3] = static_cast<std::uint8_t>(p_sequence >> 8);
+    p_output[4] = static_cast<std::uint8_t>(p_length);
+    for(std::size_t i = 0; i < p_length; ++i)
+    {
+        p_output[HEADER_SIZE + i] = p_payload[i];
+    }
+    const auto crc = crc16(p_output + 1, HEADER_SIZE - 1 + p_length);
+    p_output[HEADER_SIZE + p_length] = static_cast<std::uint8_t>(crc);
+    p_output[HEADER_SIZE + p_length + 1] = static_cast<std::uint8_t>(crc >> 8);
+    return HEADER_SIZE + p_length + TRAILER_SIZE;
+}
+
+std::size_t TableProtocol::encodeTelemetry(const TableTelemetry& p_telemetry, std::uint16_t p_sequence, std::uint8_t* p_output)
+{
+    std::uint8_t payload[TELEMETRY_SIZE];
+    writeInt32(payload, p_telemetry.height);
+    writeInt32(payload + 4, p_telemetry.trend);
+    writeInt32(payload + 8, p_telemetry.tilt);
+    writeInt32(payload + 12, p_telemetry.backplate);
+    payload[16] = p_telemetry.moving ? 1 : 0;
+    return encode(FrameType::Telemetry, p_sequence, payload, sizeof(payload), p_output);
+}
+
+std::size_t TableProtocol::encodeCommand(const TableCommand& p_command, std::uint16_t p_sequence, std::uint8_t* p_output)
+{
+    std::uint8_t payload[COMMAND_SIZE];
+    payload[0] = static_cast<std::uint8_t>(p_command.code);
+    writeInt32(payload + 1, p_command.argument);
+    return encode(FrameType::Command, p_sequence, payload, sizeof(payload), p_output);
+}
+
+std::size_t TableProtocol::encodeAck(AckStatus p_status, std::uint16_t p_sequence, std::uint8_t* p_output)
+{
+    const std::uint8_t payload[ACK_SIZE]{static_cast<std::uint8_t>(p_status)};
+    return encode(FrameType::Ack, p_sequence, payload, sizeof(payload), p_output);
+}
+
+bool TableProtocol::decodeTelemetry(const Frame& p_frame, TableTelemetry& p_telemetry)
+{
+    if(p_frame.type != FrameType::Telemetry || p_frame.length != TELEMETRY_SIZE)
+    {
+        return false;
+    }
+    p_telemetry.height = readInt32(p_frame.payload);
+    p_telemetry.trend = readInt32(p_frame.payload + 4);
+    p_telemetry.tilt = readInt32(p_frame.payload + 8);
+    p_telemetry.backplate = readInt32(p_frame.payload + 12);
+    p_telemetry.moving = p_frame.payload[16] != 0;
+    return true;
+}
+
+bool TableProtocol::decodeCommand(const Frame& p_frame, TableCommand& p_command)
+{
+    if(p_frame.type != FrameType::Command || p_frame.length != COMMAND_SIZE)
+    {
+        return false;
+    }
+    p_command.code = static_cast<CommandCode>(p_frame.payload[0]);
+    p_command.argument = readInt32(p_frame.payload + 1);
+    return true;
+}
+
+bool TableProtocol::decodeAck(const Frame& p_frame, AckStatus& p_status)
+{
+    if(p_frame.type != FrameType::Ack || p_frame.length != ACK_SIZE)
+    {
+        return false;
+    }
+    p_status = static_cast<AckStatus>(p_frame.payload[0]);
+    return true;
+}
+
+std::size_t FrameParser::parse(RingBuffer& p_input, const FrameFunction& p_onFrame)
+{
+    std::size_t frames{0};
+    while(!p_input.empty())
+    {
+        if(p_input.peek(0) != TableProtocol::START_OF_FRAME)
+        {
+            p_input.consume(1);
+            ++m_counters.droppedBytes;
+            continue;
+        }
+        if(p_input.size() < TableProtocol::HEADER_SIZE)
+        {
+            break;
+        }
+        const std::size_t length = p_input.peek(4);
+        if(length != payloadSizeOf(p_input.peek(1))
+           || length > TableProtocol::MAX_FRAME_SIZE - TableProtocol::HEADER_SIZE - TableProtocol::TRAILER_SIZE)
+        {
+            // Not a frame header, e.g. a start byte within a payload. Resynchronize right after it
+            ++m_counters.headerErrors;
+            ++m_counters.droppedBytes;
+            p_input.consume(1);
+            continue;
+        }
+        const auto frameSize = TableProtocol::HEADER_SIZE + length + TableProtocol::TRAILER_SIZE;
+        if(p_input.size() < frameSize)
+        {
+            break;
+        }
+
+        const auto* frame = p_input.view(0, frameSize, m_scratch.data());
+        const auto crc = TableProtocol::crc16(frame + 1, TableProtocol::HEADER_SIZE - 1 + length);
+        const auto received = static_cast<std::uint16_t>(frame[frameSize - 2] | (frame[frameSize - 1] << 8));
+        if(crc != received)
+        {
+            // The start byte may have been part of the payload of a broken frame, resynchronize right after it
+            ++m_counters.crcErrors;
+            ++m_counters.droppedBytes;
+            p_input.consume(1);
+            continue;
+        }
+
+        ++m_counters.frames;
+        ++frames;
+        p_onFrame(Frame{static_cast<FrameType>(frame[1]),
+                        static_cast<std::uint16_t>(frame[2] | (frame[3] << 8)),
+                        frame + TableProtocol::HEADER_SIZE,
+                        length});
+        p_input.consume(frameSize);
+    }
+    return frames;
+}
+
+const FrameParserCounters& FrameParser::getCounters() const
+{
+    return m_counters;
+}
@@ -0,0 +1,143 @@
+/**
+ * @brief Binary protocol between the provider and the table controller on the serial line. Every frame is
+ *
+ *   0xA5 | type (1) | sequence (2) | payload length (1) | payload | CRC-16/CCITT (2)
+ *
+ * with multi-byte fields in little endian and the CRC covering everything between the start byte and the CRC.
+ * Positions are transferred as signed 32 bit integers in hundredths of cm or degree.
+ *
+ * The controller sends telemetry whenever the table moves, the provider sends commands, each acknowledged by the
+ * controller with an ack frame carrying the sequence number of the command.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "RingBuffer.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+
+namespace ORTable
+{
+    enum class FrameType : std::uint8_t
+    {
+        Telemetry = 0x01,
+        Command = 0x02,
+        Ack = 0x03
+    };
+
+    struct TableTelemetry
+    {
+        double height{0};
+        double trend{0};
+        double tilt{0};
+        double backplate{0};
+        bool moving{false};
+    };
+
+    enum class CommandCode : std::uint8_t
+    {
+        Stop = 0,
+        // Relative movements, the argument is the change of the axis
+        MoveHeight = 1,
+        MoveTrend = 2,
+        MoveTilt = 3,
+        MoveBackplate = 4,
+        // The argument is the number of the predefined position
+        ApplyPosition = 5
+    };
+
+    struct TableCommand
+    {
+        CommandCode code{CommandCode::Stop};
+        double argument{0};
+    };
+
+    enum class AckStatus : std::uint8_t
+    {
+        Done = 0,
+        // E.g. a movement beyond the limits of an axis
+        Rejected = 1,
+        // The controller did not understand the command
+        Unknown = 2
+    };
+
+    // A received frame. The payload points into the receive buffer and is only valid during the callback
+    struct Frame
+    {
+        FrameType type;
+        std::uint16_t sequence;
+        const std::uint8_t* payload;
+        std::size_t length;
+    };
+
+    class TableProtocol
+    {
+    public:
+        static constexpr std::uint8_t START_OF_FRAME{0xA5};
+        static constexpr std::size_t HEADER_SIZE{5};
+        static constexpr std::size_t TRAILER_SIZE{2};
+        static constexpr std::size_t MAX_PAYLOAD_SIZE{255};
+        static constexpr std::size_t MAX_FRAME_SIZE{HEADER_SIZE + MAX_PAYLOAD_SIZE + TRAILER_SIZE};
+
+        static constexpr std::size_t TELEMETRY_SIZE{17};
+        static constexpr std::size_t COMMAND_SIZE{5};
+        static constexpr std::size_t ACK_SIZE{1};
+
+        static std::uint16_t crc16(const std::uint8_t* p_data, std::size_t p_size, std::uint16_t p_crc = 0xFFFF);
+
+        // Writes the frame to p_output, which must hold MAX_FRAME_SIZE bytes, and returns the frame size
+        static std::size_t encode(FrameType p_type,
+                                  std::uint16_t p_sequence,
+                                  const std::uint8_t* p_payload,
+                                  std::size_t p_length,
+                                  std::uint8_t* p_output);
+        static std::size_t encodeTelemetry(const TableTelemetry& p_telemetry, std::uint16_t p_sequence, std::uint8_t* p_output);
+        static std::size_t encodeCommand(const TableCommand& p_command, std::uint16_t p_sequence, std::uint8_t* p_output);
+        static std::size_t encodeAck(AckStatus p_status, std::uint16_t p_sequence, std::uint8_t* p_output);
+
+        // Return false if the frame has another type or a wrong payload size
+        static bool decodeTelemetry(const Frame& p_frame, TableTelemetry& p_telemetry);
+        static bool decodeCommand(const Frame& p_frame, TableCommand& p_command);
+        static bool decodeAck(const Frame& p_frame, AckStatus& p_status);
+    };
+
+    struct FrameParserCounters
+    {
+        std::uint64_t frames{0};
+        std::uint64_t crcErrors{0};
+        // Start bytes followed by an unknown type or a length that does not match the type
+        std::uint64_t headerErrors{0};
+        // Bytes skipped while searching for the next start of frame
+        std::uint64_t droppedBytes{0};
+    };
+
+    class FrameParser
+    {
+    public:
+        using FrameFunction = std::function<void(const Frame& p_frame)>;
+
+    private:
+        // Only used for frames wrapping around the end of the ring buffer
+        std::array<std::uint8_t, TableProtocol::MAX_FRAME_SIZE> m_scratch;
+        FrameParserCounters m_counters;
+
+    public:
+        /**
+         * @brief Hands all complete frames of the buffer to p_onFrame and consumes them. Bytes outside of frames and
+         * frames with a wrong CRC are skipped up to the next start of frame. The header is checked before waiting for
+         * the rest of a frame: a start byte followed by an unknown type or a length the type does not have is skipped
+         * right away, so a stray 0xA5 cannot hold back the frames behind it. An incomplete frame stays in the buffer
+         * until the rest arrives.
+         * @return the number of frames
+         */
+        std::size_t parse(RingBuffer& p_input, const FrameFunction& p_onFrame);
+
+        const FrameParserCounters& getCounters() const;
+    };
+} // namespace ORTable
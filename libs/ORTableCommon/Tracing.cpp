@@ -0,0 +1,217 @@
+#include "Tracing.h"
+
+#ifdef ORTABLE_TRACING
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+using namespace ORTable;
+
+namespace
+{
+    constexpr std::size_t BUFFER_SIZE{1024};
+
+    struct Event
+    {
+        const char* category;
+        const char* name;
+        char phase; // 'X' complete, 'i' instant
+        Trace::Clock::time_point start;
+        Trace::Clock::duration duration;
+    };
+
+    class ThreadBuffer;
+
+    // The file and everything written to it, events arrive here in batches
+    struct TraceFile
+    {
+        std::mutex mutex;
+        std::FILE* file{nullptr};
+        bool first{true};
+        Trace::Clock::time_point origin;
+        // Increased by start() and stop(), events buffered for an older recording are dropped
+        std::atomic<std::uint64_t> generation{0};
+        std::atomic<bool> recording{false};
+        std::uint32_t nextThreadId{1};
+        // Buffers of the running threads, flushed by stop()
+        std::vector<ThreadBuffer*> buffers;
+    };
+
+    TraceFile& traceFile()
+    {
+        static TraceFile instance;
+        return instance;
+    }
+
+    // Needs the mutex of the file
+    void writeEvents(TraceFile& p_trace, std::uint32_t p_threadId, const std::vector<Event>& p_events)
+    {
+        if(p_trace.file == nullptr)
+        {
+            return;
+        }
+        for(const auto& event : p_events)
+        {
+            const auto timestamp = std::chrono::duration<double, std::micro>(event.start - p_trace.origin).count();
+            std::fprintf(p_trace.file,
+                         "%s{\"cat\":\"%s\",\"name\":\"%s\",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u",
+                         p_trace.first ? "\n" : ",\n",
+                         event.category,
+                         event.name,
+                         event.phase,
+                         timestamp,
+                         p_threadId);
+            if(event.phase == 'X')
+            {
+                std::fprintf(p_trace.file, ",\"dur\":%.3f}", std::chrono::duration<double, std::micro>(event.duration).count());
+            }
+            else
+            {
+                std::fprintf(p_trace.file, ",\"s\":\"t\"}");
+            }
+            p_trace.first = false;
+        }
+    }
+
+    /**
+     * Events of one thread. The thread only takes the lock of its own buffer, which is contended just while stop()
+     * collects the buffers. Full buffers are swapped out and written without holding that lock.
+     */
+    class ThreadBuffer
+    {
+    private:
+        std::mutex m_mutex;
+        std::vector<Event> m_events;
+        std::vector<Event> m_writing;
+        std::uint32_t m_threadId{0};
+        std::uint64_t m_generation{0};
+
+    public:
+        ThreadBuffer()
+        {
+            m_events.reserve(BUFFER_SIZE);
+            auto& trace = traceFile();
+            std::lock_guard<std::mutex> lock(trace.mutex);
+            m_threadId = trace.nextThreadId++;
+            trace.buffers.push_back(this);
+        }
+
+        ~ThreadBuffer()
+        {
+            auto& trace = traceFile();
+            std::lock_guard<std::mutex> lock(trace.mutex);
+            flushLocked(trace);
+            trace.buffers.erase(std::remove(trace.buffers.begin(), trace.buffers.end(), this), trace.buffers.end());
+        }
+
+        void add(const Event& p_event)
+        {
+            auto& trace = traceFile();
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                const auto generation = trace.generation.load();
+                if(generation != m_generation)
+                {
+                    m_events.clear();
+                    m_generation = generation;
+                }
+                m_events.push_back(p_event);
+                if(m_events.size() < BUFFER_SIZE)
+                {
+                    return;
+                }
+                m_writing.swap(m_events);
+                m_events.reserve(BUFFER_SIZE);
+            }
+
+            std::lock_guard<std::mutex> lock(trace.mutex);
+            if(trace.generation == m_generation)
+            {
+                writeEvents(trace, m_threadId, m_writing);
+            }
+            m_writing.clear();
+        }
+
+        // Needs the mutex of the file
+        void flushLocked(TraceFile& p_trace)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(p_trace.generation == m_generation)
+            {
+                writeEvents(p_trace, m_threadId, m_events);
+            }
+            m_events.clear();
+        }
+    };
+
+    ThreadBuffer& threadBuffer()
+    {
+        static thread_local ThreadBuffer buffer;
+        return buffer;
+    }
+} // namespace
+
+bool Trace::start(const std::string& p_path)
+{
+    auto& trace = traceFile();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    if(trace.file != nullptr)
+    {
+        return false;
+    }
+    trace.file = std::fopen(p_path.c_str(), "w");
+    if(trace.file == nullptr)
+    {
+        return false;
+    }
+    std::fputs("[", trace.file);
+    trace.first = true;
+    trace.origin = Clock::now();
+    ++trace.generation;
+    trace.recording = true;
+    return true;
+}
+
+void Trace::stop()
+{
+    auto& trace = traceFile();
+    std::lock_guard<std::mutex> lock(trace.mutex);
+    trace.recording = false;
+    for(auto* buffer : trace.buffers)
+    {
+        buffer->flushLocked(trace);
+    }
+    ++trace.generation;
+    if(trace.file != nullptr)
+    {
+        std::fputs("\n]\n", trace.file);
+        std::fclose(trace.file);
+        trace.file = nullptr;
+    }
+}
+
+bool Trace::isRecording()
+{
+    return traceFile().recording.load(std::memory_order_relaxed);
+}
+
+void Trace::complete(const char* p_category, const char* p_name, Clock::time_point p_start, Clock::time_point p_end)
+{
+    if(isRecording())
+    {
+        threadBuffer().add(Event{p_category, p_name, 'X', p_start, p_end - p_start});
+    }
+}
+
+void Trace::instant(const char* p_category, const char* p_name)
+{
+    if(isRecording())
+    {
+        threadBuffer().add(Event{p_category, p_name, 'i', Clock::now(), Clock::duration::zero()});
+    }
+}
+
+#endif
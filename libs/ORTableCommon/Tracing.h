@@ -0,0 +1,101 @@
+/**
+ * @brief Trace points for profiling production-like runs. The macros compile to nothing unless the build enables
+ * ORTABLE_TRACING (CMake option of the same name), so the trace points can stay in the hot paths.
+ *
+ * With tracing enabled, every trace point
+ *  - fires a USDT probe (provider "ortable": scope_entry/scope_return/instant with category and name), if sys/sdt.h
+ *    was found at configure time. perf lists them with "perf list sdt_ortable:*" once the binary was added to the
+ *    build-id cache ("perf buildid-cache --add <binary>"), bpftrace and SystemTap can attach directly
+ *  - records an event for a Chrome trace file (chrome://tracing, Perfetto) while Trace::start() is active. The events
+ *    are buffered per thread and written in batches, so threads do not contend while recording
+ *
+ * Categories and names must be string literals, only their addresses are recorded.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#ifdef ORTABLE_TRACING
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+#ifdef ORTABLE_TRACING_USDT
+#include <sys/sdt.h>
+#define ORTABLE_TRACE_PROBE(probe, category, name) DTRACE_PROBE2(ortable, probe, category, name)
+#else
+#define ORTABLE_TRACE_PROBE(probe, category, name) static_cast<void>(0)
+#endif
+
+namespace ORTable
+{
+    class Trace
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        /**
+         * @brief Starts writing a Chrome trace file (JSON array format). Events of all threads recorded until stop()
+         * end up in the file. Returns false if the file cannot be created.
+         */
+        static bool start(const std::string& p_path);
+        // Writes the buffered events and closes the file
+        static void stop();
+        static bool isRecording();
+
+        static void complete(const char* p_category, const char* p_name, Clock::time_point p_start, Clock::time_point p_end);
+        static void instant(const char* p_category, const char* p_name);
+    };
+
+    // Traces the lifetime of the scope it is declared in
+    class TraceScope
+    {
+    private:
+        const char* m_category;
+        const char* m_name;
+        Trace::Clock::time_point m_start;
+
+    public:
+        TraceScope(const char* p_category, const char* p_name)
+            : m_category(p_category)
+            , m_name(p_name)
+            , m_start(Trace::Clock::now())
+        {
+            ORTABLE_TRACE_PROBE(scope_entry, p_category, p_name);
+        }
+
+        ~TraceScope()
+        {
+            ORTABLE_TRACE_PROBE(scope_return, m_category, m_name);
+            Trace::complete(m_category, m_name, m_start, Trace::Clock::now());
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+    };
+} // namespace ORTable
+
+#define ORTABLE_TRACE_CONCAT_INNER(a, b) a##b
+#define ORTABLE_TRACE_CONCAT(a, b) ORTABLE_TRACE_CONCAT_INNER(a, b)
+
+#define ORTABLE_TRACE_SCOPE(category, name) ::ORTable::TraceScope ORTABLE_TRACE_CONCAT(ortableTraceScope, __LINE__)(category, name)
+#define ORTABLE_TRACE_INSTANT(category, name)                                                                                  \
+    do                                                                                                                         \
+    {                                                                                                                          \
+        ORTABLE_TRACE_PROBE(instant, category, name);                                                                          \
+        ::ORTable::Trace::instant(category, name);                                                                             \
+    } while(false)
+#define ORTABLE_TRACE_START(path) ::ORTable::Trace::start(path)
+#define ORTABLE_TRACE_STOP() ::ORTable::Trace::stop()
+
+#else
+
+#define ORTABLE_TRACE_SCOPE(category, name) static_cast<void>(0)
+#define ORTABLE_TRACE_INSTANT(category, name) static_cast<void>(0)
+#define ORTABLE_TRACE_START(path) static_cast<void>(path)
+#define ORTABLE_TRACE_STOP() static_cast<void>(0)
+
+#endif
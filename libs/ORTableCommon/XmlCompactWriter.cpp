@@ -0,0 +1,96 @@
+#include "XmlCompactWriter.h"
+
+using namespace ORTable;
+
+XmlCompactWriter::XmlCompactWriter(std::string& p_output)
+    : m_output(p_output)
+{
+}
+
+void XmlCompactWriter::closeStartTag()
+{
+    if(m_startTagOpen)
+    {
+        m_output.push_back('>');
+        m_startTagOpen = false;
+    }
+}
+
+void XmlCompactWriter::onStartElement(const std::string& p_name, const std::vector<XmlAttribute>& p_attributes)
+{
+    closeStartTag();
+    m_output.push_back('<');
+    m_output.append(p_name);
+    for(const auto& attribute : p_attributes)
+    {
+        m_output.push_back(' ');
+        m_output.append(attribute.name);
+        m_output.append("=\"");
+        appendEscaped(m_output, attribute.value, true);
+        m_output.push_back('"');
+    }
+    m_startTagOpen = true;
+}
+
+void XmlCompactWriter::onEndElement(const std::string& p_name)
+{
+    if(m_startTagOpen)
+    {
+        m_output.append("/>");
+        m_startTagOpen = false;
+        return;
+    }
+    m_output.append("</");
+    m_output.append(p_name);
+    m_output.push_back('>');
+}
+
+void XmlCompactWriter::onText(const std::string& p_text)
+{
+    closeStartTag();
+    appendEscaped(m_output, p_text, false);
+}
+
+void XmlCompactWriter::appendEscaped(std::string& p_target, const std::string& p_value, bool p_isAttribute)
+{
+    for(const auto c : p_value)
+    {
+        switch(c)
+        {
+            case '&':
+                p_target.append("&amp;");
+                break;
+            case '<':
+                p_target.append("&lt;");
+                break;
+            case '>':
+                p_target.append("&gt;");
+                break;
+            case '"':
+                if(p_isAttribute)
+                {
+                    p_target.append("&quot;");
+                }
+                else
+                {
+                    p_target.push_back(c);
+                }
+                break;
+            case '\n':
+            case '\r':
+            case '\t':
+                // Keep attribute whitespace from being normalized away on the next parse
+                if(p_isAttribute)
+                {
+                    p_target.append("&#" + std::to_string(static_cast<int>(c)) + ";");
+                }
+                else
+                {
+                    p_target.push_back(c);
+                }
+                break;
+            default:
+                p_target.push_back(c);
+        }
+    }
+}
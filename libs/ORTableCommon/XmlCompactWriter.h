@@ -0,0 +1,36 @@
+/**
+ * @brief XmlStreamHandler that re-serializes the events it receives without indentation and comments.
+ * Used to hand a smaller document to the sdcX loader while the XmlStreamReader walks the file.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "XmlStreamReader.h"
+
+#include <string>
+#include <vector>
+
+namespace ORTable
+{
+    class XmlCompactWriter : public XmlStreamHandler
+    {
+    private:
+        std::string& m_output;
+        // The '>' of the last start tag is deferred, so an element without content can be written as "<a/>"
+        bool m_startTagOpen{false};
+
+        void closeStartTag();
+
+    public:
+        explicit XmlCompactWriter(std::string& p_output);
+
+        void onStartElement(const std::string& p_name, const std::vector<XmlAttribute>& p_attributes) override;
+        void onEndElement(const std::string& p_name) override;
+        void onText(const std::string& p_text) override;
+
+        static void appendEscaped(std::string& p_target, const std::string& p_value, bool p_isAttribute);
+    };
+} // namespace ORTable
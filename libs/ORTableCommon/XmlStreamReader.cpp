@@ -0,0 +1,586 @@
+#include "XmlStreamReader.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <utility>
+
+using namespace ORTable;
+
+namespace
+{
+    constexpr int END_OF_INPUT{-1};
+
+    bool isWhitespace(int p_char)
+    {
+        return p_char == ' ' || p_char == '\t' || p_char == '\r' || p_char == '\n';
+    }
+
+    bool isNameChar(int p_char)
+    {
+        return p_char > 0x7F || (p_char >= 'a' && p_char <= 'z') || (p_char >= 'A' && p_char <= 'Z')
+               || (p_char >= '0' && p_char <= '9') || p_char == '_' || p_char == ':' || p_char == '-' || p_char == '.';
+    }
+
+    bool isNameStartChar(int p_char)
+    {
+        return isNameChar(p_char) && p_char != '-' && p_char != '.' && !(p_char >= '0' && p_char <= '9');
+    }
+
+    bool isWhitespaceOnly(const std::string& p_text)
+    {
+        for(const auto c : p_text)
+        {
+            if(!isWhitespace(static_cast<unsigned char>(c)))
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void appendUtf8(std::string& p_target, unsigned long p_codePoint)
+    {
+        if(p_codePoint < 0x80)
+        {
+            p_target.push_back(static_cast<char>(p_codePoint));
+        }
+        else if(p_codePoint < 0x800)
+        {
+            p_target.push_back(static_cast<char>(0xC0 | (p_codePoint >> 6)));
+            p_target.push_back(static_cast<char>(0x80 | (p_codePoint & 0x3F)));
+        }
+        else if(p_codePoint < 0x10000)
+        {
+            p_target.push_back(static_cast<char>(0xE0 | (p_codePoint >> 12)));
+            p_target.push_back(static_cast<char>(0x80 | ((p_codePoint >> 6) & 0x3F)));
+            p_target.push_back(static_cast<char>(0x80 | (p_codePoint & 0x3F)));
+        }
+        else
+        {
+            p_target.push_back(static_cast<char>(0xF0 | (p_codePoint >> 18)));
+            p_target.push_back(static_cast<char>(0x80 | ((p_codePoint >> 12) & 0x3F)));
+            p_target.push_back(static_cast<char>(0x80 | ((p_codePoint >> 6) & 0x3F)));
+            p_target.push_back(static_cast<char>(0x80 | (p_codePoint & 0x3F)));
+        }
+    }
+} // namespace
+
+
+XmlParseError::XmlParseError(std::string p_message, std::size_t p_line, std::size_t p_column)
+    : m_message(std::move(p_message))
+    , m_line(p_line)
+    , m_column(p_column)
+{
+}
+
+bool XmlParseError::isSet() const
+{
+    return !m_message.empty();
+}
+
+const std::string& XmlParseError::getMessage() const
+{
+    return m_message;
+}
+
+std::size_t XmlParseError::getLine() const
+{
+    return m_line;
+}
+
+std::size_t XmlParseError::getColumn() const
+{
+    return m_column;
+}
+
+std::string XmlParseError::toString() const
+{
+    return std::to_string(m_line) + ":" + std::to_string(m_column) + ": " + m_message;
+}
+
+
+constexpr std::size_t XmlStreamReader::DEFAULT_CHUNK_SIZE;
+
+XmlStreamReader::XmlStreamReader(std::size_t p_chunkSize)
+    : m_chunk(p_chunkSize > 0 ? p_chunkSize : DEFAULT_CHUNK_SIZE)
+{
+}
+
+bool XmlStreamReader::fillChunk()
+{
+    if(m_stream == nullptr || !m_stream->good())
+    {
+        return false;
+    }
+    m_stream->read(m_chunk.data(), static_cast<std::streamsize>(m_chunk.size()));
+    m_chunkPos = 0;
+    m_chunkEnd = static_cast<std::size_t>(m_stream->gcount());
+    return m_chunkEnd > 0;
+}
+
+int XmlStreamReader::peek()
+{
+    if(m_chunkPos == m_chunkEnd && !fillChunk())
+    {
+        return END_OF_INPUT;
+    }
+    return static_cast<unsigned char>(m_chunk[m_chunkPos]);
+}
+
+int XmlStreamReader::get()
+{
+    const auto c = peek();
+    if(c == END_OF_INPUT)
+    {
+        return c;
+    }
+    ++m_chunkPos;
+    if(c == '\n')
+    {
+        ++m_line;
+        m_column = 0;
+    }
+    else
+    {
+        ++m_column;
+    }
+    return c;
+}
+
+bool XmlStreamReader::fail(const std::string& p_message)
+{
+    if(!m_error.isSet())
+    {
+        m_error = XmlParseError(p_message, m_line, m_column);
+    }
+    return false;
+}
+
+bool XmlStreamReader::failAtToken(const std::string& p_message)
+{
+    if(!m_error.isSet())
+    {
+        m_error = XmlParseError(p_message, m_tokenLine, m_tokenColumn);
+    }
+    return false;
+}
+
+void XmlStreamReader::abort(const std::string& p_message)
+{
+    failAtToken(p_message);
+}
+
+const XmlParseError& XmlStreamReader::getError() const
+{
+    return m_error;
+}
+
+std::size_t XmlStreamReader::getLine() const
+{
+    return m_tokenLine;
+}
+
+std::size_t XmlStreamReader::getColumn() const
+{
+    return m_tokenColumn;
+}
+
+StringView XmlStreamReader::localName(StringView p_qualifiedName)
+{
+    const auto pos = p_qualifiedName.find(':');
+    return pos == StringView::npos ? p_qualifiedName : p_qualifiedName.substr(pos + 1);
+}
+
+bool XmlStreamReader::readName(int p_first, std::string& p_name)
+{
+    p_name.clear();
+    if(!isNameStartChar(p_first))
+    {
+        return fail("expected a name");
+    }
+    p_name.push_back(static_cast<char>(p_first));
+    while(isNameChar(peek()))
+    {
+        p_name.push_back(static_cast<char>(get()));
+    }
+    return true;
+}
+
+bool XmlStreamReader::skipWhitespace(int& p_next)
+{
+    bool skipped = false;
+    p_next = get();
+    while(isWhitespace(p_next))
+    {
+        skipped = true;
+        p_next = get();
+    }
+    return skipped;
+}
+
+bool XmlStreamReader::readEntity(std::string& p_target)
+{
+    // Called after '&'
+    std::string entity;
+    int c = get();
+    while(c != ';')
+    {
+        if(c == END_OF_INPUT || entity.size() > 10)
+        {
+            return fail("unterminated entity reference");
+        }
+        entity.push_back(static_cast<char>(c));
+        c = get();
+    }
+
+    if(entity == "lt")
+    {
+        p_target.push_back('<');
+    }
+    else if(entity == "gt")
+    {
+        p_target.push_back('>');
+    }
+    else if(entity == "amp")
+    {
+        p_target.push_back('&');
+    }
+    else if(entity == "quot")
+    {
+        p_target.push_back('"');
+    }
+    else if(entity == "apos")
+    {
+        p_target.push_back('\'');
+    }
+    else if(entity.size() > 1 && entity[0] == '#')
+    {
+        const bool hex = entity[1] == 'x' || entity[1] == 'X';
+        const char* digits = entity.c_str() + (hex ? 2 : 1);
+        char* end = nullptr;
+        const auto codePoint = std::strtoul(digits, &end, hex ? 16 : 10);
+        if(*digits == '\0' || *end != '\0' || codePoint == 0 || codePoint > 0x10FFFF)
+        {
+            return fail("invalid character reference &" + entity + ";");
+        }
+        appendUtf8(p_target, codePoint);
+    }
+    else
+    {
+        return fail("unknown entity &" + entity + ";");
+    }
+    return true;
+}
+
+bool XmlStreamReader::skipUntil(const char* p_terminator)
+{
+    const auto length = std::strlen(p_terminator);
+    std::size_t matched = 0;
+    while(matched < length)
+    {
+        const auto c = get();
+        if(c == END_OF_INPUT)
+        {
+            return failAtToken(std::string("unexpected end of document, missing '") + p_terminator + "'");
+        }
+        if(c == p_terminator[matched])
+        {
+            ++matched;
+        }
+        else
+        {
+            matched = (c == p_terminator[0]) ? 1 : 0;
+        }
+    }
+    return true;
+}
+
+bool XmlStreamReader::readMarkupDeclaration(XmlStreamHandler& p_handler)
+{
+    // Called after "<!"
+    if(peek() == '-')
+    {
+        get();
+        if(get() != '-')
+        {
+            return fail("malformed comment");
+        }
+        return skipUntil("-->");
+    }
+    if(peek() == '[')
+    {
+        const char* cdata = "[CDATA[";
+        for(std::size_t i = 0; cdata[i] != '\0'; ++i)
+        {
+            if(get() != cdata[i])
+            {
+                return fail("malformed CDATA section");
+            }
+        }
+        if(m_openElements.empty())
+        {
+            return failAtToken("CDATA section outside of the root element");
+        }
+        const auto start = m_text.size();
+        while(m_text.size() < start + 3 || m_text.compare(m_text.size() - 3, 3, "]]>") != 0)
+        {
+            const auto c = get();
+            if(c == END_OF_INPUT)
+            {
+                return failAtToken("unexpected end of document, unterminated CDATA section");
+            }
+            m_text.push_back(static_cast<char>(c));
+        }
+        m_text.resize(m_text.size() - 3);
+        return flushText(p_handler);
+    }
+    // DOCTYPE and friends carry nothing the MDIB needs
+    return skipUntil(">");
+}
+
+bool XmlStreamReader::readAttributes(bool& p_selfClosing)
+{
+    m_attributes.clear();
+    p_selfClosing = false;
+
+    int c = 0;
+    bool separated = skipWhitespace(c);
+    while(true)
+    {
+        if(c == '>')
+        {
+            return true;
+        }
+        if(c == '/')
+        {
+            if(get() != '>')
+            {
+                return fail("expected '>' after '/'");
+            }
+            p_selfClosing = true;
+            return true;
+        }
+        if(c == END_OF_INPUT)
+        {
+            return failAtToken("unexpected end of document inside start tag <" + m_name + ">");
+        }
+        if(!separated)
+        {
+            return fail("expected whitespace between attributes");
+        }
+
+        XmlAttribute attribute;
+        if(!readName(c, attribute.name))
+        {
+            return false;
+        }
+        skipWhitespace(c);
+        if(c != '=')
+        {
+            return fail("expected '=' after attribute " + attribute.name);
+        }
+        skipWhitespace(c);
+        if(c != '"' && c != '\'')
+        {
+            return fail("expected quoted value for attribute " + attribute.name);
+        }
+        const auto quote = c;
+        c = get();
+        while(c != quote)
+        {
+            if(c == END_OF_INPUT || c == '<')
+            {
+                return fail("unterminated value of attribute " + attribute.name);
+            }
+            if(c == '&')
+            {
+                if(!readEntity(attribute.value))
+                {
+                    return false;
+                }
+            }
+            else
+            {
+                attribute.value.push_back(static_cast<char>(c));
+            }
+            c = get();
+        }
+        for(const auto& existing : m_attributes)
+        {
+            if(existing.name == attribute.name)
+            {
+                return fail("duplicate attribute " + attribute.name);
+            }
+        }
+        m_attributes.push_back(std::move(attribute));
+        separated = skipWhitespace(c);
+    }
+}
+
+bool XmlStreamReader::readStartElement(int p_first, XmlStreamHandler& p_handler)
+{
+    if(m_openElements.empty() && !m_name.empty())
+    {
+        return failAtToken("document contains more than one root element");
+    }
+    if(!readName(p_first, m_name))
+    {
+        return false;
+    }
+    bool selfClosing = false;
+    if(!readAttributes(selfClosing))
+    {
+        return false;
+    }
+
+    p_handler.onStartElement(m_name, m_attributes);
+    if(m_error.isSet())
+    {
+        return false;
+    }
+    if(selfClosing)
+    {
+        p_handler.onEndElement(m_name);
+        // keeps m_name non-empty so a second root element is detected
+        return !m_error.isSet();
+    }
+    m_openElements.push_back(m_name);
+    return true;
+}
+
+bool XmlStreamReader::readEndElement(XmlStreamHandler& p_handler)
+{
+    // Called after "</"
+    if(!readName(get(), m_name))
+    {
+        return false;
+    }
+    int c = 0;
+    skipWhitespace(c);
+    if(c != '>')
+    {
+        return fail("expected '>' to close end tag </" + m_name + ">");
+    }
+    if(m_openElements.empty())
+    {
+        return failAtToken("unexpected end tag </" + m_name + ">");
+    }
+    if(m_openElements.back() != m_name)
+    {
+        return failAtToken("mismatched end tag </" + m_name + ">, expected </" + m_openElements.back() + ">");
+    }
+    m_openElements.pop_back();
+    p_handler.onEndElement(m_name);
+    return !m_error.isSet();
+}
+
+bool XmlStreamReader::flushText(XmlStreamHandler& p_handler)
+{
+    if(m_text.empty())
+    {
+        return true;
+    }
+    if(isWhitespaceOnly(m_text))
+    {
+        m_text.clear();
+        return true;
+    }
+    if(m_openElements.empty())
+    {
+        return failAtToken("text outside of the root element");
+    }
+    p_handler.onText(m_text);
+    m_text.clear();
+    return !m_error.isSet();
+}
+
+bool XmlStreamReader::parse(std::istream& p_stream, XmlStreamHandler& p_handler)
+{
+    m_stream = &p_stream;
+    m_chunkPos = 0;
+    m_chunkEnd = 0;
+    m_line = 1;
+    m_column = 0;
+    m_name.clear();
+    m_text.clear();
+    m_openElements.clear();
+    m_error = XmlParseError();
+
+    // Skip a UTF-8 byte order mark
+    if(peek() == 0xEF)
+    {
+        get();
+        if(get() != 0xBB || get() != 0xBF)
+        {
+            return fail("invalid byte order mark");
+        }
+        m_column = 0;
+    }
+
+    bool ok = true;
+    while(ok)
+    {
+        auto c = get();
+        if(c == END_OF_INPUT)
+        {
+            break;
+        }
+        if(c == '<')
+        {
+            m_tokenLine = m_line;
+            m_tokenColumn = m_column;
+            // The text before this markup is complete; comments and PIs split it like an element would
+            ok = flushText(p_handler);
+            if(!ok)
+            {
+                break;
+            }
+
+            c = get();
+            if(c == '?')
+            {
+                ok = skipUntil("?>");
+            }
+            else if(c == '!')
+            {
+                ok = readMarkupDeclaration(p_handler);
+            }
+            else if(c == '/')
+            {
+                ok = readEndElement(p_handler);
+            }
+            else
+            {
+                ok = readStartElement(c, p_handler);
+            }
+        }
+        else if(c == '&')
+        {
+            ok = readEntity(m_text);
+        }
+        else
+        {
+            m_text.push_back(static_cast<char>(c));
+        }
+    }
+
+    if(ok)
+    {
+        ok = flushText(p_handler);
+    }
+    if(ok && p_stream.bad())
+    {
+        ok = fail("read error");
+    }
+    if(ok && !m_openElements.empty())
+    {
+        ok = fail("unexpected end of document, <" + m_openElements.back() + "> is not closed");
+    }
+    if(ok && m_name.empty())
+    {
+        ok = fail("document contains no root element");
+    }
+
+    m_stream = nullptr;
+    return ok && !m_error.isSet();
+}
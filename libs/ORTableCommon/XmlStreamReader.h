@@ -0,0 +1,128 @@
+/**
+ * @brief Minimal streaming (SAX style) XML reader used to load MDIB documents and SOAP messages without building a DOM.
+ * The input is consumed in fixed size chunks, so the memory needed for parsing is bounded by the chunk size, the element
+ * depth and the longest single token instead of the document size.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "StringView.h"
+
+#include <cstddef>
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace ORTable
+{
+    struct XmlAttribute
+    {
+        std::string name;
+        std::string value;
+    };
+
+    /**
+     * @brief Callback interface of the XmlStreamReader. Names are passed qualified (e.g. "p2:Metric"),
+     * attribute values and text are passed with entities already resolved.
+     * Whitespace-only text between elements is not reported.
+     */
+    class XmlStreamHandler
+    {
+    public:
+        virtual ~XmlStreamHandler() = default;
+
+        virtual void onStartElement(const std::string& p_name, const std::vector<XmlAttribute>& p_attributes) = 0;
+        virtual void onEndElement(const std::string& p_name) = 0;
+        virtual void onText(const std::string& p_text) = 0;
+    };
+
+    class XmlParseError
+    {
+    private:
+        std::string m_message;
+        std::size_t m_line{0};
+        std::size_t m_column{0};
+
+    public:
+        XmlParseError() = default;
+        XmlParseError(std::string p_message, std::size_t p_line, std::size_t p_column);
+
+        bool isSet() const;
+        const std::string& getMessage() const;
+        std::size_t getLine() const;
+        std::size_t getColumn() const;
+
+        // e.g. "12:7: mismatched end tag </p2:Mds>, expected </p2:Vmd>"
+        std::string toString() const;
+    };
+
+    class XmlStreamReader
+    {
+    public:
+        static constexpr std::size_t DEFAULT_CHUNK_SIZE{64 * 1024};
+
+    private:
+        std::istream* m_stream{nullptr};
+        std::vector<char> m_chunk;
+        std::size_t m_chunkPos{0};
+        std::size_t m_chunkEnd{0};
+
+        std::size_t m_line{1};
+        std::size_t m_column{0};
+        std::size_t m_tokenLine{1};
+        std::size_t m_tokenColumn{0};
+
+        // Reused between events to avoid allocations per element
+        std::string m_name;
+        std::string m_text;
+        std::vector<XmlAttribute> m_attributes;
+        std::vector<std::string> m_openElements;
+
+        XmlParseError m_error;
+
+        int get();
+        int peek();
+        bool fillChunk();
+
+        bool fail(const std::string& p_message);
+        bool failAtToken(const std::string& p_message);
+
+        bool readName(int p_first, std::string& p_name);
+        bool skipWhitespace(int& p_next);
+        bool readEntity(std::string& p_target);
+        bool skipUntil(const char* p_terminator);
+        bool readAttributes(bool& p_selfClosing);
+        bool readMarkupDeclaration(XmlStreamHandler& p_handler);
+        bool readStartElement(int p_first, XmlStreamHandler& p_handler);
+        bool readEndElement(XmlStreamHandler& p_handler);
+        bool flushText(XmlStreamHandler& p_handler);
+
+    public:
+        explicit XmlStreamReader(std::size_t p_chunkSize = DEFAULT_CHUNK_SIZE);
+
+        /**
+         * @brief Parses the whole stream and reports events to the given handler.
+         * Stops at the first error, which is then available via getError().
+         * @return true in case the document was well-formed and the handler did not abort
+         */
+        bool parse(std::istream& p_stream, XmlStreamHandler& p_handler);
+
+        /**
+         * @brief Lets a handler reject the document from within a callback. The error is reported with the position
+         * of the markup that triggered the callback.
+         */
+        void abort(const std::string& p_message);
+
+        const XmlParseError& getError() const;
+
+        // Position of the markup currently reported to the handler
+        std::size_t getLine() const;
+        std::size_t getColumn() const;
+
+        // Strips the namespace prefix of a qualified name, the result points into the given name
+        static StringView localName(StringView p_qualifiedName);
+    };
+} // namespace ORTable
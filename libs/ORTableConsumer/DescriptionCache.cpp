@@ -0,0 +1,262 @@
+#include "DescriptionCache.h"
+
+#include "XmlStreamReader.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <direct.h>
+#else
+#include <sys/stat.h>
+#endif
+
+namespace
+{
+    const std::string FILE_MAGIC{"ORTableDescriptionCache 3"};
+
+    std::uint64_t hashString(const std::string& p_value)
+    {
+        std::uint64_t hash{14695981039346656037ULL};
+        for(const auto c : p_value)
+        {
+            hash ^= static_cast<unsigned char>(c);
+            hash *= 1099511628211ULL;
+        }
+        return hash;
+    }
+
+    std::string hashToHex(const std::string& p_value)
+    {
+        const auto hash = hashString(p_value);
+        char buffer[17];
+        std::snprintf(buffer, sizeof(buffer), "%016llx", static_cast<unsigned long long>(hash));
+        return buffer;
+    }
+
+    bool isValidKey(const std::string& p_value)
+    {
+        return !p_value.empty() && p_value.find('\n') == std::string::npos;
+    }
+
+    // Collects "handle version" of every state of an MdState
+    class DescriptorVersionCollector : public ORTable::XmlStreamHandler
+    {
+    private:
+        std::vector<std::string>& m_entries;
+
+    public:
+        explicit DescriptorVersionCollector(std::vector<std::string>& p_entries)
+            : m_entries(p_entries)
+        {
+        }
+
+        void onStartElement(const std::string& p_name, const std::vector<ORTable::XmlAttribute>& p_attributes) override
+        {
+            if(ORTable::XmlStreamReader::localName(p_name) != "State")
+            {
+                return;
+            }
+            std::string handle;
+            // The attribute is optional, its default is 0
+            std::string version{"0"};
+            for(const auto& attribute : p_attributes)
+            {
+                if(attribute.name == "DescriptorHandle")
+                {
+                    handle = attribute.value;
+                }
+                else if(attribute.name == "DescriptorVersion")
+                {
+                    version = attribute.value;
+                }
+            }
+            m_entries.push_back(handle + ' ' + version);
+        }
+        void onEndElement(const std::string&) override
+        {
+        }
+        void onText(const std::string&) override
+        {
+        }
+    };
+} // namespace
+
+DescriptionCache::DescriptionCache(std::string p_directory, ORTable::CompressionConfig p_compression)
+    : m_directory(std::move(p_directory))
+    , m_compression(std::move(p_compression))
+{
+    // Fails harmlessly if the directory already exists
+#ifdef _WIN32
+    _mkdir(m_directory.c_str());
+#else
+    mkdir(m_directory.c_str(), 0755);
+#endif
+}
+
+std::string DescriptionCache::pathFor(const std::string& p_providerEpr) const
+{
+    // EPRs are URNs or URLs, hashing them gives a valid file name on every platform
+    return m_directory + "/" + hashToHex(p_providerEpr) + ".mddescription";
+}
+
+bool DescriptionCache::readHeader(std::istream& p_file,
+                                  const std::string& p_providerEpr,
+                                  std::string& p_sequenceId,
+                                  std::uint64_t& p_descriptorVersions,
+                                  unsigned long long& p_descriptionVersion) const
+{
+    std::string magic;
+    std::string epr;
+    std::string descriptorVersions;
+    std::string version;
+    if(!std::getline(p_file, magic) || magic != FILE_MAGIC)
+    {
+        return false;
+    }
+    if(!std::getline(p_file, epr) || epr != p_providerEpr)
+    {
+        return false;
+    }
+    if(!std::getline(p_file, p_sequenceId) || !std::getline(p_file, descriptorVersions) || !std::getline(p_file, version))
+    {
+        return false;
+    }
+    std::istringstream descriptorVersionsStream(descriptorVersions);
+    std::istringstream versionStream(version);
+    return static_cast<bool>(descriptorVersionsStream >> p_descriptorVersions) && static_cast<bool>(versionStream >> p_descriptionVersion);
+}
+
+bool DescriptionCache::descriptorVersionsOf(const std::string& p_mdState, std::uint64_t& p_descriptorVersions)
+{
+    std::vector<std::string> entries;
+    DescriptorVersionCollector collector(entries);
+    ORTable::XmlStreamReader reader;
+    std::istringstream stream(p_mdState);
+    if(!reader.parse(stream, collector))
+    {
+        return false;
+    }
+    // Context descriptors have any number of states, the set of descriptors counts
+    std::sort(entries.begin(), entries.end());
+    entries.erase(std::unique(entries.begin(), entries.end()), entries.end());
+    std::string joined;
+    for(const auto& entry : entries)
+    {
+        joined += entry;
+        joined += '\n';
+    }
+    p_descriptorVersions = hashString(joined);
+    return true;
+}
+
+bool DescriptionCache::load(const std::string& p_providerEpr,
+                            const std::string& p_sequenceId,
+                            std::uint64_t p_descriptorVersions,
+                            std::string& p_description,
+                            unsigned long long& p_descriptionVersion) const
+{
+    std::ifstream file(pathFor(p_providerEpr), std::ios::binary);
+    std::string sequenceId;
+    std::uint64_t descriptorVersions{0};
+    if(!file || !readHeader(file, p_providerEpr, sequenceId, descriptorVersions, p_descriptionVersion))
+    {
+        return false;
+    }
+    if(sequenceId != p_sequenceId || descriptorVersions != p_descriptorVersions)
+    {
+        return false;
+    }
+
+    std::string encodingLine;
+    std::string sizeLine;
+    std::size_t size{0};
+    auto encoding = ORTable::ContentEncoding::Identity;
+    if(!std::getline(file, encodingLine) || !ORTable::ContentCoding::fromString(encodingLine, encoding))
+    {
+        return false;
+    }
+    if(!std::getline(file, sizeLine) || !(std::istringstream(sizeLine) >> size))
+    {
+        return false;
+    }
+    // A corrupt header must not allocate more than the file holds
+    const auto payloadStart = file.tellg();
+    file.seekg(0, std::ios::end);
+    const auto fileEnd = file.tellg();
+    file.seekg(payloadStart);
+    if(payloadStart < 0 || fileEnd < payloadStart || size > static_cast<std::size_t>(fileEnd - payloadStart))
+    {
+        return false;
+    }
+    std::string payload(size, '\0');
+    if(!file.read(&payload[0], static_cast<std::streamsize>(size)))
+    {
+        // Truncated entry, e.g. the disk ran full while writing
+        return false;
+    }
+    if(encoding == ORTable::ContentEncoding::Identity)
+    {
+        p_description = std::move(payload);
+        return true;
+    }
+    // Fails for codings this build does not support, the entry is fetched and stored again then
+    return ORTable::ContentCoding::decompress(encoding, payload, p_description, m_compression.maxDecompressedSize);
+}
+
+bool DescriptionCache::store(const std::string& p_providerEpr,
+                             const std::string& p_sequenceId,
+                             std::uint64_t p_descriptorVersions,
+                             unsigned long long p_descriptionVersion,
+                             const std::string& p_description)
+{
+    if(!isValidKey(p_providerEpr) || !isValidKey(p_sequenceId))
+    {
+        return false;
+    }
+
+    auto encoding = ORTable::ContentCoding::negotiate(
+        ORTable::ContentCoding::makeAcceptEncoding(m_compression), m_compression, p_description.size());
+    std::string compressed;
+    if(encoding != ORTable::ContentEncoding::Identity
+       && !ORTable::ContentCoding::compress(encoding, m_compression.level, p_description, compressed))
+    {
+        encoding = ORTable::ContentEncoding::Identity;
+    }
+    const auto& payload = encoding == ORTable::ContentEncoding::Identity ? p_description : compressed;
+
+    const auto path = pathFor(p_providerEpr);
+    const auto temporaryPath = path + ".tmp";
+    {
+        std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+        file << FILE_MAGIC << '\n'
+             << p_providerEpr << '\n'
+             << p_sequenceId << '\n'
+             << p_descriptorVersions << '\n'
+             << p_descriptionVersion << '\n'
+             << ORTable::ContentCoding::toString(encoding) << '\n'
+             << payload.size() << '\n';
+        file.write(payload.data(), static_cast<std::streamsize>(payload.size()));
+        if(!file.flush())
+        {
+            file.close();
+            std::remove(temporaryPath.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    // rename does not replace existing files on Windows
+    std::remove(path.c_str());
+#endif
+    return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+void DescriptionCache::invalidate(const std::string& p_providerEpr)
+{
+    std::remove(pathFor(p_providerEpr).c_str());
+}
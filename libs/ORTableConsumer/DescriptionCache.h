@@ -0,0 +1,67 @@
+/**
+ * @brief Persistent cache for the MdDescription of providers. An entry is keyed by provider EPR, SequenceId and the
+ * descriptor versions of the provider, so a reconnecting consumer only needs to fetch the MdState as long as the
+ * provider neither restarted (new SequenceId) nor modified its description.
+ *
+ * The DescriptionVersion is only known with the description itself. The descriptor versions are taken from the
+ * MdState instead: every state carries the handle and DescriptorVersion of its descriptor, so a description the
+ * provider modified while the consumer was offline, e.g. by a reload that keeps the SequenceId, yields a miss.
+ *
+ * One file per provider is kept in the cache directory. The key is stored in a header inside the file and checked
+ * on every load, a file name collision therefore yields a miss instead of a wrong description.
+ * Large descriptions are stored with the content coding the compression config selects for a body of that size.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "ContentCoding.h"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+
+class DescriptionCache
+{
+private:
+    const std::string m_directory;
+    const ORTable::CompressionConfig m_compression;
+
+    std::string pathFor(const std::string& p_providerEpr) const;
+    bool readHeader(std::istream& p_file,
+                    const std::string& p_providerEpr,
+                    std::string& p_sequenceId,
+                    std::uint64_t& p_descriptorVersions,
+                    unsigned long long& p_descriptionVersion) const;
+
+public:
+    explicit DescriptionCache(std::string p_directory, ORTable::CompressionConfig p_compression = ORTable::CompressionConfig());
+
+    /**
+     * @brief Fingerprint of the descriptor handles and DescriptorVersions the states of an MdState refer to.
+     * Independent of the order of the states and of the number of context states per descriptor.
+     * @return false if the MdState could not be parsed
+     */
+    static bool descriptorVersionsOf(const std::string& p_mdState, std::uint64_t& p_descriptorVersions);
+
+    /**
+     * @brief Loads the description cached for the given provider, SequenceId and descriptor versions.
+     * @return false if there is no such entry, p_descriptionVersion is the one of the cached description otherwise
+     */
+    bool load(const std::string& p_providerEpr,
+              const std::string& p_sequenceId,
+              std::uint64_t p_descriptorVersions,
+              std::string& p_description,
+              unsigned long long& p_descriptionVersion) const;
+
+    // Replaces the entry of the provider. The file is written aside and renamed, so readers never see partial entries
+    bool store(const std::string& p_providerEpr,
+               const std::string& p_sequenceId,
+               std::uint64_t p_descriptorVersions,
+               unsigned long long p_descriptionVersion,
+               const std::string& p_description);
+
+    void invalidate(const std::string& p_providerEpr);
+};
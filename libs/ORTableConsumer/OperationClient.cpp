@@ -0,0 +1,291 @@
+#include "OperationClient.h"
+
+#include <algorithm>
+
+namespace
+{
+    const char* const INVOCATION_STATE_NAMES[] = {"Wait", "Start", "Cnclld", "CnclldMan", "Fin", "FinMod", "Fail"};
+} // namespace
+
+bool OperationResult::success() const
+{
+    return state == InvocationState::Fin || state == InvocationState::FinMod;
+}
+
+OperationClient::OperationClient(OperationClientConfig p_config, OperationExecutor& p_executor, SendFunction p_send)
+    : m_config(p_config)
+    , m_executor(p_executor)
+    , m_send(std::move(p_send))
+{
+}
+
+OperationClient::~OperationClient()
+{
+    stop();
+}
+
+void OperationClient::complete(std::uint64_t p_id, OperationResult p_result)
+{
+    const auto it = m_operations.find(p_id);
+    if(it == m_operations.end())
+    {
+        return;
+    }
+    auto& operation = it->second;
+    m_deadlines.erase({operation.deadline, p_id});
+    if(operation.requestId != 0)
+    {
+        m_byRequest.erase(operation.requestId);
+    }
+    if(operation.transactionId != 0)
+    {
+        m_byTransaction.erase(operation.transactionId);
+    }
+    if(p_result.success())
+    {
+        ++m_statistics.succeeded;
+    }
+    else if(p_result.error.empty())
+    {
+        ++m_statistics.failed;
+    }
+
+    auto completion = std::move(operation.completion);
+    m_operations.erase(it);
+    m_executor.post([completion = std::move(completion), result = std::move(p_result)]() mutable {
+        completion(std::move(result));
+    });
+}
+
+void OperationClient::bind(std::uint64_t p_id, std::uint64_t p_transactionId, InvocationState p_state)
+{
+    const auto it = m_operations.find(p_id);
+    if(it == m_operations.end())
+    {
+        return;
+    }
+    it->second.transactionId = p_transactionId;
+    m_byTransaction[p_transactionId] = p_id;
+    onState(p_id, p_state);
+
+    // The final report may have been faster than the response
+    const auto orphan = m_orphans.find(p_transactionId);
+    if(orphan != m_orphans.end())
+    {
+        const auto state = orphan->second.state;
+        m_orphans.erase(orphan);
+        onState(p_id, state);
+    }
+}
+
+void OperationClient::onState(std::uint64_t p_id, InvocationState p_state)
+{
+    if(!isFinal(p_state))
+    {
+        return;
+    }
+    const auto it = m_operations.find(p_id);
+    if(it != m_operations.end())
+    {
+        OperationResult result;
+        result.state = p_state;
+        result.transactionId = it->second.transactionId;
+        complete(p_id, std::move(result));
+    }
+}
+
+void OperationClient::activate(std::string p_operationHandle, Completion p_completion)
+{
+    std::uint64_t id;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        id = m_nextId++;
+        auto& operation = m_operations[id];
+        operation.completion = std::move(p_completion);
+        operation.deadline = Clock::now() + m_config.timeout;
+        m_deadlines.emplace(operation.deadline, id);
+        ++m_statistics.started;
+    }
+    m_wakeUp.notify_all();
+
+    // Not under the lock, the response may be delivered on another thread before send returns
+    const auto requestId = m_send(p_operationHandle);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(requestId == 0)
+    {
+        OperationResult result;
+        result.error = "Sending Activate for " + p_operationHandle + " failed";
+        ++m_statistics.failed;
+        complete(id, std::move(result));
+        return;
+    }
+    const auto it = m_operations.find(id);
+    if(it == m_operations.end())
+    {
+        // Timed out while sending
+        return;
+    }
+    it->second.requestId = requestId;
+
+    const auto early = m_earlyResponses.find(requestId);
+    if(early != m_earlyResponses.end())
+    {
+        const auto response = early->second;
+        m_earlyResponses.erase(early);
+        bind(id, response.transactionId, response.state);
+        return;
+    }
+    m_byRequest[requestId] = id;
+}
+
+void OperationClient::onResponse(std::uint64_t p_requestId, std::uint64_t p_transactionId, InvocationState p_state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_byRequest.find(p_requestId);
+    if(it == m_byRequest.end())
+    {
+        m_earlyResponses[p_requestId] = {p_transactionId, p_state, Clock::now()};
+        return;
+    }
+    const auto id = it->second;
+    m_byRequest.erase(it);
+    bind(id, p_transactionId, p_state);
+}
+
+void OperationClient::onReport(std::uint64_t p_transactionId, InvocationState p_state)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_byTransaction.find(p_transactionId);
+    if(it != m_byTransaction.end())
+    {
+        onState(it->second, p_state);
+    }
+    else if(isFinal(p_state))
+    {
+        // Either overtook the response or belongs to another consumer, expire() drops it in the latter case
+        m_orphans[p_transactionId] = {p_transactionId, p_state, Clock::now()};
+    }
+}
+
+OperationClient::Clock::time_point OperationClient::expire(Clock::time_point p_now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while(!m_deadlines.empty() && m_deadlines.begin()->first <= p_now)
+    {
+        const auto id = m_deadlines.begin()->second;
+        OperationResult result;
+        result.transactionId = m_operations[id].transactionId;
+        result.error = "Timed out after " + std::to_string(m_config.timeout.count()) + " ms";
+        ++m_statistics.timedOut;
+        complete(id, std::move(result));
+    }
+
+    const auto dropOrphans = [this, p_now](std::unordered_map<std::uint64_t, Orphan>& p_orphans) {
+        for(auto it = p_orphans.begin(); it != p_orphans.end();)
+        {
+            if(p_now - it->second.received >= m_config.orphanLifetime)
+            {
+                ++m_statistics.droppedOrphans;
+                it = p_orphans.erase(it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    };
+    dropOrphans(m_earlyResponses);
+    dropOrphans(m_orphans);
+
+    auto next = m_deadlines.empty() ? Clock::time_point::max() : m_deadlines.begin()->first;
+    if(!m_earlyResponses.empty() || !m_orphans.empty())
+    {
+        next = std::min(next, p_now + m_config.orphanLifetime);
+    }
+    return next;
+}
+
+std::size_t OperationClient::pendingCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_operations.size();
+}
+
+OperationClientStatistics OperationClient::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+void OperationClient::run()
+{
+    m_running = true;
+    m_thread = std::thread([this]() {
+        while(m_running)
+        {
+            const auto next = expire(Clock::now());
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const auto deadlinesChanged = [this, next]() {
+                return !m_running || (!m_deadlines.empty() && m_deadlines.begin()->first < next);
+            };
+            if(next == Clock::time_point::max())
+            {
+                m_wakeUp.wait(lock, deadlinesChanged);
+            }
+            else
+            {
+                m_wakeUp.wait_until(lock, next, deadlinesChanged);
+            }
+        }
+    });
+}
+
+void OperationClient::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+        while(!m_operations.empty())
+        {
+            const auto id = m_operations.begin()->first;
+            OperationResult result;
+            result.transactionId = m_operations.begin()->second.transactionId;
+            result.error = "Operation client stopped";
+            complete(id, std::move(result));
+        }
+    }
+    m_wakeUp.notify_all();
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+bool OperationClient::isFinal(InvocationState p_state)
+{
+    return p_state != InvocationState::Wait && p_state != InvocationState::Start;
+}
+
+const char* OperationClient::toString(InvocationState p_state)
+{
+    return INVOCATION_STATE_NAMES[static_cast<std::size_t>(p_state)];
+}
+
+bool OperationClient::fromString(ORTable::StringView p_name, InvocationState& p_state)
+{
+    for(auto colon = p_name.find(':'); colon != ORTable::StringView::npos; colon = p_name.find(':'))
+    {
+        p_name.remove_prefix(colon + 1);
+    }
+    for(std::size_t i = 0; i < sizeof(INVOCATION_STATE_NAMES) / sizeof(INVOCATION_STATE_NAMES[0]); ++i)
+    {
+        if(p_name == INVOCATION_STATE_NAMES[i])
+        {
+            p_state = static_cast<InvocationState>(i);
+            return true;
+        }
+    }
+    return false;
+}
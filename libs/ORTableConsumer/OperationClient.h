@@ -0,0 +1,268 @@
+/**
+ * @brief Completes the Activate operations of the consumer on their final invocation state. sdcX reports an operation
+ * in two places: the ActivateResponse (usually Wait or Start, with the transaction id the provider assigned) and the
+ * OperationInvokedReports that follow (Start, ..., Fin or Fail). The client correlates both by transaction id and
+ * calls the completion of an operation once, on the shared executor, when its state is final or it timed out.
+ * Reports arriving before their response are kept until the response tells which operation they belong to.
+ *
+ * Where the compiler supports coroutines (ORTABLE_COROUTINES), activate() can be awaited inside an OperationFlow, so
+ * multi-step moves read as straight code:
+ *
+ *     OperationFlow moveUp(OperationClient& p_client)
+ *     {
+ *         auto result = co_await p_client.activate("MDC_OR_TABLE_ACTIVATE_INCREASE_TABLE_HEIGHT_SCO");
+ *         if(result.success()) { ... }
+ *     }
+ *     moveUp(client).start(executor);
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "OperationExecutor.h"
+#include "StringView.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+
+#ifdef ORTABLE_COROUTINES
+    #include <coroutine>
+    #include <exception>
+#endif
+
+// Mirrors msg:InvocationState
+enum class InvocationState
+{
+    Wait,
+    Start,
+    Cnclld,
+    CnclldMan,
+    Fin,
+    FinMod,
+    Fail
+};
+
+struct OperationResult
+{
+    InvocationState state{InvocationState::Fail};
+    // Assigned by the provider, 0 if the request did not get that far
+    std::uint64_t transactionId{0};
+    // Set if the client failed the operation itself: not sent, no response or timed out
+    std::string error;
+
+    bool success() const;
+};
+
+struct OperationClientConfig
+{
+    // From sending the request to the final invocation state
+    std::chrono::milliseconds timeout{10000};
+    // Reports without a known transaction older than this are dropped
+    std::chrono::milliseconds orphanLifetime{2000};
+};
+
+struct OperationClientStatistics
+{
+    std::uint64_t started{0};
+    std::uint64_t succeeded{0};
+    std::uint64_t failed{0};
+    std::uint64_t timedOut{0};
+    // Responses and reports no operation claimed within the orphan lifetime
+    std::uint64_t droppedOrphans{0};
+};
+
+class OperationClient
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using Completion = std::function<void(OperationResult p_result)>;
+    // Sends an Activate request for the operation, returns the request id its response will carry or 0 on failure
+    using SendFunction = std::function<std::uint64_t(const std::string& p_operationHandle)>;
+
+private:
+    struct Operation
+    {
+        Completion completion;
+        Clock::time_point deadline;
+        std::uint64_t requestId{0};
+        std::uint64_t transactionId{0};
+    };
+
+    // A response or report that arrived before the operation it belongs to was known
+    struct Orphan
+    {
+        std::uint64_t transactionId;
+        InvocationState state;
+        Clock::time_point received;
+    };
+
+    const OperationClientConfig m_config;
+    OperationExecutor& m_executor;
+    SendFunction m_send;
+
+    std::mutex m_mutex;
+    std::uint64_t m_nextId{1};
+    std::unordered_map<std::uint64_t, Operation> m_operations;
+    std::unordered_map<std::uint64_t, std::uint64_t> m_byRequest;
+    std::unordered_map<std::uint64_t, std::uint64_t> m_byTransaction;
+    // Operation ids by deadline
+    std::set<std::pair<Clock::time_point, std::uint64_t>> m_deadlines;
+    // Responses that overtook the return of the send function, by request id
+    std::unordered_map<std::uint64_t, Orphan> m_earlyResponses;
+    // Final states of reports that overtook their response, by transaction id
+    std::unordered_map<std::uint64_t, Orphan> m_orphans;
+    OperationClientStatistics m_statistics;
+
+    std::atomic<bool> m_running{false};
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+
+    // The private methods need the lock
+    // Removes the operation and posts its completion
+    void complete(std::uint64_t p_id, OperationResult p_result);
+    void bind(std::uint64_t p_id, std::uint64_t p_transactionId, InvocationState p_state);
+    void onState(std::uint64_t p_id, InvocationState p_state);
+
+public:
+    OperationClient(OperationClientConfig p_config, OperationExecutor& p_executor, SendFunction p_send);
+    ~OperationClient();
+
+    // Sends the request, the completion runs on the executor exactly once. The handle is taken by value, the caller
+    // may be gone before the request is sent
+    void activate(std::string p_operationHandle, Completion p_completion);
+
+    // From the ActivateResponse callback
+    void onResponse(std::uint64_t p_requestId, std::uint64_t p_transactionId, InvocationState p_state);
+    // From the OperationInvokedReport callback
+    void onReport(std::uint64_t p_transactionId, InvocationState p_state);
+
+    // Fails the operations past their deadline, returns the next deadline or Clock::time_point::max()
+    Clock::time_point expire(Clock::time_point p_now);
+
+    std::size_t pendingCount();
+    OperationClientStatistics getStatistics();
+
+    void run();
+    // Fails the operations still pending, so no completion and no awaiting flow is left behind
+    void stop();
+
+    static bool isFinal(InvocationState p_state);
+    static const char* toString(InvocationState p_state);
+    // Accepts the names with or without a qualifying prefix, e.g. "Fin" or "InvocationState::Fin"
+    static bool fromString(ORTable::StringView p_name, InvocationState& p_state);
+
+#ifdef ORTABLE_COROUTINES
+    class ActivateAwaiter
+    {
+    private:
+        OperationClient& m_client;
+        std::string m_operationHandle;
+        OperationResult m_result;
+
+    public:
+        ActivateAwaiter(OperationClient& p_client, std::string p_operationHandle)
+            : m_client(p_client)
+            , m_operationHandle(std::move(p_operationHandle))
+        {
+        }
+
+        bool await_ready() const noexcept
+        {
+            return false;
+        }
+        void await_suspend(std::coroutine_handle<> p_flow)
+        {
+            // The flow may be resumed on the executor before activate() returns, so nothing here touches the
+            // awaiter afterwards, activate() keeps its own copy of the handle
+            m_client.activate(m_operationHandle, [this, p_flow](OperationResult p_result) {
+                m_result = std::move(p_result);
+                p_flow.resume();
+            });
+        }
+        OperationResult await_resume()
+        {
+            return std::move(m_result);
+        }
+    };
+
+    // co_await resumes the flow on the executor with the final result
+    ActivateAwaiter activate(std::string p_operationHandle)
+    {
+        return ActivateAwaiter(*this, std::move(p_operationHandle));
+    }
+#endif
+};
+
+#ifdef ORTABLE_COROUTINES
+/**
+ * @brief Coroutine of one operation flow. Starts suspended, start() runs it on the executor, afterwards it owns itself
+ * and frees its frame when it finishes. Exceptions leaving the flow terminate, as they would on a thread.
+ */
+class OperationFlow
+{
+public:
+    struct promise_type
+    {
+        OperationFlow get_return_object()
+        {
+            return OperationFlow(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+        std::suspend_never final_suspend() noexcept
+        {
+            return {};
+        }
+        void return_void()
+        {
+        }
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+    };
+
+private:
+    std::coroutine_handle<promise_type> m_flow;
+
+    explicit OperationFlow(std::coroutine_handle<promise_type> p_flow)
+        : m_flow(p_flow)
+    {
+    }
+
+public:
+    OperationFlow(const OperationFlow&) = delete;
+    OperationFlow& operator=(const OperationFlow&) = delete;
+    OperationFlow(OperationFlow&& p_other) noexcept
+        : m_flow(std::exchange(p_other.m_flow, nullptr))
+    {
+    }
+    OperationFlow& operator=(OperationFlow&&) = delete;
+    ~OperationFlow()
+    {
+        // Never started
+        if(m_flow)
+        {
+            m_flow.destroy();
+        }
+    }
+
+    void start(OperationExecutor& p_executor) &&
+    {
+        p_executor.post([flow = std::exchange(m_flow, nullptr)]() { flow.resume(); });
+    }
+};
+#endif
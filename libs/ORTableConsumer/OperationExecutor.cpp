@@ -0,0 +1,78 @@
+#include "OperationExecutor.h"
+
+#include <algorithm>
+
+OperationExecutor::OperationExecutor(std::size_t p_threadCount)
+    : m_threadCount(p_threadCount != 0 ? p_threadCount : std::max(1u, std::thread::hardware_concurrency()))
+{
+}
+
+OperationExecutor::~OperationExecutor()
+{
+    stop();
+}
+
+void OperationExecutor::post(Task p_task)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_running && !m_threads.empty())
+        {
+            return;
+        }
+        m_tasks.push_back(std::move(p_task));
+    }
+    m_wakeUp.notify_one();
+}
+
+std::size_t OperationExecutor::getThreadCount() const
+{
+    return m_threadCount;
+}
+
+std::uint64_t OperationExecutor::getExecutedCount()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_executed;
+}
+
+void OperationExecutor::run()
+{
+    m_running = true;
+    for(std::size_t i = 0; i < m_threadCount; ++i)
+    {
+        m_threads.emplace_back([this]() {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            while(true)
+            {
+                m_wakeUp.wait(lock, [this]() { return !m_running || !m_tasks.empty(); });
+                if(m_tasks.empty())
+                {
+                    return;
+                }
+                auto task = std::move(m_tasks.front());
+                m_tasks.pop_front();
+                lock.unlock();
+                task();
+                lock.lock();
+                ++m_executed;
+            }
+        });
+    }
+}
+
+void OperationExecutor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_all();
+    for(auto& thread : m_threads)
+    {
+        if(thread.joinable())
+        {
+            thread.join();
+        }
+    }
+}
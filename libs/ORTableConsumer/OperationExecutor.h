@@ -0,0 +1,52 @@
+/**
+ * @brief Small fixed pool of threads shared by all operation flows of the consumer. Completions of operations and
+ * resumed coroutines run here as short tasks, so thousands of concurrent flows need no thread each and no flow blocks
+ * a thread of the sdcX reporting while it waits for its provider.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class OperationExecutor
+{
+public:
+    using Task = std::function<void()>;
+
+private:
+    const std::size_t m_threadCount;
+
+    std::mutex m_mutex;
+    std::deque<Task> m_tasks;
+    std::uint64_t m_executed{0};
+
+    std::atomic<bool> m_running{false};
+    std::condition_variable m_wakeUp;
+    std::vector<std::thread> m_threads;
+
+public:
+    // 0 uses one thread per core
+    explicit OperationExecutor(std::size_t p_threadCount = 0);
+    ~OperationExecutor();
+
+    // Tasks posted before run() wait for it, tasks posted after stop() are dropped
+    void post(Task p_task);
+
+    std::size_t getThreadCount() const;
+    std::uint64_t getExecutedCount();
+
+    void run();
+    // Runs the tasks still queued, then joins the threads
+    void stop();
+};
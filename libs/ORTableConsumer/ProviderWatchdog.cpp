@@ -0,0 +1,141 @@
+#include "ProviderWatchdog.h"
+
+ProviderWatchdog::ProviderWatchdog(WatchdogConfig p_config, LossFunction p_onLoss, ProbeFunction p_probe)
+    : m_config(std::move(p_config))
+    , m_onLoss(std::move(p_onLoss))
+    , m_probe(std::move(p_probe))
+{
+}
+
+ProviderWatchdog::~ProviderWatchdog()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+void ProviderWatchdog::watch(const std::string& p_epr)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_epr = p_epr;
+    m_armed = true;
+    m_lastHeartbeat = Clock::now();
+    m_lastProbe = m_lastHeartbeat;
+}
+
+std::string ProviderWatchdog::getWatchedEpr()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_epr;
+}
+
+void ProviderWatchdog::reportLoss(const std::string& p_epr, ProviderLossReason p_reason)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        // Reported once, e.g. a Bye is usually followed by connection errors
+        if(!m_armed || p_epr != m_epr)
+        {
+            return;
+        }
+        m_armed = false;
+    }
+    m_onLoss(p_epr, p_reason);
+}
+
+void ProviderWatchdog::onHeartbeat()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_lastHeartbeat = Clock::now();
+}
+
+void ProviderWatchdog::onBye(const std::string& p_epr)
+{
+    reportLoss(p_epr, ProviderLossReason::Bye);
+}
+
+void ProviderWatchdog::onConnectionError(const std::string& p_epr)
+{
+    reportLoss(p_epr, ProviderLossReason::ConnectionError);
+}
+
+void ProviderWatchdog::check(Clock::time_point p_now)
+{
+    std::string epr;
+    bool probe{false};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_armed || p_now - m_lastHeartbeat < m_config.probeInterval)
+        {
+            return;
+        }
+        epr = m_epr;
+        probe = m_probe && p_now - m_lastProbe >= m_config.probeInterval;
+        if(probe)
+        {
+            m_lastProbe = p_now;
+        }
+    }
+
+    // Not under the lock, the request may take until its own timeout
+    if(probe && m_probe(epr))
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(epr == m_epr)
+        {
+            m_lastHeartbeat = Clock::now();
+        }
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(Clock::now() - m_lastHeartbeat < m_config.heartbeatTimeout)
+        {
+            return;
+        }
+    }
+    reportLoss(epr, ProviderLossReason::HeartbeatTimeout);
+}
+
+const char* ProviderWatchdog::toString(ProviderLossReason p_reason)
+{
+    switch(p_reason)
+    {
+        case ProviderLossReason::Bye:
+            return "Bye";
+        case ProviderLossReason::ConnectionError:
+            return "connection error";
+        case ProviderLossReason::HeartbeatTimeout:
+            return "heartbeat timeout";
+    }
+    return "unknown";
+}
+
+void ProviderWatchdog::run()
+{
+    m_running = true;
+    m_thread = std::thread([this]() {
+        while(m_running)
+        {
+            check(Clock::now());
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wakeUp.wait_for(lock, m_config.checkInterval, [this]() { return !m_running; });
+        }
+    });
+}
+
+void ProviderWatchdog::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_all();
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
@@ -0,0 +1,87 @@
+/**
+ * @brief Detects the loss of the active provider within a fraction of the subscription duration. A provider counts as
+ * lost when it says Bye, when its connection fails, or when there was no sign of life within the heartbeat timeout.
+ * Reports are a sign of life, but their absence is not a sign of loss: an idle table publishes nothing and a
+ * subscription filter may drop the rest. Once no report arrived for the probe interval, the provider is probed with
+ * a request, and only a provider that neither reports nor answers is lost.
+ *
+ * The loss is reported once per watched provider; watch() arms the watchdog again, e.g. for the standby provider
+ * after a failover.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+enum class ProviderLossReason
+{
+    Bye,
+    ConnectionError,
+    HeartbeatTimeout
+};
+
+struct WatchdogConfig
+{
+    std::chrono::milliseconds heartbeatTimeout{2000};
+    // Time without a sign of life after which the provider is probed, repeated at this interval
+    std::chrono::milliseconds probeInterval{500};
+    // Resolution of the heartbeat check
+    std::chrono::milliseconds checkInterval{100};
+};
+
+class ProviderWatchdog
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    // Called on the thread that detected the loss, without the watchdog locked
+    using LossFunction = std::function<void(const std::string& p_epr, ProviderLossReason p_reason)>;
+    // Sends a request to the provider, true if it answered. Called on the watchdog thread, may block
+    using ProbeFunction = std::function<bool(const std::string& p_epr)>;
+
+private:
+    const WatchdogConfig m_config;
+    LossFunction m_onLoss;
+    ProbeFunction m_probe;
+
+    std::mutex m_mutex;
+    std::string m_epr;
+    bool m_armed{false};
+    Clock::time_point m_lastHeartbeat;
+    Clock::time_point m_lastProbe;
+
+    std::atomic<bool> m_running{false};
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+
+    void reportLoss(const std::string& p_epr, ProviderLossReason p_reason);
+
+public:
+    ProviderWatchdog(WatchdogConfig p_config, LossFunction p_onLoss, ProbeFunction p_probe);
+    ~ProviderWatchdog();
+
+    // Starts watching the given provider, the heartbeat timeout starts now
+    void watch(const std::string& p_epr);
+    std::string getWatchedEpr();
+
+    // Any report or response of the watched provider
+    void onHeartbeat();
+    void onBye(const std::string& p_epr);
+    void onConnectionError(const std::string& p_epr);
+
+    // Probes an idle provider and checks the heartbeat timeout, done periodically by run()
+    void check(Clock::time_point p_now);
+
+    static const char* toString(ProviderLossReason p_reason);
+
+    void run();
+    void stop();
+};
@@ -0,0 +1,244 @@
+#include "RenewalScheduler.h"
+
+#include <algorithm>
+
+RenewalScheduler::RenewalScheduler(RenewalConfig p_config, RenewFunction p_renew, ExpiredFunction p_expired)
+    : m_config(std::move(p_config))
+    , m_renew(std::move(p_renew))
+    , m_expired(std::move(p_expired))
+    , m_random(std::random_device()())
+{
+}
+
+RenewalScheduler::~RenewalScheduler()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+void RenewalScheduler::schedule(const std::string& p_subscription, Subscription& p_entry)
+{
+    const auto duration = std::chrono::duration_cast<Clock::duration>(p_entry.duration);
+    const auto early = std::chrono::duration_cast<Clock::duration>(duration * m_config.renewAt);
+    // The jitter never moves a renewal before the middle of the renewal window
+    const auto maximumJitter = std::min<Clock::duration>(m_config.jitter, early / 2);
+    std::uniform_int_distribution<Clock::rep> jitter(0, std::max<Clock::rep>(maximumJitter.count(), 0));
+
+    p_entry.due = p_entry.expires - duration + early - Clock::duration(jitter(m_random));
+    m_queue.emplace(p_entry.due, p_subscription);
+}
+
+void RenewalScheduler::unschedule(const std::string& p_subscription, const Subscription& p_entry)
+{
+    auto range = m_queue.equal_range(p_entry.due);
+    for(auto it = range.first; it != range.second; ++it)
+    {
+        if(it->second == p_subscription)
+        {
+            m_queue.erase(it);
+            return;
+        }
+    }
+}
+
+void RenewalScheduler::add(const std::string& p_provider, const std::string& p_subscription, std::chrono::seconds p_duration)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto existing = m_subscriptions.find(p_subscription);
+        if(existing != m_subscriptions.end())
+        {
+            unschedule(p_subscription, existing->second);
+            m_subscriptions.erase(existing);
+        }
+        auto& entry = m_subscriptions[p_subscription];
+        entry = Subscription{p_provider, p_duration, Clock::now() + p_duration, {}};
+        schedule(p_subscription, entry);
+    }
+    m_wakeUp.notify_all();
+}
+
+void RenewalScheduler::remove(const std::string& p_subscription)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_subscriptions.find(p_subscription);
+    if(it != m_subscriptions.end())
+    {
+        unschedule(p_subscription, it->second);
+        m_subscriptions.erase(it);
+    }
+}
+
+bool RenewalScheduler::contains(const std::string& p_subscription)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_subscriptions.count(p_subscription) > 0;
+}
+
+void RenewalScheduler::removeProvider(const std::string& p_provider)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(auto it = m_subscriptions.begin(); it != m_subscriptions.end();)
+    {
+        if(it->second.provider == p_provider)
+        {
+            unschedule(it->first, it->second);
+            it = m_subscriptions.erase(it);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+void RenewalScheduler::record(std::chrono::microseconds p_latency, std::size_t p_count)
+{
+    if(m_statistics.batches == 0 || p_latency < m_statistics.minimumLatency)
+    {
+        m_statistics.minimumLatency = p_latency;
+    }
+    m_statistics.maximumLatency = std::max(m_statistics.maximumLatency, p_latency);
+    m_statistics.totalLatency += p_latency;
+    m_statistics.renewals += p_count;
+    ++m_statistics.batches;
+}
+
+RenewalScheduler::Clock::time_point RenewalScheduler::renewDue(Clock::time_point p_now)
+{
+    std::string provider;
+    std::vector<std::string> batch;
+    std::chrono::seconds duration{0};
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(m_queue.empty())
+        {
+            return Clock::time_point::max();
+        }
+        if(m_queue.begin()->first > p_now)
+        {
+            return m_queue.begin()->first;
+        }
+
+        // The earliest due subscription takes along the ones of the same provider due soon after, renewing them early
+        provider = m_subscriptions[m_queue.begin()->second].provider;
+        const auto windowEnd = p_now + m_config.batchWindow;
+        for(auto it = m_queue.begin(); it != m_queue.end() && it->first <= windowEnd;)
+        {
+            const auto& entry = m_subscriptions[it->second];
+            if(entry.provider != provider)
+            {
+                ++it;
+                continue;
+            }
+            duration = std::max(duration, entry.duration);
+            batch.push_back(it->second);
+            it = m_queue.erase(it);
+        }
+    }
+
+    // Renewed without the lock, so subscriptions can be added meanwhile
+    const auto start = Clock::now();
+    const bool renewed = m_renew(provider, batch, duration);
+    const auto end = Clock::now();
+
+    std::vector<std::string> expired;
+    Clock::time_point next;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(renewed)
+        {
+            record(std::chrono::duration_cast<std::chrono::microseconds>(end - start), batch.size());
+        }
+        else
+        {
+            ++m_statistics.failures;
+        }
+        for(const auto& subscription : batch)
+        {
+            const auto it = m_subscriptions.find(subscription);
+            if(it == m_subscriptions.end())
+            {
+                // Removed during the renewal
+                continue;
+            }
+            auto& entry = it->second;
+            if(renewed)
+            {
+                if(end > entry.expires)
+                {
+                    ++m_statistics.expired;
+                }
+                entry.expires = end + entry.duration;
+                schedule(subscription, entry);
+            }
+            else if(end > entry.expires)
+            {
+                // The provider dropped the subscription, renewing it again cannot succeed
+                ++m_statistics.expired;
+                expired.push_back(subscription);
+                m_subscriptions.erase(it);
+            }
+            else
+            {
+                entry.due = end + m_config.retryDelay;
+                m_queue.emplace(entry.due, subscription);
+            }
+        }
+        next = m_queue.empty() ? Clock::time_point::max() : m_queue.begin()->first;
+    }
+
+    // Without the lock, the callback adds the new subscriptions
+    if(!expired.empty() && m_expired)
+    {
+        m_expired(provider, expired);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        next = m_queue.empty() ? Clock::time_point::max() : m_queue.begin()->first;
+    }
+    return next;
+}
+
+RenewalStatistics RenewalScheduler::getStatistics()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_statistics;
+}
+
+void RenewalScheduler::run()
+{
+    m_running = true;
+    m_thread = std::thread([this]() {
+        while(m_running)
+        {
+            const auto next = renewDue(Clock::now());
+
+            std::unique_lock<std::mutex> lock(m_mutex);
+            const auto queueChanged = [this, next]() {
+                return !m_running || (!m_queue.empty() && m_queue.begin()->first < next);
+            };
+            if(next == Clock::time_point::max())
+            {
+                m_wakeUp.wait(lock, queueChanged);
+            }
+            else
+            {
+                m_wakeUp.wait_until(lock, next, queueChanged);
+            }
+        }
+    });
+}
+
+void RenewalScheduler::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_all();
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
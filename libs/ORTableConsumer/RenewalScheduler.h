@@ -0,0 +1,113 @@
+/**
+ * @brief Renews the subscriptions of the consumer. Left alone, every subscription renews itself shortly before it
+ * expires, and subscriptions created together renew together, which shows as periodic bursts of Renew requests.
+ * The scheduler instead renews early (at a fraction of the duration), spreads the renewals with random jitter and
+ * sends the renewals of one provider that fall due within a short window as one batch. A failed batch is retried
+ * with the remaining time in mind, so a temporary error does not let the subscriptions expire. Subscriptions that
+ * expire anyway are not retried, the provider dropped them: the scheduler forgets them and hands them to the expired
+ * callback, which subscribes again and add()s the new subscriptions.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+struct RenewalConfig
+{
+    // Renewal is due after this fraction of the subscription duration
+    double renewAt{0.6};
+    // Renewals are moved earlier by a random time up to this
+    std::chrono::milliseconds jitter{5000};
+    // Renewals of one provider due within this window after the first one go into the same batch
+    std::chrono::milliseconds batchWindow{2000};
+    // Delay before retrying a failed batch
+    std::chrono::milliseconds retryDelay{1000};
+};
+
+struct RenewalStatistics
+{
+    std::uint64_t renewals{0};
+    std::uint64_t batches{0};
+    std::uint64_t failures{0};
+    // Subscriptions that expired before their renewal succeeded
+    std::uint64_t expired{0};
+    std::chrono::microseconds minimumLatency{0};
+    std::chrono::microseconds maximumLatency{0};
+    std::chrono::microseconds totalLatency{0};
+};
+
+class RenewalScheduler
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    // Renews the given subscriptions of one provider in one go, returns false on failure
+    using RenewFunction = std::function<bool(const std::string& p_provider,
+                                             const std::vector<std::string>& p_subscriptions,
+                                             std::chrono::seconds p_duration)>;
+    // Called with the subscriptions of one provider that expired while their renewal failed
+    using ExpiredFunction = std::function<void(const std::string& p_provider, const std::vector<std::string>& p_subscriptions)>;
+
+private:
+    struct Subscription
+    {
+        std::string provider;
+        std::chrono::seconds duration;
+        Clock::time_point expires;
+        Clock::time_point due;
+    };
+
+    const RenewalConfig m_config;
+    RenewFunction m_renew;
+    ExpiredFunction m_expired;
+
+    std::mutex m_mutex;
+    std::unordered_map<std::string, Subscription> m_subscriptions;
+    // Subscription ids by due time
+    std::multimap<Clock::time_point, std::string> m_queue;
+    std::mt19937 m_random;
+    RenewalStatistics m_statistics;
+
+    std::atomic<bool> m_running{false};
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+
+    void schedule(const std::string& p_subscription, Subscription& p_entry);
+    void unschedule(const std::string& p_subscription, const Subscription& p_entry);
+    void record(std::chrono::microseconds p_latency, std::size_t p_count);
+
+public:
+    RenewalScheduler(RenewalConfig p_config, RenewFunction p_renew, ExpiredFunction p_expired = nullptr);
+    ~RenewalScheduler();
+
+    // Adds a subscription that expires after the given duration from now
+    void add(const std::string& p_provider, const std::string& p_subscription, std::chrono::seconds p_duration);
+    void remove(const std::string& p_subscription);
+    bool contains(const std::string& p_subscription);
+    // E.g. after the provider was lost
+    void removeProvider(const std::string& p_provider);
+
+    /**
+     * @brief Renews the batch of the earliest due subscription if it is due at the given time.
+     * @return the time the next renewal is due, Clock::time_point::max() if there is none
+     */
+    Clock::time_point renewDue(Clock::time_point p_now);
+
+    RenewalStatistics getStatistics();
+
+    void run();
+    void stop();
+};
@@ -0,0 +1,155 @@
+#include "TableStateModel.h"
+
+#include <utility>
+
+TableStateModel::TableStateModel()
+    : m_current(std::make_shared<const TableState>())
+{
+}
+
+TableStateModel::Snapshot TableStateModel::snapshot() const
+{
+#ifdef ORTABLE_ATOMIC_SHARED_PTR
+    return m_current.load();
+#else
+    return std::atomic_load(&m_current);
+#endif
+}
+
+void TableStateModel::publish(Snapshot p_next)
+{
+#ifdef ORTABLE_ATOMIC_SHARED_PTR
+    m_current.store(std::move(p_next));
+#else
+    std::atomic_store(&m_current, std::move(p_next));
+#endif
+}
+
+std::uint64_t TableStateModel::version() const
+{
+    return m_version;
+}
+
+TableStateModel::Snapshot TableStateModel::waitForVersion(std::uint64_t p_version, std::chrono::milliseconds p_timeout) const
+{
+    if(m_version > p_version)
+    {
+        return snapshot();
+    }
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_changed.wait_for(lock, p_timeout, [this, p_version]() { return m_version > p_version || m_closed; });
+    return snapshot();
+}
+
+bool TableStateModel::update(std::unique_lock<std::mutex>& p_lock, const Modification& p_modification)
+{
+    auto next = std::make_shared<TableState>(*snapshot());
+    if(!p_modification(*next))
+    {
+        return false;
+    }
+    next->version = m_version + 1;
+    publish(std::move(next));
+    ++m_version;
+    p_lock.unlock();
+    m_changed.notify_all();
+    return true;
+}
+
+bool TableStateModel::setMetric(const std::string& p_handle, double p_value)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_known.updateByHandle<ORTable::NumericMetric>(p_handle, p_value) == ORTable::StateUpdate::Unchanged)
+    {
+        return false;
+    }
+    return update(lock, [&p_handle, p_value](TableState& p_state) {
+        const auto it = p_state.metrics.find(p_handle);
+        if(it != p_state.metrics.end() && it->second == p_value)
+        {
+            return false;
+        }
+        p_state.metrics[p_handle] = p_value;
+        return true;
+    });
+}
+
+bool TableStateModel::setAlertCondition(const std::string& p_handle, bool p_present)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_known.updateByHandle<ORTable::AlertCondition>(p_handle, p_present) == ORTable::StateUpdate::Unchanged)
+    {
+        return false;
+    }
+    return update(lock, [&p_handle, p_present](TableState& p_state) {
+        const auto it = p_state.alertConditions.find(p_handle);
+        if(it != p_state.alertConditions.end() && it->second == p_present)
+        {
+            return false;
+        }
+        p_state.alertConditions[p_handle] = p_present;
+        return true;
+    });
+}
+
+bool TableStateModel::setAlertSignal(const std::string& p_handle, const std::string& p_presence)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if(m_known.updateByHandle<ORTable::AlertSignal>(p_handle, p_presence) == ORTable::StateUpdate::Unchanged)
+    {
+        return false;
+    }
+    return update(lock, [&p_handle, &p_presence](TableState& p_state) {
+        const auto it = p_state.alertSignals.find(p_handle);
+        if(it != p_state.alertSignals.end() && it->second == p_presence)
+        {
+            return false;
+        }
+        p_state.alertSignals[p_handle] = p_presence;
+        return true;
+    });
+}
+
+bool TableStateModel::applyAlertReport(const AlertReportStates& p_report)
+{
+    std::unique_lock<std::mutex> lock(m_mutex);
+    bool changed{false};
+    for(const auto& condition : p_report.conditions)
+    {
+        changed = m_known.updateByHandle<ORTable::AlertCondition>(condition.handle, condition.present) != ORTable::StateUpdate::Unchanged
+                  || changed;
+    }
+    for(const auto& signal : p_report.signals)
+    {
+        changed = m_known.updateByHandle<ORTable::AlertSignal>(signal.handle, signal.presence) != ORTable::StateUpdate::Unchanged || changed;
+    }
+    if(!changed)
+    {
+        return false;
+    }
+    return update(lock, [&p_report](TableState& p_state) {
+        bool changed{false};
+        for(const auto& condition : p_report.conditions)
+        {
+            auto& current = p_state.alertConditions[condition.handle];
+            changed = changed || current != condition.present;
+            current = condition.present;
+        }
+        for(const auto& signal : p_report.signals)
+        {
+            auto& current = p_state.alertSignals[signal.handle];
+            changed = changed || current != signal.presence;
+            current = signal.presence;
+        }
+        return changed;
+    });
+}
+
+void TableStateModel::close()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_closed = true;
+    }
+    m_changed.notify_all();
+}
@@ -0,0 +1,121 @@
+/**
+ * @brief Current state of the table as seen by the consumer, for UIs. Report callbacks update the model, readers get
+ * an immutable snapshot. Every update copies the state, applies the change and publishes the copy with the next
+ * version (copy-on-write), so readers never lock and never see a half applied report.
+ *
+ * Instead of polling, a UI can block in waitForVersion() until the state changed after the version it shows.
+ *
+ * Most reports repeat values the model has already. The last value of every state the MDIB declares is kept in a
+ * TypedStateTable as well, so such reports are dropped by a slot lookup before the state is copied. States of
+ * handles the MDIB does not declare always take the copy.
+ *
+ * The current snapshot is a std::atomic<std::shared_ptr> from C++20 on, where the standard library has it, before
+ * that a shared_ptr accessed with atomic_load/atomic_store.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibHandles.h"
+#include "StringView.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if defined(ORTABLE_CXX20) && defined(__cpp_lib_atomic_shared_ptr)
+    #define ORTABLE_ATOMIC_SHARED_PTR
+#endif
+
+struct TableState
+{
+    // Increases with every change, 0 before the first one
+    std::uint64_t version{0};
+    // Metric values by descriptor handle, e.g. MDC_OR_TABLE_HEIGHT
+    std::map<std::string, double> metrics;
+    // Presence of the alert conditions by descriptor handle
+    std::map<std::string, bool> alertConditions;
+    // Presence of the alert signals by descriptor handle, "On", "Off", "Latching" or "Acknowledged"
+    std::map<std::string, std::string> alertSignals;
+};
+
+// Alert states of one EpisodicAlertReport, in the order of the report
+struct AlertReportStates
+{
+    struct Condition
+    {
+        std::string handle;
+        bool present{false};
+    };
+    struct Signal
+    {
+        std::string handle;
+        // "On", "Off", "Latching" or "Acknowledged"
+        std::string presence;
+    };
+
+    std::vector<Condition> conditions;
+    std::vector<Signal> signals;
+};
+
+class TableStateModel
+{
+public:
+    using Snapshot = std::shared_ptr<const TableState>;
+    // Changes the copy of the state, returns false if nothing changed
+    using Modification = std::function<bool(TableState& p_state)>;
+
+private:
+#ifdef ORTABLE_ATOMIC_SHARED_PTR
+    std::atomic<Snapshot> m_current;
+#else
+    // Read with atomic_load, replaced with atomic_store
+    Snapshot m_current;
+#endif
+    std::atomic<std::uint64_t> m_version{0};
+
+    // Serializes writers and guards the wait
+    mutable std::mutex m_mutex;
+    mutable std::condition_variable m_changed;
+    bool m_closed{false};
+
+    // Last values of the states of the MDIB, guarded by m_mutex. Only written together with the snapshot
+    ORTable::TypedStateTable<ORTable::NumericMetric, ORTable::AlertCondition, ORTable::AlertSignal> m_known;
+
+    // Replaces the current snapshot, the caller holds m_mutex
+    void publish(Snapshot p_next);
+    // Applies all changes of the modification as one version. Releases the lock before waking the readers
+    bool update(std::unique_lock<std::mutex>& p_lock, const Modification& p_modification);
+
+public:
+    TableStateModel();
+
+    // Lock-free read of the latest state
+    Snapshot snapshot() const;
+    std::uint64_t version() const;
+
+    /**
+     * @brief Blocks until the version is greater than p_version, the timeout expired or close() was called.
+     * @return the latest snapshot, its version is not greater than p_version in case of timeout or close
+     */
+    Snapshot waitForVersion(std::uint64_t p_version, std::chrono::milliseconds p_timeout) const;
+
+    bool setMetric(const std::string& p_handle, double p_value);
+    bool setAlertCondition(const std::string& p_handle, bool p_present);
+    bool setAlertSignal(const std::string& p_handle, const std::string& p_presence);
+
+    // All states of the report become one version, none if the report changed nothing
+    bool applyAlertReport(const AlertReportStates& p_report);
+
+    // Wakes all waiting readers, e.g. on shutdown
+    void close();
+};
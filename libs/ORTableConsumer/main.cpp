@@ -35,17 +35,91 @@
 
 #include "MessageModel/MSG/OperationInvokedReport.h"
 
+#include "DescriptionCache.h"
+#include "MdibHandles.h"
+#include "OperationClient.h"
+#include "OperationExecutor.h"
+#include "ProviderWatchdog.h"
+#include "RenewalScheduler.h"
+#include "SubscriptionFilter.h"
+#include "TableStateModel.h"
+#include "Tracing.h"
+
+#include <cstdint>
+#include <cstdlib>
+#include <future>
+#include <memory>
 #include <vector>
 #include <string>
 #include <stdexcept>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <utility>
 
 using namespace Logging;
 
 // Adapt accordingly
 const std::string TARGET_EPR = "TODO";
+// Descriptor handles the reports are subscribed for, empty subscribes all
+const std::vector<std::string> SUBSCRIBED_HANDLES = {};
+// Redundant provider taking over when the target is lost. Empty disables the failover
+const std::string STANDBY_EPR = "";
+
+// Shared, so a pending probe keeps a consumer alive that a failover swapped out meanwhile
+std::shared_ptr<ConsumerAPI::SDCConsumer> consumer;
+// Connected at startup with its MDIB fetched, so a failover only needs to subscribe
+std::shared_ptr<ConsumerAPI::SDCConsumer> standbyConsumer;
+// Guards the two consumers and the EPR of the active one, which change on failover
+std::mutex consumerMutex;
+std::string activeEpr = TARGET_EPR;
+
+const WatchdogConfig watchdogConfig;
+std::unique_ptr<ProviderWatchdog> providerWatchdog;
+std::unique_ptr<RenewalScheduler> renewalScheduler;
+// Completes the Activate operations on their final invocation state, the flows run on the executor
+std::unique_ptr<OperationExecutor> operationExecutor;
+std::unique_ptr<OperationClient> operationClient;
+// Set handler of the active consumer, guarded by the consumerMutex. Re-created on failover, so the operations and
+// their responses move to the standby provider with the reports
+using SetHandlerPtr = decltype(std::declval<ConsumerAPI::SDCConsumer&>().createSetHandler());
+SetHandlerPtr setHandler;
+
+std::string getActiveEpr()
+{
+    std::lock_guard<std::mutex> lock(consumerMutex);
+    return activeEpr;
+}
+
+// Every report of the active provider is a sign of life for the watchdog
+void onProviderReport()
+{
+    if(providerWatchdog)
+    {
+        providerWatchdog->onHeartbeat();
+    }
+}
+
+// builder for the content coding config of the description cache, only the files on disk are compressed, the
+// MdDescription is still transferred uncompressed
+ORTable::CompressionConfig createCompressionConfig()
+{
+    ORTable::CompressionConfig compressionConfig;
+
+    compressionConfig.enabled = true;
+    compressionConfig.preferred = {ORTable::ContentEncoding::Zstd, ORTable::ContentEncoding::Gzip};
+    compressionConfig.level = 3;
+    compressionConfig.threshold = 8 * 1024;
+
+    return compressionConfig;
+}
+
+// MdDescriptions of the providers seen so far, survives restarts of the consumer
+DescriptionCache descriptionCache("descriptionCache", createCompressionConfig());
+
 
-std::unique_ptr<ConsumerAPI::SDCConsumer> consumer;
+// State of the table for the UI, updated by the report callbacks
+TableStateModel tableState;
 
 
 // builder for TLS config class
@@ -63,16 +137,61 @@ std::shared_ptr<Config::TLSConfig> createTLSConfig()
 // callback function for reports with numeric metric state updates
 void onNumericMetricStateUpdate(ParticipantModel::PM::NumericMetricState state)
 {
+    ORTABLE_TRACE_SCOPE("consumer", "onNumericMetricStateUpdate");
+    onProviderReport();
+
     // in this example the received update is just output
     LogBroker::getInstance().log(LogMessage("ORTableConsumer",
                                             Severity::Informational,
                                             "Received NumericMetricState with descriptor handle: " + state.getDescriptorHandle().getValue()
                                                 + " and value: " + state.getMetricValue()->getValue().getValue()));
+
+    try
+    {
+        tableState.setMetric(state.getDescriptorHandle().getValue(), std::stod(state.getMetricValue()->getValue().getValue()));
+    }
+    catch(const std::exception&)
+    {
+        LogBroker::getInstance().log(LogMessage("ORTableConsumer", Severity::Notice, "Ignoring invalid metric value"));
+    }
+}
+
+std::string alertSignalPresenceName(ParticipantModel::PM::AlertSignalPresence p_presence)
+{
+    switch(p_presence)
+    {
+        case ParticipantModel::PM::AlertSignalPresence::On:
+            return "On";
+        case ParticipantModel::PM::AlertSignalPresence::Latch:
+            return "Latching";
+        case ParticipantModel::PM::AlertSignalPresence::Ack:
+            return "Acknowledged";
+        default:
+            return "Off";
+    }
 }
 
 // callback function for reports with alert updates in general (alert conditions, alert signals, ...)
 void onAlert(MessageModel::MSG::EpisodicAlertReport p_data, UserInterfaces::Reporting::ReportingMetadata p_metadata)
 {
+    ORTABLE_TRACE_SCOPE("consumer", "onAlert");
+    onProviderReport();
+
+    // All states of the report become one version of the table state
+    AlertReportStates states;
+    for(const auto& reportPart : p_data.getReportPartList())
+    {
+        for(const auto& alertState : reportPart.getLimitAlertConditionStateList())
+        {
+            states.conditions.push_back({alertState.getDescriptorHandle().getValue(), alertState.getPresence().getValue()});
+        }
+        for(const auto& alertState : reportPart.getAlertSignalStateList())
+        {
+            states.signals.push_back({alertState.getDescriptorHandle().getValue(), alertSignalPresenceName(alertState.getPresence())});
+        }
+    }
+    tableState.applyAlertReport(states);
+
     // skip empty reports and empty limit alert condition states 
     if(p_data.getReportPartList().empty())
     {
@@ -105,19 +224,7 @@ void onAlert(MessageModel::MSG::EpisodicAlertReport p_data, UserInterfaces::Repo
     for(const auto& alertState : p_data.getReportPartList()[0].getAlertSignalStateList())
     {
         // in this example the received update is just displayed
-        std::string presence = "Off";
-        if(alertState.getPresence() == ParticipantModel::PM::AlertSignalPresence::On)
-        {
-            presence = "On";
-        }
-        else if(alertState.getPresence() == ParticipantModel::PM::AlertSignalPresence::Latch)
-        {
-            presence = "Latching";
-        }
-        else if(alertState.getPresence() == ParticipantModel::PM::AlertSignalPresence::Ack)
-        {
-            presence = "Acknowledged";
-        }
+        const auto presence = alertSignalPresenceName(alertState.getPresence());
         LogBroker::getInstance().log(LogMessage("ORTableConsumer",
                        Severity::Notice,
                        "Received episodic alert report with alert signal with corresponding descriptor handle: "
@@ -127,8 +234,59 @@ void onAlert(MessageModel::MSG::EpisodicAlertReport p_data, UserInterfaces::Repo
 }
 
 
+// A modified description invalidates the cached one, the next connect fetches it again
+void onDescriptionModification(MessageModel::MSG::DescriptionModificationReport p_data,
+                               UserInterfaces::Reporting::ReportingMetadata p_metadata)
+{
+    ORTABLE_TRACE_SCOPE("consumer", "onDescriptionModification");
+    onProviderReport();
+    descriptionCache.invalidate(getActiveEpr());
+    LogBroker::getInstance().log(
+        LogMessage("ORTableConsumer", Severity::Notice, "Received DescriptionModificationReport, cached MdDescription dropped"));
+}
+
+// Returns the MdDescription of the connected provider. The MdState is always requested, as it carries the SequenceId of
+// the provider's MDIB and the DescriptorVersion of every descriptor with a state. As long as the provider neither
+// restarted nor modified its description, the MdDescription is taken from the cache instead of being transferred again.
+std::string loadMdDescription(ConsumerAPI::SDCConsumer& p_consumer, const std::string& p_providerEpr)
+{
+    auto getHandler = p_consumer.createGetHandler();
+    const auto mdStateResponse = getHandler->getMdState();
+    const auto sequenceId = mdStateResponse.getSequenceId().getValue();
+
+    // Without the descriptor versions of the provider a cached description cannot be validated
+    std::uint64_t descriptorVersions{0};
+    const bool validated = DescriptionCache::descriptorVersionsOf(mdStateResponse.getMdState().toXML(), descriptorVersions);
+
+    unsigned long long descriptionVersion{0};
+    std::string description;
+    if(validated && descriptionCache.load(p_providerEpr, sequenceId, descriptorVersions, description, descriptionVersion))
+    {
+        LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                                Severity::Notice,
+                                                "Using cached MdDescription with DescriptionVersion "
+                                                    + std::to_string(descriptionVersion)));
+        return description;
+    }
+
+    const auto mdDescriptionResponse = getHandler->getMdDescription();
+    const auto& mdDescription = mdDescriptionResponse.getMdDescription();
+    descriptionVersion = mdDescription.getDescriptionVersion().getValue();
+    description = mdDescription.toXML();
+    if(!validated)
+    {
+        descriptionCache.invalidate(p_providerEpr);
+    }
+    else if(!descriptionCache.store(p_providerEpr, sequenceId, descriptorVersions, descriptionVersion, description))
+    {
+        LogBroker::getInstance().log(LogMessage("ORTableConsumer", Severity::Notice, "Could not cache MdDescription"));
+    }
+    return description;
+}
+
 void onActivateResponse(UserInterfaces::Set::ConsumerSet::API::ActivateResponseReceived::Data_t p_data)
 {
+    ORTABLE_TRACE_SCOPE("consumer", "onActivateResponse");
     LogBroker::getInstance().log(
         LogMessage("ORTableConsumer",
                    Severity::Notice,
@@ -136,11 +294,22 @@ void onActivateResponse(UserInterfaces::Set::ConsumerSet::API::ActivateResponseR
                        + " from IP: " + p_data.getTransportMetadata()->getRemoteAddress() + " and current InvocationState: "
                        + UserInterfaces::Set::InvocationStateConverter::convertInvocationState(
                            p_data.getData()->getInvocationInfo().getInvocationState())));
+
+    const auto& invocationInfo = p_data.getData()->getInvocationInfo();
+    InvocationState state;
+    if(operationClient
+       && OperationClient::fromString(UserInterfaces::Set::InvocationStateConverter::convertInvocationState(invocationInfo.getInvocationState()),
+                                      state))
+    {
+        operationClient->onResponse(p_data.getTransportMetadata()->getTransactionID(), invocationInfo.getTransactionId(), state);
+    }
 }
 
 // OperationInvokedReport received callback
 void onOperationInvokedReport(UserInterfaces::Reporting::ConsumerReporting::API::OperationInvoked::Data_t p_data)
 {
+    ORTABLE_TRACE_SCOPE("consumer", "onOperationInvokedReport");
+    onProviderReport();
 
     LogBroker::getInstance().log(LogMessage("ORTableConsumer",
                                             Severity::Notice,
@@ -148,6 +317,232 @@ void onOperationInvokedReport(UserInterfaces::Reporting::ConsumerReporting::API:
                                                 + +"with current InvocationState: "
                                                 + UserInterfaces::Set::InvocationStateConverter::convertInvocationState(
                                                     p_data.getInvocationInfo().getInvocationState())));
+
+    InvocationState state;
+    if(operationClient
+       && OperationClient::fromString(
+           UserInterfaces::Set::InvocationStateConverter::convertInvocationState(p_data.getInvocationInfo().getInvocationState()), state))
+    {
+        operationClient->onReport(p_data.getInvocationInfo().getTransactionId(), state);
+    }
+}
+
+// Creates the set handler of the active consumer, the caller holds the consumerMutex
+void createSetHandler()
+{
+    setHandler = consumer->createSetHandler();
+    setHandler->registerActivateResponseCallback(onActivateResponse);
+}
+
+// Send function of the operation client. The request always goes to the active provider, an operation sent to a lost
+// one fails by timeout. The response carries the transaction id of the transport request, which is expected to be the
+// one activate() returns, the reports the one assigned by the provider
+std::uint64_t sendActivate(const std::string& p_operationHandle)
+{
+    std::lock_guard<std::mutex> lock(consumerMutex);
+    if(!setHandler)
+    {
+        return 0;
+    }
+    return static_cast<std::uint64_t>(setHandler->activate(p_operationHandle));
+}
+
+#ifdef ORTABLE_COROUTINES
+// Activates the operations one after another, each one only once the previous one finished
+OperationFlow runOperationSequence(std::vector<std::string> p_operations)
+{
+    for(const auto& operation : p_operations)
+    {
+        const auto result = co_await operationClient->activate(operation);
+        if(!result.success())
+        {
+            LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                                    Severity::Error,
+                                                    "Operation sequence stopped at " + operation + ": "
+                                                        + (result.error.empty() ? OperationClient::toString(result.state) : result.error)));
+            co_return;
+        }
+    }
+    LogBroker::getInstance().log(
+        LogMessage("ORTableConsumer", Severity::Notice, "Operation sequence of " + std::to_string(p_operations.size()) + " steps finished"));
+}
+#endif
+
+// Subscribes the report callbacks at the given provider
+void registerReportCallbacks(ConsumerAPI::SDCConsumer& p_consumer)
+{
+    // Only the reports with a callback, and with SUBSCRIBED_HANDLES only the states of those, are subscribed.
+    // The handles do not restrict the OperationInvoked and DescriptionModification reports
+    const ORTable::SubscriptionFilter filter({ORTable::ReportAction::EpisodicMetric,
+                                              ORTable::ReportAction::EpisodicAlert,
+                                              ORTable::ReportAction::OperationInvoked,
+                                              ORTable::ReportAction::DescriptionModification},
+                                             SUBSCRIBED_HANDLES);
+    const auto subscribe = [&p_consumer](const ORTable::SubscriptionFilter& p_filter) {
+        return p_consumer.createReportingNotifier(p_filter.getDialect(), p_filter.encode());
+    };
+    decltype(subscribe(filter)) notifier;
+    try
+    {
+        notifier = subscribe(filter);
+    }
+    catch(const std::exception& e)
+    {
+        // Without handles the filter is in the standard action dialect already, there is nothing to fall back to
+        if(!filter.hasHandles())
+        {
+            throw;
+        }
+        LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                                Severity::Notice,
+                                                std::string("Handle filter rejected, subscribing all states of the actions: ") + e.what()));
+        notifier = subscribe(filter.actionsOnly());
+    }
+    notifier->registerNumericMetricStateUpdateCallback(onNumericMetricStateUpdate);
+    notifier->registerOnEpisodicAlertReport(onAlert);
+    notifier->registerOperationInvokedCallback(onOperationInvokedReport);
+    notifier->registerOnDescriptionModificationReport(onDescriptionModification);
+}
+
+// Renews the subscriptions of the active provider, batched by the scheduler
+bool renewSubscriptions(const std::string& p_providerEpr, const std::vector<std::string>& p_subscriptions, std::chrono::seconds p_duration)
+{
+    std::lock_guard<std::mutex> lock(consumerMutex);
+    if(p_providerEpr != activeEpr || !consumer)
+    {
+        return false;
+    }
+    return consumer->renewSubscriptions(p_subscriptions, p_duration);
+}
+
+// Hands the renewal of the subscriptions of the given provider over to the scheduler, instead of every subscription
+// renewing on its own right before it expires
+void scheduleRenewals(ConsumerAPI::SDCConsumer& p_consumer, const std::string& p_providerEpr)
+{
+    p_consumer.setAutomaticRenewal(false);
+    for(const auto& subscription : p_consumer.getSubscriptions())
+    {
+        renewalScheduler->add(p_providerEpr, subscription.getIdentifier(), subscription.getDuration());
+    }
+}
+
+// Called by the scheduler for subscriptions that expired while their renewal failed. The provider dropped them, so
+// the report callbacks are subscribed again and the new subscriptions go to the scheduler
+void resubscribe(const std::string& p_providerEpr, const std::vector<std::string>& p_subscriptions)
+{
+    std::lock_guard<std::mutex> lock(consumerMutex);
+    if(p_providerEpr != activeEpr || !consumer)
+    {
+        return;
+    }
+    LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                            Severity::Notice,
+                                            std::to_string(p_subscriptions.size()) + " subscriptions at " + p_providerEpr
+                                                + " expired, subscribing again"));
+    registerReportCallbacks(*consumer);
+    for(const auto& subscription : consumer->getSubscriptions())
+    {
+        if(!renewalScheduler->contains(subscription.getIdentifier()))
+        {
+            renewalScheduler->add(p_providerEpr, subscription.getIdentifier(), subscription.getDuration());
+        }
+    }
+}
+
+void logRenewalStatistics()
+{
+    const auto statistics = renewalScheduler->getStatistics();
+    const auto average = statistics.batches > 0 ? statistics.totalLatency.count() / static_cast<long long>(statistics.batches) : 0;
+    LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                            Severity::Notice,
+                                            "Renewed " + std::to_string(statistics.renewals) + " subscriptions in "
+                                                + std::to_string(statistics.batches) + " batches, " + std::to_string(statistics.failures)
+                                                + " failed, " + std::to_string(statistics.expired) + " expired. Latency min/avg/max: "
+                                                + std::to_string(statistics.minimumLatency.count()) + "/" + std::to_string(average) + "/"
+                                                + std::to_string(statistics.maximumLatency.count()) + " us"));
+}
+
+void logOperationStatistics()
+{
+    const auto statistics = operationClient->getStatistics();
+    LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                            Severity::Notice,
+                                            "Started " + std::to_string(statistics.started) + " operations, "
+                                                + std::to_string(statistics.succeeded) + " succeeded, " + std::to_string(statistics.failed)
+                                                + " failed, " + std::to_string(statistics.timedOut) + " timed out"));
+}
+
+// Liveness probe of the watchdog for an active provider without reports: a GetMdState it has to answer
+bool probeProvider(const std::string& p_epr)
+{
+    std::shared_ptr<ConsumerAPI::SDCConsumer> probed;
+    {
+        std::lock_guard<std::mutex> lock(consumerMutex);
+        if(!consumer || activeEpr != p_epr)
+        {
+            return false;
+        }
+        probed = consumer;
+    }
+
+    // Sent without the lock, a hanging provider must not stall the failover, the operations and the renewals.
+    // The probe starts once the provider was quiet for the probe interval and has to be answered within the
+    // heartbeat timeout. Left behind, the request ends with its own timeout
+    auto answered = std::make_shared<std::promise<bool>>();
+    auto result = answered->get_future();
+    std::thread([probed, answered, p_epr]() {
+        try
+        {
+            probed->createGetHandler()->getMdState();
+            answered->set_value(true);
+        }
+        catch(const std::exception& e)
+        {
+            LogBroker::getInstance().log(LogMessage("ORTableConsumer", Severity::Notice, "Probing " + p_epr + " failed: " + e.what()));
+            answered->set_value(false);
+        }
+    }).detach();
+    if(result.wait_for(watchdogConfig.heartbeatTimeout - watchdogConfig.probeInterval) != std::future_status::ready)
+    {
+        LogBroker::getInstance().log(LogMessage("ORTableConsumer", Severity::Notice, "Probing " + p_epr + " timed out"));
+        return false;
+    }
+    return result.get();
+}
+
+// Called by the watchdog when the active provider is lost. The standby provider is connected and its MDIB was fetched
+// at startup, so instead of a discovery, a connect and a GetMdib only the subscriptions are set up
+void failover(const std::string& p_lostEpr, ProviderLossReason p_reason)
+{
+    const auto start = std::chrono::steady_clock::now();
+    LogBroker::getInstance().log(LogMessage(
+        "ORTableConsumer", Severity::Notice, "Lost provider " + p_lostEpr + " (" + ProviderWatchdog::toString(p_reason) + ")"));
+
+    std::shared_ptr<ConsumerAPI::SDCConsumer> lostConsumer;
+    {
+        std::lock_guard<std::mutex> lock(consumerMutex);
+        if(!standbyConsumer)
+        {
+            LogBroker::getInstance().log(LogMessage("ORTableConsumer", Severity::Notice, "No standby provider available"));
+            return;
+        }
+        lostConsumer = std::move(consumer);
+        consumer = std::move(standbyConsumer);
+        activeEpr = STANDBY_EPR;
+        registerReportCallbacks(*consumer);
+        createSetHandler();
+        renewalScheduler->removeProvider(p_lostEpr);
+        scheduleRenewals(*consumer, STANDBY_EPR);
+    }
+    providerWatchdog->watch(STANDBY_EPR);
+
+    const auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                            Severity::Notice,
+                                            "Failed over to " + STANDBY_EPR + " in " + std::to_string(duration.count()) + " ms"));
+
+    // Shutting down the lost connection may block until its sockets time out, so it does not delay the failover
+    std::thread([lost = std::move(lostConsumer)]() { lost->shutdown(); }).detach();
 }
 
 int main(int argc, char* argv[])
@@ -189,6 +584,12 @@ int main(int argc, char* argv[])
     Logging::LogBroker::getInstance().registerLogger(fileLoggerTag, fileLogger);
     Logging::LogBroker::getInstance().setLogLevel(Logging::Severity::Debug);
 
+    // Chrome trace of the run, if built with ORTABLE_TRACING and ORTABLE_TRACE_FILE is set
+    if(const char* traceFile = std::getenv("ORTABLE_TRACE_FILE"))
+    {
+        ORTABLE_TRACE_START(traceFile);
+    }
+
     // init the core of the framework
     LogBroker::getInstance().log(LogMessage("ORTableConsumer", Severity::Notice, "Creating Core..."));
     auto coreConfig = std::make_unique<Config::CoreConfig>();
@@ -213,14 +614,53 @@ int main(int argc, char* argv[])
 
 
     // Register callback for report notifications
-    auto notifier = consumer->createReportingNotifier();
-    notifier->registerNumericMetricStateUpdateCallback(onNumericMetricStateUpdate);
-    notifier->registerOnEpisodicAlertReport(onAlert);
-    notifier->registerOperationInvokedCallback(onOperationInvokedReport);
+    registerReportCallbacks(*consumer);
+
+    renewalScheduler = std::make_unique<RenewalScheduler>(RenewalConfig(), renewSubscriptions, resubscribe);
+    scheduleRenewals(*consumer, TARGET_EPR);
+    renewalScheduler->run();
+
+    const auto mdDescription = loadMdDescription(*consumer, TARGET_EPR);
+    LogBroker::getInstance().log(
+        LogMessage("ORTableConsumer", Severity::Notice, "MdDescription available (" + std::to_string(mdDescription.size()) + " bytes)"));
+
+    // Standby: connect to the redundant provider now and prefetch its MDIB, it is only subscribed on failover
+    if(!STANDBY_EPR.empty())
+    {
+        /*
+            TODO
+            Resolve STANDBY_EPR like the target and store the consumer object in standbyConsumer
+        */
+        if(standbyConsumer)
+        {
+            const auto standbyDescription = loadMdDescription(*standbyConsumer, STANDBY_EPR);
+            LogBroker::getInstance().log(LogMessage("ORTableConsumer",
+                                                    Severity::Notice,
+                                                    "Standby MdDescription available (" + std::to_string(standbyDescription.size()) + " bytes)"));
+        }
+    }
+
+    // Provider loss is detected by Bye, connection errors and unanswered probes, within the heartbeat timeout
+    providerWatchdog = std::make_unique<ProviderWatchdog>(watchdogConfig, failover, probeProvider);
+    discoveryHandler->registerByeCallback([](const std::string& p_epr) { providerWatchdog->onBye(p_epr); });
+    consumer->registerConnectionLostCallback([]() { providerWatchdog->onConnectionError(TARGET_EPR); });
+    if(standbyConsumer)
+    {
+        standbyConsumer->registerConnectionLostCallback([]() { providerWatchdog->onConnectionError(STANDBY_EPR); });
+    }
+    providerWatchdog->watch(TARGET_EPR);
+    providerWatchdog->run();
 
     // Register callback for SetValueResponse messages
-    auto setHandler = consumer->createSetHandler();
-    setHandler->registerActivateResponseCallback(onActivateResponse);
+    {
+        std::lock_guard<std::mutex> lock(consumerMutex);
+        createSetHandler();
+    }
+
+    operationExecutor = std::make_unique<OperationExecutor>();
+    operationExecutor->run();
+    operationClient = std::make_unique<OperationClient>(OperationClientConfig(), *operationExecutor, sendActivate);
+    operationClient->run();
 
     bool exit = false;
 
@@ -238,6 +678,9 @@ int main(int argc, char* argv[])
         std::cout << "i) Set predefined position to nullposition " << std::endl;
         std::cout << "j) Set predefined position to beach chair" << std::endl;
         std::cout << "k) Apply predefined position" << std::endl;
+#ifdef ORTABLE_COROUTINES
+        std::cout << "l) Raise table and backplate one step each, one after another" << std::endl;
+#endif
 
         std::cout << "y) Print status" << std::endl;
         std::cout << "z) Exit" << std::endl;
@@ -294,10 +737,34 @@ int main(int argc, char* argv[])
         }
 
 
+#ifdef ORTABLE_COROUTINES
+        else if (input == 'l')
+        {
+            using ORTable::ActivateOperation;
+            using ORTable::Handle;
+            namespace Mdib = ORTable::Mdib;
+            runOperationSequence({Handle<ActivateOperation, Mdib::ActivateIncreaseTableHeightSco>::value(),
+                                  Handle<ActivateOperation, Mdib::ActivateIncreaseBackplateSco>::value()})
+                .start(*operationExecutor);
+        }
+#endif
         else if (input == 'y')
         {
-            // TODO
-            // Request 
+            // The snapshot is consistent, reports arriving meanwhile go into the next version
+            const auto state = tableState.snapshot();
+            std::cout << "Status (version " << state->version << ")" << std::endl;
+            for(const auto& metric : state->metrics)
+            {
+                std::cout << "  " << metric.first << ": " << metric.second << std::endl;
+            }
+            for(const auto& condition : state->alertConditions)
+            {
+                std::cout << "  " << condition.first << ": " << (condition.second ? "present" : "not present") << std::endl;
+            }
+            for(const auto& signal : state->alertSignals)
+            {
+                std::cout << "  " << signal.first << ": " << signal.second << std::endl;
+            }
         }
         else if (input == 'z')
         {
@@ -305,6 +772,21 @@ int main(int argc, char* argv[])
         }
     }
 
+    tableState.close();
+    ORTABLE_TRACE_STOP();
+    providerWatchdog->stop();
+    renewalScheduler->stop();
+    logRenewalStatistics();
+    // Fails the operations still waiting, then lets the executor finish their flows
+    operationClient->stop();
+    logOperationStatistics();
+    operationExecutor->stop();
+    setHandler.reset();
+    if(standbyConsumer)
+    {
+        standbyConsumer->shutdown();
+        standbyConsumer.reset();
+    }
     consumer->shutdown();
     consumer.reset();
 
@@ -0,0 +1,103 @@
+#include "CannedReports.h"
+
+#include <cstdio>
+
+namespace
+{
+    const char* const METRIC_HANDLES[] = {"MDC_OR_TABLE_HEIGHT", "MDC_OR_TABLE_TREND", "MDC_OR_TABLE_TILT", "MDC_OR_TABLE_BACKPLATE"};
+    const char* const CONDITION_HANDLES[] = {"MDC_DEV_OR_TABLE_HEIGHT_UPPER",
+                                             "MDC_DEV_OR_TABLE_HEIGHT_LOWER",
+                                             "MDC_DEV_OR_TABLE_TILT_UPPER",
+                                             "MDC_DEV_OR_TABLE_TILT_LOWER"};
+
+    const char ENVELOPE_START[] =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+        "<s12:Envelope xmlns:s12=\"http://www.w3.org/2003/05/soap-envelope\" xmlns:wsa=\"http://www.w3.org/2005/08/addressing\" "
+        "xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" "
+        "xmlns:msg=\"http://standards.ieee.org/downloads/11073/11073-10207-2017/message\" "
+        "xmlns:pm=\"http://standards.ieee.org/downloads/11073/11073-10207-2017/participant\">";
+
+    const char SEQUENCE_ID[] = "urn:uuid:6f72746162-6c65-4265-6e63-686d61726b00";
+
+    std::string header(const char* p_action, std::uint64_t p_mdibVersion)
+    {
+        char messageId[64];
+        std::snprintf(messageId, sizeof(messageId), "urn:uuid:00000000-0000-4000-8000-%012llx", static_cast<unsigned long long>(p_mdibVersion));
+        return std::string("<s12:Header><wsa:Action>http://standards.ieee.org/downloads/11073/11073-20701-2018/") + p_action
+               + "</wsa:Action><wsa:MessageID>" + messageId + "</wsa:MessageID></s12:Header>";
+    }
+
+    std::string httpRequest(const std::string& p_path, const std::string& p_body)
+    {
+        return "POST " + p_path + " HTTP/1.1\r\nHost: 127.0.0.1\r\nContent-Type: application/soap+xml; charset=utf-8\r\nContent-Length: "
+               + std::to_string(p_body.size()) + "\r\n\r\n" + p_body;
+    }
+} // namespace
+
+std::string CannedReports::metricReport(std::uint64_t p_mdibVersion)
+{
+    std::string body(ENVELOPE_START);
+    body += header("StateEventService/EpisodicMetricReport", p_mdibVersion);
+    body += "<s12:Body><msg:EpisodicMetricReport MdibVersion=\"" + std::to_string(p_mdibVersion) + "\" SequenceId=\"" + SEQUENCE_ID
+            + "\"><msg:ReportPart>";
+    std::size_t axis{0};
+    for(const auto* handle : METRIC_HANDLES)
+    {
+        // Moves every axis a little with every report
+        const double value = static_cast<double>((p_mdibVersion * 7 + axis * 13) % 4000) / 100.0;
+        char formatted[32];
+        std::snprintf(formatted, sizeof(formatted), "%.2f", value);
+        body += std::string("<msg:MetricState xsi:type=\"pm:NumericMetricState\" DescriptorHandle=\"") + handle + "\" StateVersion=\""
+                + std::to_string(p_mdibVersion) + "\"><pm:MetricValue Value=\"" + formatted
+                + "\" DeterminationTime=\"1700000000000\"><pm:MetricQuality Validity=\"Vld\"/></pm:MetricValue></msg:MetricState>";
+        ++axis;
+    }
+    body += "</msg:ReportPart></msg:EpisodicMetricReport></s12:Body></s12:Envelope>";
+    return body;
+}
+
+std::string CannedReports::alertReport(std::uint64_t p_mdibVersion)
+{
+    std::string body(ENVELOPE_START);
+    body += header("StateEventService/EpisodicAlertReport", p_mdibVersion);
+    body += "<s12:Body><msg:EpisodicAlertReport MdibVersion=\"" + std::to_string(p_mdibVersion) + "\" SequenceId=\"" + SEQUENCE_ID
+            + "\"><msg:ReportPart>";
+    std::size_t index{0};
+    for(const auto* handle : CONDITION_HANDLES)
+    {
+        // Conditions toggle with alternating reports
+        const bool present = ((p_mdibVersion + index) % 2) == 0;
+        body += std::string("<msg:AlertState xsi:type=\"pm:LimitAlertConditionState\" DescriptorHandle=\"") + handle
+                + "\" ActivationState=\"On\" ActualPriority=\"Me\" Presence=\"" + (present ? "true" : "false") + "\"/>";
+        body += std::string("<msg:AlertState xsi:type=\"pm:AlertSignalState\" DescriptorHandle=\"") + handle
+                + "_SIGNAL\" ActivationState=\"On\" Presence=\"" + (present ? "On" : "Off") + "\"/>";
+        ++index;
+    }
+    body += "</msg:ReportPart></msg:EpisodicAlertReport></s12:Body></s12:Envelope>";
+    return body;
+}
+
+std::vector<CannedReport> CannedReports::generate(std::size_t p_count, std::size_t p_alertEvery, const std::string& p_path)
+{
+    std::vector<CannedReport> reports;
+    reports.reserve(p_count);
+    for(std::size_t i = 0; i < p_count; ++i)
+    {
+        const std::uint64_t mdibVersion = i + 1;
+        CannedReport report;
+        if(p_alertEvery != 0 && (i + 1) % p_alertEvery == 0)
+        {
+            report.kind = CannedReportKind::Alert;
+            report.request = httpRequest(p_path, alertReport(mdibVersion));
+            report.states = 2 * (sizeof(CONDITION_HANDLES) / sizeof(CONDITION_HANDLES[0]));
+        }
+        else
+        {
+            report.kind = CannedReportKind::Metric;
+            report.request = httpRequest(p_path, metricReport(mdibVersion));
+            report.states = sizeof(METRIC_HANDLES) / sizeof(METRIC_HANDLES[0]);
+        }
+        reports.push_back(std::move(report));
+    }
+    return reports;
+}
@@ -0,0 +1,44 @@
+/**
+ * @brief Pre-serialized notifications for the ingestion benchmark: complete HTTP requests carrying
+ * EpisodicMetricReports (the four axes of the table) and EpisodicAlertReports (limit conditions and their signals),
+ * shaped like the reports of the OR table provider. Values and MdibVersion change from message to message, so the
+ * consumer cannot short-cut repeated reports.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class CannedReportKind
+{
+    Metric,
+    Alert
+};
+
+struct CannedReport
+{
+    CannedReportKind kind{CannedReportKind::Metric};
+    // The HTTP request, headers and body
+    std::string request;
+    // States in the report, e.g. to compute states per second
+    std::size_t states{0};
+};
+
+class CannedReports
+{
+public:
+    /**
+     * @brief Generates the given number of reports.
+     * @param p_alertEvery every n-th report is an EpisodicAlertReport, 0 generates metric reports only
+     * @param p_path request path of the notification endpoint
+     */
+    static std::vector<CannedReport> generate(std::size_t p_count, std::size_t p_alertEvery, const std::string& p_path);
+
+    static std::string metricReport(std::uint64_t p_mdibVersion);
+    static std::string alertReport(std::uint64_t p_mdibVersion);
+};
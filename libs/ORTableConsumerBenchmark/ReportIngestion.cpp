@@ -0,0 +1,190 @@
+#include "ReportIngestion.h"
+
+#include <cstdlib>
+
+using namespace ORTable;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // Attributes are few per element, a linear search beats any index
+    const std::string* findAttribute(const std::vector<XmlAttribute>& p_attributes, StringView p_name)
+    {
+        for(const auto& attribute : p_attributes)
+        {
+            if(attribute.name == p_name)
+            {
+                return &attribute.value;
+            }
+        }
+        return nullptr;
+    }
+
+    // Compares the local part of a qualified name without building it
+    bool hasLocalName(StringView p_name, StringView p_localName)
+    {
+        return XmlStreamReader::localName(p_name) == p_localName;
+    }
+
+    bool endsWith(StringView p_value, StringView p_suffix)
+    {
+        return p_value.size() >= p_suffix.size() && p_value.substr(p_value.size() - p_suffix.size()) == p_suffix;
+    }
+} // namespace
+
+void IngestedReport::clear()
+{
+    kind = IngestedReportKind::Unknown;
+    mdibVersion = 0;
+    metrics.clear();
+    conditions.clear();
+    signals.clear();
+}
+
+ReportIngestion::ReportIngestion(IngestionCallbacks p_callbacks, AllocationCounter p_allocations)
+    : m_callbacks(std::move(p_callbacks))
+    , m_allocations(p_allocations)
+{
+}
+
+void ReportIngestion::onStartElement(const std::string& p_name, const std::vector<XmlAttribute>& p_attributes)
+{
+    if(hasLocalName(p_name, "MetricState"))
+    {
+        const auto* handle = findAttribute(p_attributes, "DescriptorHandle");
+        if(m_report.kind == IngestedReportKind::Metric && handle != nullptr)
+        {
+            m_report.metrics.push_back({*handle, 0});
+        }
+    }
+    else if(hasLocalName(p_name, "MetricValue"))
+    {
+        const auto* value = findAttribute(p_attributes, "Value");
+        if(value != nullptr && !m_report.metrics.empty())
+        {
+            m_report.metrics.back().value = std::strtod(value->c_str(), nullptr);
+        }
+    }
+    else if(hasLocalName(p_name, "AlertState"))
+    {
+        const auto* type = findAttribute(p_attributes, "xsi:type");
+        const auto* handle = findAttribute(p_attributes, "DescriptorHandle");
+        const auto* presence = findAttribute(p_attributes, "Presence");
+        if(m_report.kind != IngestedReportKind::Alert || type == nullptr || handle == nullptr || presence == nullptr)
+        {
+            return;
+        }
+        if(endsWith(*type, "AlertSignalState"))
+        {
+            m_report.signals.push_back({*handle, *presence});
+        }
+        else if(endsWith(*type, "AlertConditionState"))
+        {
+            m_report.conditions.push_back({*handle, *presence == "true"});
+        }
+    }
+    else if(hasLocalName(p_name, "EpisodicMetricReport") || hasLocalName(p_name, "EpisodicAlertReport"))
+    {
+        m_report.kind = hasLocalName(p_name, "EpisodicMetricReport") ? IngestedReportKind::Metric : IngestedReportKind::Alert;
+        const auto* mdibVersion = findAttribute(p_attributes, "MdibVersion");
+        m_report.mdibVersion = (mdibVersion != nullptr) ? std::strtoull(mdibVersion->c_str(), nullptr, 10) : 0;
+    }
+}
+
+void ReportIngestion::onEndElement(const std::string&)
+{
+}
+
+void ReportIngestion::onText(const std::string&)
+{
+}
+
+bool ReportIngestion::parse(const std::string& p_body)
+{
+    m_report.clear();
+    m_stream.clear();
+    m_stream.str(p_body);
+    return m_reader.parse(m_stream, *this) && m_report.kind != IngestedReportKind::Unknown;
+}
+
+template<typename Call>
+void ReportIngestion::timed(const Call& p_call)
+{
+    // The callbacks are timed on their own and taken out of the dispatch stage
+    const auto allocations = m_allocations();
+    const auto start = Clock::now();
+    p_call();
+    m_statistics.callbacks.time += Clock::now() - start;
+    m_statistics.callbacks.allocations += m_allocations() - allocations;
+}
+
+template<IngestedReportKind Kind>
+void ReportIngestion::dispatch()
+{
+    ORTABLE_IF_CONSTEXPR(Kind == IngestedReportKind::Metric)
+    {
+        if(m_callbacks.onMetric)
+        {
+            for(const auto& metric : m_report.metrics)
+            {
+                timed([this, &metric]() { m_callbacks.onMetric(metric.handle, metric.value); });
+            }
+        }
+    }
+    else
+    {
+        if(m_callbacks.onAlert)
+        {
+            timed([this]() { m_callbacks.onAlert(m_report); });
+        }
+    }
+}
+
+void ReportIngestion::dispatch()
+{
+    // One branch on the report kind, the handlers are specialized per kind
+    switch(m_report.kind)
+    {
+        case IngestedReportKind::Metric:
+            dispatch<IngestedReportKind::Metric>();
+            break;
+        case IngestedReportKind::Alert:
+            dispatch<IngestedReportKind::Alert>();
+            break;
+        case IngestedReportKind::Unknown:
+            break;
+    }
+}
+
+bool ReportIngestion::ingest(const std::string& p_body)
+{
+    auto allocations = m_allocations();
+    auto start = Clock::now();
+    const bool parsed = parse(p_body);
+    auto end = Clock::now();
+    m_statistics.parse.time += end - start;
+    m_statistics.parse.allocations += m_allocations() - allocations;
+    if(!parsed)
+    {
+        ++m_statistics.errors;
+        return false;
+    }
+
+    const auto callbackTime = m_statistics.callbacks.time;
+    const auto callbackAllocations = m_statistics.callbacks.allocations;
+    allocations = m_allocations();
+    start = Clock::now();
+    dispatch();
+    end = Clock::now();
+    m_statistics.dispatch.time += (end - start) - (m_statistics.callbacks.time - callbackTime);
+    m_statistics.dispatch.allocations += (m_allocations() - allocations) - (m_statistics.callbacks.allocations - callbackAllocations);
+
+    ++m_statistics.reports;
+    m_statistics.states += m_report.metrics.size() + m_report.conditions.size() + m_report.signals.size();
+    return true;
+}
+
+const IngestionStatistics& ReportIngestion::getStatistics() const
+{
+    return m_statistics;
+}
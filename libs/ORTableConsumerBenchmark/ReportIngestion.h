@@ -0,0 +1,104 @@
+/**
+ * @brief In-process report endpoint of the ingestion benchmark. Takes the body of a notification through the same
+ * stages as the consumer: parse (SOAP envelope to the states of the report), dispatch (routing by report type, one
+ * metric callback per state, one alert callback per report, as the sdcX reporting notifier does) and the callbacks of
+ * the consumer. Time and heap allocations are accounted per stage.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "TableStateModel.h"
+#include "XmlStreamReader.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <sstream>
+#include <string>
+#include <vector>
+
+enum class IngestedReportKind
+{
+    Unknown,
+    Metric,
+    Alert
+};
+
+// The alert states are parsed into the type the state model of the consumer applies
+struct IngestedReport : AlertReportStates
+{
+    struct Metric
+    {
+        std::string handle;
+        double value{0};
+    };
+
+    IngestedReportKind kind{IngestedReportKind::Unknown};
+    std::uint64_t mdibVersion{0};
+    std::vector<Metric> metrics;
+
+    // Keeps the capacity, so a reused report does not allocate for the same shape again
+    void clear();
+};
+
+struct IngestionCallbacks
+{
+    std::function<void(const std::string& p_handle, double p_value)> onMetric;
+    std::function<void(const IngestedReport& p_report)> onAlert;
+};
+
+struct IngestionStageStatistics
+{
+    std::chrono::nanoseconds time{0};
+    std::uint64_t allocations{0};
+};
+
+struct IngestionStatistics
+{
+    std::uint64_t reports{0};
+    std::uint64_t states{0};
+    std::uint64_t errors{0};
+    IngestionStageStatistics parse;
+    // Without the time and allocations of the callbacks
+    IngestionStageStatistics dispatch;
+    IngestionStageStatistics callbacks;
+};
+
+class ReportIngestion : private ORTable::XmlStreamHandler
+{
+public:
+    // Heap allocations of the calling thread so far
+    using AllocationCounter = std::uint64_t (*)();
+
+private:
+    IngestionCallbacks m_callbacks;
+    AllocationCounter m_allocations;
+
+    ORTable::XmlStreamReader m_reader;
+    std::istringstream m_stream;
+    IngestedReport m_report;
+
+    IngestionStatistics m_statistics;
+
+    void onStartElement(const std::string& p_name, const std::vector<ORTable::XmlAttribute>& p_attributes) override;
+    void onEndElement(const std::string& p_name) override;
+    void onText(const std::string& p_text) override;
+
+    bool parse(const std::string& p_body);
+    template<typename Call>
+    void timed(const Call& p_call);
+    template<IngestedReportKind Kind>
+    void dispatch();
+    void dispatch();
+
+public:
+    ReportIngestion(IngestionCallbacks p_callbacks, AllocationCounter p_allocations);
+
+    // Returns false if the body is not a report
+    bool ingest(const std::string& p_body);
+
+    const IngestionStatistics& getStatistics() const;
+};
@@ -0,0 +1,478 @@
+/**
+ * @file main.cpp
+ * @brief Report ingestion benchmark of the OR table consumer. Canned EpisodicMetricReports and EpisodicAlertReports
+ * are generated up front and sent over loopback connections as fast as the endpoint takes them, no provider needed.
+ *
+ * By default the endpoint is in-process: every connection is served by a thread that frames the HTTP requests and
+ * passes the bodies through parse, dispatch and the callbacks of the consumer (updating a TableStateModel). Throughput
+ * and time and heap allocations per report are printed per stage. With --target the reports are sent to a running
+ * endpoint instead, e.g. the notification endpoint of an ORTableDemoConsumer, and only the throughput is measured.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#include "CannedReports.h"
+#include "ReportIngestion.h"
+#include "TableStateModel.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    // Heap allocations per thread, counted by the replaced operator new below
+    thread_local std::uint64_t threadAllocations{0};
+
+    std::uint64_t countAllocations()
+    {
+        return threadAllocations;
+    }
+} // namespace
+
+void* operator new(std::size_t p_size)
+{
+    ++threadAllocations;
+    if(void* memory = std::malloc(p_size == 0 ? 1 : p_size))
+    {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p_memory) noexcept
+{
+    std::free(p_memory);
+}
+
+void operator delete(void* p_memory, std::size_t) noexcept
+{
+    std::free(p_memory);
+}
+
+namespace
+{
+    struct BenchmarkConfig
+    {
+        std::size_t reports{200000};
+        // Every n-th report is an alert report
+        std::size_t alertEvery{10};
+        std::size_t connections{4};
+        // Port of a running endpoint, 0 uses the in-process endpoint
+        unsigned int targetPort{0};
+        std::string path{"/"};
+        std::string output;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: ORTableConsumerBenchmark [options]\n"
+                  << "  --reports N          number of reports (default 200000)\n"
+                  << "  --alert-every N      every n-th report is an EpisodicAlertReport, 0 for none (default 10)\n"
+                  << "  --connections N      parallel connections (default 4)\n"
+                  << "  --target PORT        send to a running endpoint on the loopback interface\n"
+                  << "  --path PATH          request path of the endpoint (default /)\n"
+                  << "  --output FILE        append the results as a CSV line\n";
+    }
+
+    bool parseArguments(int p_argc, char* p_argv[], BenchmarkConfig& p_config)
+    {
+        for(int i = 1; i < p_argc; ++i)
+        {
+            const std::string option(p_argv[i]);
+            if(i + 1 >= p_argc)
+            {
+                return false;
+            }
+            const std::string value(p_argv[++i]);
+            if(option == "--reports")
+            {
+                p_config.reports = std::stoul(value);
+            }
+            else if(option == "--alert-every")
+            {
+                p_config.alertEvery = std::stoul(value);
+            }
+            else if(option == "--connections")
+            {
+                p_config.connections = std::stoul(value);
+            }
+            else if(option == "--target")
+            {
+                p_config.targetPort = static_cast<unsigned int>(std::stoul(value));
+            }
+            else if(option == "--path")
+            {
+                p_config.path = value;
+            }
+            else if(option == "--output")
+            {
+                p_config.output = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return p_config.reports > 0 && p_config.connections > 0;
+    }
+
+    /**
+     * Frames the HTTP messages in the buffer by their Content-Length and calls the function with each body.
+     * Handled messages are removed from the buffer, an incomplete one stays.
+     */
+    template<typename Function>
+    void frameMessages(std::string& p_buffer, Function&& p_onMessage)
+    {
+        std::size_t offset{0};
+        while(true)
+        {
+            const auto headerEnd = p_buffer.find("\r\n\r\n", offset);
+            if(headerEnd == std::string::npos)
+            {
+                break;
+            }
+            std::size_t contentLength{0};
+            const auto lengthHeader = p_buffer.find("Content-Length:", offset);
+            if(lengthHeader != std::string::npos && lengthHeader < headerEnd)
+            {
+                contentLength = std::strtoul(p_buffer.c_str() + lengthHeader + 15, nullptr, 10);
+            }
+            const auto bodyStart = headerEnd + 4;
+            if(p_buffer.size() < bodyStart + contentLength)
+            {
+                break;
+            }
+            p_onMessage(p_buffer, bodyStart, contentLength);
+            offset = bodyStart + contentLength;
+        }
+        p_buffer.erase(0, offset);
+    }
+
+    int connectLoopback(unsigned int p_port)
+    {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<std::uint16_t>(p_port));
+        if(fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            if(fd >= 0)
+            {
+                ::close(fd);
+            }
+            return -1;
+        }
+        const int noDelay{1};
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+        return fd;
+    }
+
+    bool sendAll(int p_fd, const std::string& p_data)
+    {
+        std::size_t sent{0};
+        while(sent < p_data.size())
+        {
+            const auto count = ::send(p_fd, p_data.data() + sent, p_data.size() - sent, MSG_NOSIGNAL);
+            if(count <= 0)
+            {
+                return false;
+            }
+            sent += static_cast<std::size_t>(count);
+        }
+        return true;
+    }
+
+    // The in-process endpoint, one thread per connection
+    class IngestionEndpoint
+    {
+    private:
+        TableStateModel& m_tableState;
+        int m_listener{-1};
+        std::uint16_t m_port{0};
+        std::vector<std::thread> m_threads;
+
+        std::mutex m_mutex;
+        IngestionStatistics m_total;
+        std::uint64_t m_allocations{0};
+
+        // Same state updates as the callbacks of ORTableDemoConsumer, without the logging
+        IngestionCallbacks makeCallbacks()
+        {
+            IngestionCallbacks callbacks;
+            callbacks.onMetric = [this](const std::string& p_handle, double p_value) { m_tableState.setMetric(p_handle, p_value); };
+            callbacks.onAlert = [this](const IngestedReport& p_report) { m_tableState.applyAlertReport(p_report); };
+            return callbacks;
+        }
+
+        void serve(int p_fd)
+        {
+            static const std::string ACCEPTED("HTTP/1.1 202 Accepted\r\nContent-Length: 0\r\n\r\n");
+            ReportIngestion ingestion(makeCallbacks(), countAllocations);
+            const auto allocationsStart = countAllocations();
+
+            std::string buffer;
+            std::string body;
+            std::string responses;
+            char chunk[64 * 1024];
+            ssize_t count{0};
+            while((count = ::recv(p_fd, chunk, sizeof(chunk), 0)) > 0)
+            {
+                buffer.append(chunk, static_cast<std::size_t>(count));
+                responses.clear();
+                frameMessages(buffer, [&](const std::string& p_buffer, std::size_t p_offset, std::size_t p_length) {
+                    body.assign(p_buffer, p_offset, p_length);
+                    ingestion.ingest(body);
+                    responses += ACCEPTED;
+                });
+                if(!responses.empty() && !sendAll(p_fd, responses))
+                {
+                    break;
+                }
+            }
+            ::close(p_fd);
+
+            const auto allocations = countAllocations() - allocationsStart;
+            const auto& statistics = ingestion.getStatistics();
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_total.reports += statistics.reports;
+            m_total.states += statistics.states;
+            m_total.errors += statistics.errors;
+            for(auto stage : {std::make_pair(&m_total.parse, &statistics.parse),
+                              std::make_pair(&m_total.dispatch, &statistics.dispatch),
+                              std::make_pair(&m_total.callbacks, &statistics.callbacks)})
+            {
+                stage.first->time += stage.second->time;
+                stage.first->allocations += stage.second->allocations;
+            }
+            m_allocations += allocations;
+        }
+
+    public:
+        explicit IngestionEndpoint(TableStateModel& p_tableState)
+            : m_tableState(p_tableState)
+        {
+        }
+
+        ~IngestionEndpoint()
+        {
+            join();
+            if(m_listener >= 0)
+            {
+                ::close(m_listener);
+            }
+        }
+
+        bool open()
+        {
+            m_listener = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            socklen_t length = sizeof(address);
+            if(m_listener < 0 || ::bind(m_listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0
+               || ::listen(m_listener, 64) != 0 || ::getsockname(m_listener, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+            {
+                return false;
+            }
+            m_port = ntohs(address.sin_port);
+            return true;
+        }
+
+        std::uint16_t getPort() const
+        {
+            return m_port;
+        }
+
+        // Serves the given number of connections, each on its own thread
+        void accept(std::size_t p_connections)
+        {
+            for(std::size_t i = 0; i < p_connections; ++i)
+            {
+                const int fd = ::accept4(m_listener, nullptr, nullptr, SOCK_CLOEXEC);
+                if(fd >= 0)
+                {
+                    m_threads.emplace_back([this, fd]() { serve(fd); });
+                }
+            }
+        }
+
+        void join()
+        {
+            for(auto& thread : m_threads)
+            {
+                thread.join();
+            }
+            m_threads.clear();
+        }
+
+        IngestionStatistics getStatistics(std::uint64_t& p_allocations)
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            p_allocations = m_allocations;
+            return m_total;
+        }
+    };
+
+    // Sends its share of the reports and counts the responses on a second thread, returns the responses received
+    std::uint64_t replay(unsigned int p_port, const std::vector<CannedReport>& p_reports, std::size_t p_first, std::size_t p_end)
+    {
+        const int fd = connectLoopback(p_port);
+        if(fd < 0)
+        {
+            return 0;
+        }
+        const auto expected = p_end - p_first;
+        std::uint64_t responses{0};
+        std::thread reader([fd, expected, &responses]() {
+            std::string buffer;
+            char chunk[16 * 1024];
+            ssize_t count{0};
+            while(responses < expected && (count = ::recv(fd, chunk, sizeof(chunk), 0)) > 0)
+            {
+                buffer.append(chunk, static_cast<std::size_t>(count));
+                frameMessages(buffer, [&responses](const std::string&, std::size_t, std::size_t) { ++responses; });
+            }
+        });
+        for(std::size_t i = p_first; i < p_end; ++i)
+        {
+            if(!sendAll(fd, p_reports[i].request))
+            {
+                break;
+            }
+        }
+        ::shutdown(fd, SHUT_WR);
+        reader.join();
+        ::close(fd);
+        return responses;
+    }
+
+    double perReport(double p_value, std::uint64_t p_reports)
+    {
+        return p_reports > 0 ? p_value / static_cast<double>(p_reports) : 0.0;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchmarkConfig config;
+    if(!parseArguments(argc, argv, config))
+    {
+        printUsage();
+        return 1;
+    }
+
+    const auto reports = CannedReports::generate(config.reports, config.alertEvery, config.path);
+    std::uint64_t states{0};
+    std::uint64_t bytes{0};
+    for(const auto& report : reports)
+    {
+        states += report.states;
+        bytes += report.request.size();
+    }
+    std::cout << "Generated " << reports.size() << " reports, " << states << " states, " << bytes / 1024 << " KiB" << std::endl;
+
+    TableStateModel tableState;
+    IngestionEndpoint endpoint(tableState);
+    unsigned int port = config.targetPort;
+    if(port == 0)
+    {
+        if(!endpoint.open())
+        {
+            std::cerr << "Could not open the endpoint" << std::endl;
+            return 1;
+        }
+        port = endpoint.getPort();
+    }
+
+    const auto start = Clock::now();
+    std::thread acceptor;
+    if(config.targetPort == 0)
+    {
+        acceptor = std::thread([&endpoint, &config]() { endpoint.accept(config.connections); });
+    }
+    std::vector<std::thread> senders;
+    std::vector<std::uint64_t> responses(config.connections, 0);
+    for(std::size_t i = 0; i < config.connections; ++i)
+    {
+        const auto first = reports.size() * i / config.connections;
+        const auto end = reports.size() * (i + 1) / config.connections;
+        senders.emplace_back([&, i, first, end]() { responses[i] = replay(port, reports, first, end); });
+    }
+    for(auto& sender : senders)
+    {
+        sender.join();
+    }
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    if(acceptor.joinable())
+    {
+        acceptor.join();
+    }
+    endpoint.join();
+
+    std::uint64_t delivered{0};
+    for(const auto count : responses)
+    {
+        delivered += count;
+    }
+    std::cout << "Delivered " << delivered << " reports in " << elapsed << " s: " << delivered / elapsed << " reports/s, "
+              << perReport(static_cast<double>(states), reports.size()) * delivered / elapsed << " states/s" << std::endl;
+
+    if(config.targetPort != 0)
+    {
+        return delivered == reports.size() ? 0 : 1;
+    }
+
+    std::uint64_t allocations{0};
+    const auto statistics = endpoint.getStatistics(allocations);
+    const auto stageLine = [&statistics](const char* p_name, const IngestionStageStatistics& p_stage) {
+        std::cout << "  " << p_name << ": " << perReport(static_cast<double>(p_stage.time.count()), statistics.reports) << " ns/report, "
+                  << perReport(static_cast<double>(p_stage.allocations), statistics.reports) << " allocations/report" << std::endl;
+    };
+    std::cout << "Ingested " << statistics.reports << " reports (" << statistics.errors << " errors), table state version "
+              << tableState.version() << std::endl;
+    stageLine("parse", statistics.parse);
+    stageLine("dispatch", statistics.dispatch);
+    stageLine("callbacks", statistics.callbacks);
+    std::cout << "  total incl. HTTP framing: " << perReport(static_cast<double>(allocations), statistics.reports)
+              << " allocations/report" << std::endl;
+
+    if(!config.output.empty())
+    {
+        std::ofstream csv(config.output, std::ios::app);
+        if(csv.tellp() == 0)
+        {
+            csv << "reports,connections,alert_every,reports_per_s,parse_ns,dispatch_ns,callbacks_ns,"
+                   "parse_allocations,dispatch_allocations,callbacks_allocations,total_allocations\n";
+        }
+        const auto reportsCount = statistics.reports;
+        csv << reportsCount << ',' << config.connections << ',' << config.alertEvery << ',' << delivered / elapsed << ','
+            << perReport(static_cast<double>(statistics.parse.time.count()), reportsCount) << ','
+            << perReport(static_cast<double>(statistics.dispatch.time.count()), reportsCount) << ','
+            << perReport(static_cast<double>(statistics.callbacks.time.count()), reportsCount) << ','
+            << perReport(static_cast<double>(statistics.parse.allocations), reportsCount) << ','
+            << perReport(static_cast<double>(statistics.dispatch.allocations), reportsCount) << ','
+            << perReport(static_cast<double>(statistics.callbacks.allocations), reportsCount) << ','
+            << perReport(static_cast<double>(allocations), reportsCount) << '\n';
+    }
+
+    tableState.close();
+    return statistics.errors == 0 && delivered == reports.size() ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#include "PtyLink.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace ORTable;
+
+PtyLink::PtyLink(LinkConfig p_config)
+    : m_config(std::move(p_config))
+    , m_receiveBuffer(4096)
+    , m_sendBuffer(64 * 1024)
+    , m_random(m_config.seed)
+{
+}
+
+PtyLink::~PtyLink()
+{
+    if(m_master >= 0)
+    {
+        ::close(m_master);
+    }
+    if(!m_config.linkPath.empty())
+    {
+        ::unlink(m_config.linkPath.c_str());
+    }
+}
+
+bool PtyLink::open()
+{
+    m_master = posix_openpt(O_RDWR | O_NOCTTY | O_NONBLOCK);
+    if(m_master < 0 || grantpt(m_master) != 0 || unlockpt(m_master) != 0)
+    {
+        return false;
+    }
+    const char* slaveName = ptsname(m_master);
+    if(slaveName == nullptr)
+    {
+        return false;
+    }
+    m_slaveName = slaveName;
+
+    // Binary data, no echo or line editing on the master side either
+    termios settings;
+    if(tcgetattr(m_master, &settings) == 0)
+    {
+        cfmakeraw(&settings);
+        tcsetattr(m_master, TCSANOW, &settings);
+    }
+
+    if(!m_config.linkPath.empty())
+    {
+        ::unlink(m_config.linkPath.c_str());
+        if(::symlink(m_slaveName.c_str(), m_config.linkPath.c_str()) != 0)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+const std::string& PtyLink::getSlaveName() const
+{
+    return m_slaveName;
+}
+
+bool PtyLink::isPeerConnected() const
+{
+    pollfd descriptor{m_master, POLLOUT, 0};
+    return ::poll(&descriptor, 1, 0) >= 0 && (descriptor.revents & POLLHUP) == 0;
+}
+
+void PtyLink::receive(std::chrono::milliseconds p_timeout, const FrameParser::FrameFunction& p_onFrame)
+{
+    pollfd descriptor{m_master, POLLIN, 0};
+    const auto ready = ::poll(&descriptor, 1, static_cast<int>(p_timeout.count()));
+    if(ready <= 0)
+    {
+        return;
+    }
+    if((descriptor.revents & POLLIN) == 0)
+    {
+        // Without a peer the master reports POLLHUP permanently, wait for the provider to open the port
+        std::this_thread::sleep_for(p_timeout);
+        return;
+    }
+
+    while(true)
+    {
+        const auto regions = m_receiveBuffer.writable();
+        iovec vectors[2]{{regions[0].data, regions[0].size}, {regions[1].data, regions[1].size}};
+        const auto received = ::readv(m_master, vectors, regions[1].size > 0 ? 2 : 1);
+        if(received <= 0)
+        {
+            break;
+        }
+        m_receiveBuffer.produce(static_cast<std::size_t>(received));
+        m_counters.framesReceived += m_parser.parse(m_receiveBuffer, p_onFrame);
+    }
+}
+
+void PtyLink::send(const std::uint8_t* p_frame, std::size_t p_size)
+{
+    if(m_chance(m_random) < m_config.garbageRate)
+    {
+        std::uint8_t garbage[8];
+        const auto count = 1 + m_random() % sizeof(garbage);
+        for(std::size_t i = 0; i < count; ++i)
+        {
+            garbage[i] = static_cast<std::uint8_t>(m_random());
+        }
+        if(m_sendBuffer.write(garbage, count))
+        {
+            m_counters.garbageBytes += count;
+        }
+    }
+
+    std::vector<std::uint8_t> frame(p_frame, p_frame + p_size);
+    if(m_chance(m_random) < m_config.corruptRate)
+    {
+        frame[m_random() % frame.size()] ^= static_cast<std::uint8_t>(1u << (m_random() % 8));
+        ++m_counters.corruptedFrames;
+    }
+    if(!m_sendBuffer.write(frame.data(), frame.size()))
+    {
+        ++m_counters.overruns;
+        return;
+    }
+    ++m_counters.framesSent;
+}
+
+void PtyLink::transmit(std::chrono::duration<double> p_elapsed)
+{
+    // 8N1 needs 10 bit per byte. Unused credit is not saved up beyond one frame, like an idle line
+    const auto bytes = m_config.baudRate / 10.0 * p_elapsed.count();
+    m_lineCredit = std::min(m_lineCredit + bytes, bytes + static_cast<double>(TableProtocol::MAX_FRAME_SIZE));
+
+    auto allowed = std::min(static_cast<std::size_t>(m_lineCredit), m_sendBuffer.size());
+    while(allowed > 0)
+    {
+        const auto regions = m_sendBuffer.readable();
+        const auto first = std::min(allowed, regions[0].size);
+        iovec vectors[2]{{const_cast<std::uint8_t*>(regions[0].data), first},
+                         {const_cast<std::uint8_t*>(regions[1].data), allowed - first}};
+        const auto sent = ::writev(m_master, vectors, allowed > first ? 2 : 1);
+        if(sent <= 0)
+        {
+            break;
+        }
+        m_sendBuffer.consume(static_cast<std::size_t>(sent));
+        m_lineCredit -= static_cast<double>(sent);
+        allowed -= static_cast<std::size_t>(sent);
+    }
+}
+
+LinkCounters PtyLink::getCounters() const
+{
+    return m_counters;
+}
+
+const FrameParserCounters& PtyLink::getParserCounters() const
+{
+    return m_parser.getCounters();
+}
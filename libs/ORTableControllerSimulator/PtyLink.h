@@ -0,0 +1,83 @@
+/**
+ * @brief Controller side of the serial line, emulated by a pseudo terminal. The provider opens the slave side like a
+ * real serial port. Outgoing bytes are paced to the configured line rate (10 bit per byte for 8N1) and the link can
+ * inject errors: corrupted frames, garbage between frames and delayed acknowledgements.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "RingBuffer.h"
+#include "TableProtocol.h"
+
+#include <chrono>
+#include <cstdint>
+#include <random>
+#include <string>
+
+struct LinkConfig
+{
+    unsigned int baudRate{115200};
+    // Probability of a flipped bit within an outgoing frame
+    double corruptRate{0.0};
+    // Probability of a few random bytes in front of an outgoing frame
+    double garbageRate{0.0};
+    // Symbolic link to the slave device, e.g. to use a fixed device name in tests
+    std::string linkPath;
+    unsigned int seed{1};
+};
+
+struct LinkCounters
+{
+    std::uint64_t framesSent{0};
+    std::uint64_t framesReceived{0};
+    std::uint64_t corruptedFrames{0};
+    std::uint64_t garbageBytes{0};
+    // Frames dropped because the line could not keep up
+    std::uint64_t overruns{0};
+};
+
+class PtyLink
+{
+private:
+    const LinkConfig m_config;
+    int m_master{-1};
+    std::string m_slaveName;
+
+    ORTable::RingBuffer m_receiveBuffer;
+    ORTable::FrameParser m_parser;
+    ORTable::RingBuffer m_sendBuffer;
+    // Bytes the line may still transmit in the current step
+    double m_lineCredit{0};
+
+    std::mt19937 m_random;
+    std::uniform_real_distribution<double> m_chance{0.0, 1.0};
+    LinkCounters m_counters;
+
+public:
+    explicit PtyLink(LinkConfig p_config);
+    ~PtyLink();
+
+    PtyLink(const PtyLink&) = delete;
+    PtyLink& operator=(const PtyLink&) = delete;
+
+    bool open();
+    const std::string& getSlaveName() const;
+
+    // Whether the provider has the slave side open
+    bool isPeerConnected() const;
+
+    // Waits up to p_timeout for data, parses it and hands complete frames to p_onFrame
+    void receive(std::chrono::milliseconds p_timeout, const ORTable::FrameParser::FrameFunction& p_onFrame);
+
+    // Queues a frame, errors are injected here
+    void send(const std::uint8_t* p_frame, std::size_t p_size);
+
+    // Writes as many queued bytes as the line rate allows within the elapsed time
+    void transmit(std::chrono::duration<double> p_elapsed);
+
+    LinkCounters getCounters() const;
+    const ORTable::FrameParserCounters& getParserCounters() const;
+};
@@ -0,0 +1,171 @@
+#include "TableSimulator.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace ORTable;
+
+constexpr std::size_t TableSimulator::AXIS_COUNT;
+
+namespace
+{
+    constexpr std::size_t HEIGHT{0};
+    constexpr std::size_t TREND{1};
+    constexpr std::size_t TILT{2};
+    constexpr std::size_t BACKPLATE{3};
+
+    // Targets of the predefined positions, in the order of the PredefinedPosition enum of the provider
+    constexpr double PREDEFINED_POSITIONS[][TableSimulator::AXIS_COUNT]{
+        {80, 0, 0, 0},  // Null level
+        {80, 0, 0, 45}, // Beach chair
+    };
+} // namespace
+
+TableSimulator::TableSimulator(double p_speedFactor)
+{
+    const auto factor = p_speedFactor > 0 ? p_speedFactor : 1.0;
+    m_axes[HEIGHT] = Axis{80, 80, 2.0 * factor, 60, 140, {}};
+    m_axes[TREND] = Axis{0, 0, 3.0 * factor, -45, 45, {}};
+    m_axes[TILT] = Axis{0, 0, 3.0 * factor, -25, 25, {}};
+    m_axes[BACKPLATE] = Axis{0, 0, 5.0 * factor, -40, 80, {}};
+}
+
+bool TableSimulator::isAxisMoving(const Axis& p_axis) const
+{
+    return p_axis.position != p_axis.target;
+}
+
+void TableSimulator::handle(const TableCommand& p_command, std::uint16_t p_sequence)
+{
+    switch(p_command.code)
+    {
+        case CommandCode::Stop:
+        {
+            for(auto& axis : m_axes)
+            {
+                axis.target = axis.position;
+                for(const auto sequence : axis.waiting)
+                {
+                    m_completed.push_back({sequence, AckStatus::Rejected});
+                }
+                axis.waiting.clear();
+            }
+            for(const auto sequence : m_waitingForAll)
+            {
+                m_completed.push_back({sequence, AckStatus::Rejected});
+            }
+            m_waitingForAll.clear();
+            m_completed.push_back({p_sequence, AckStatus::Done});
+            return;
+        }
+        case CommandCode::MoveHeight:
+        case CommandCode::MoveTrend:
+        case CommandCode::MoveTilt:
+        case CommandCode::MoveBackplate:
+        {
+            auto& axis = m_axes[static_cast<std::size_t>(p_command.code) - static_cast<std::size_t>(CommandCode::MoveHeight)];
+            const auto target = axis.target + p_command.argument;
+            if(target < axis.minimum || target > axis.maximum)
+            {
+                m_completed.push_back({p_sequence, AckStatus::Rejected});
+                return;
+            }
+            axis.target = target;
+            if(!isAxisMoving(axis))
+            {
+                m_completed.push_back({p_sequence, AckStatus::Done});
+                return;
+            }
+            axis.waiting.push_back(p_sequence);
+            return;
+        }
+        case CommandCode::ApplyPosition:
+        {
+            // Checked as double first, casting NaN or an out of range value to size_t is undefined
+            constexpr auto positionCount = sizeof(PREDEFINED_POSITIONS) / sizeof(PREDEFINED_POSITIONS[0]);
+            if(!std::isfinite(p_command.argument) || p_command.argument < 0 || p_command.argument >= positionCount)
+            {
+                m_completed.push_back({p_sequence, AckStatus::Rejected});
+                return;
+            }
+            const auto position = static_cast<std::size_t>(p_command.argument);
+            // Jogs and positions whose target is replaced never reach it, they are rejected like on Stop
+            bool superseded = false;
+            for(std::size_t i = 0; i < AXIS_COUNT; ++i)
+            {
+                auto& axis = m_axes[i];
+                if(axis.target == PREDEFINED_POSITIONS[position][i])
+                {
+                    continue;
+                }
+                superseded = true;
+                axis.target = PREDEFINED_POSITIONS[position][i];
+                for(const auto sequence : axis.waiting)
+                {
+                    m_completed.push_back({sequence, AckStatus::Rejected});
+                }
+                axis.waiting.clear();
+            }
+            if(superseded)
+            {
+                for(const auto sequence : m_waitingForAll)
+                {
+                    m_completed.push_back({sequence, AckStatus::Rejected});
+                }
+                m_waitingForAll.clear();
+            }
+            m_waitingForAll.push_back(p_sequence);
+            return;
+        }
+    }
+    m_completed.push_back({p_sequence, AckStatus::Unknown});
+}
+
+void TableSimulator::advance(std::chrono::duration<double> p_elapsed, std::vector<SimulatorAck>& p_acks)
+{
+    for(auto& axis : m_axes)
+    {
+        if(!isAxisMoving(axis))
+        {
+            continue;
+        }
+        const auto step = axis.speed * p_elapsed.count();
+        const auto distance = axis.target - axis.position;
+        axis.position = std::abs(distance) <= step ? axis.target : axis.position + std::copysign(step, distance);
+        if(!isAxisMoving(axis))
+        {
+            for(const auto sequence : axis.waiting)
+            {
+                m_completed.push_back({sequence, AckStatus::Done});
+            }
+            axis.waiting.clear();
+        }
+    }
+    if(!m_waitingForAll.empty() && !isMoving())
+    {
+        for(const auto sequence : m_waitingForAll)
+        {
+            m_completed.push_back({sequence, AckStatus::Done});
+        }
+        m_waitingForAll.clear();
+    }
+
+    p_acks.insert(p_acks.end(), m_completed.begin(), m_completed.end());
+    m_completed.clear();
+}
+
+TableTelemetry TableSimulator::getTelemetry() const
+{
+    TableTelemetry telemetry;
+    telemetry.height = m_axes[HEIGHT].position;
+    telemetry.trend = m_axes[TREND].position;
+    telemetry.tilt = m_axes[TILT].position;
+    telemetry.backplate = m_axes[BACKPLATE].position;
+    telemetry.moving = isMoving();
+    return telemetry;
+}
+
+bool TableSimulator::isMoving() const
+{
+    return std::any_of(m_axes.begin(), m_axes.end(), [this](const Axis& p_axis) { return isAxisMoving(p_axis); });
+}
@@ -0,0 +1,63 @@
+/**
+ * @brief Motion model of the table controller. Axes move towards their targets with a fixed speed, like the real
+ * drives, so a command is acknowledged when its movement is complete and not when it is received. Commands on
+ * different axes complete independently, i.e. acknowledgements may arrive in another order than the commands.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "TableProtocol.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+
+struct SimulatorAck
+{
+    std::uint16_t sequence;
+    ORTable::AckStatus status;
+};
+
+class TableSimulator
+{
+public:
+    static constexpr std::size_t AXIS_COUNT{4};
+
+private:
+    struct Axis
+    {
+        double position;
+        double target;
+        // Units per second
+        double speed;
+        double minimum;
+        double maximum;
+        // Commands acknowledged when the axis reaches its target
+        std::vector<std::uint16_t> waiting;
+    };
+
+    // Height, trend, tilt, backplate
+    std::array<Axis, AXIS_COUNT> m_axes;
+    // Predefined positions, acknowledged when all axes reached their targets
+    std::vector<std::uint16_t> m_waitingForAll;
+    std::vector<SimulatorAck> m_completed;
+
+    bool isAxisMoving(const Axis& p_axis) const;
+
+public:
+    // The speed factor accelerates all movements, e.g. for tests
+    explicit TableSimulator(double p_speedFactor = 1.0);
+
+    // Starts the command. Invalid commands and commands without movement are acknowledged with the next advance()
+    void handle(const ORTable::TableCommand& p_command, std::uint16_t p_sequence);
+
+    // Moves the axes by the given time and appends the acknowledgements of completed commands
+    void advance(std::chrono::duration<double> p_elapsed, std::vector<SimulatorAck>& p_acks);
+
+    ORTable::TableTelemetry getTelemetry() const;
+    bool isMoving() const;
+};
@@ -0,0 +1,228 @@
+/**
+ * @file main.cpp
+ * @brief Stand-in for the table controller. Opens a pseudo terminal, prints the name of its slave device and speaks
+ * the controller protocol on it: commands move the simulated axes with the speed of the real drives, telemetry is
+ * sent while the table moves and acknowledgements follow when a movement is complete.
+ *
+ * Start the provider with ORTABLE_SERIAL_DEVICE set to the printed device (or to the --link path) to test the serial
+ * bridge without hardware. Line rate and error injection are configurable, the counters are printed on exit.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#include "PtyLink.h"
+#include "TableSimulator.h"
+
+#include <atomic>
+#include <csignal>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace ORTable;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    std::atomic<bool> stopRequested{false};
+
+    void onSignal(int)
+    {
+        stopRequested = true;
+    }
+
+    struct SimulatorConfig
+    {
+        LinkConfig link;
+        double speedFactor{1.0};
+        std::chrono::milliseconds ackDelay{0};
+        std::chrono::milliseconds telemetryInterval{50};
+        std::chrono::milliseconds idleInterval{1000};
+        // 0 runs until interrupted
+        std::chrono::seconds duration{0};
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: ORTableControllerSimulator [options]\n"
+                  << "  --link PATH                 symbolic link to the slave device\n"
+                  << "  --baud N                    line rate in bit/s (default 115200)\n"
+                  << "  --corrupt-rate P            probability of a corrupted frame (0..1)\n"
+                  << "  --garbage-rate P            probability of garbage in front of a frame (0..1)\n"
+                  << "  --ack-delay MS              additional delay of every acknowledgement\n"
+                  << "  --speed-factor F            accelerates all movements\n"
+                  << "  --telemetry-interval MS     telemetry interval while moving (default 50)\n"
+                  << "  --idle-interval MS          telemetry interval at rest (default 1000)\n"
+                  << "  --duration S                exit after S seconds\n"
+                  << "  --seed N                    seed of the error injection\n";
+    }
+
+    bool parseArguments(int p_argc, char* p_argv[], SimulatorConfig& p_config)
+    {
+        for(int i = 1; i < p_argc; ++i)
+        {
+            const std::string option(p_argv[i]);
+            if(i + 1 >= p_argc)
+            {
+                return false;
+            }
+            const std::string value(p_argv[++i]);
+            if(option == "--link")
+            {
+                p_config.link.linkPath = value;
+            }
+            else if(option == "--baud")
+            {
+                p_config.link.baudRate = static_cast<unsigned int>(std::stoul(value));
+            }
+            else if(option == "--corrupt-rate")
+            {
+                p_config.link.corruptRate = std::stod(value);
+            }
+            else if(option == "--garbage-rate")
+            {
+                p_config.link.garbageRate = std::stod(value);
+            }
+            else if(option == "--ack-delay")
+            {
+                p_config.ackDelay = std::chrono::milliseconds(std::stol(value));
+            }
+            else if(option == "--speed-factor")
+            {
+                p_config.speedFactor = std::stod(value);
+            }
+            else if(option == "--telemetry-interval")
+            {
+                p_config.telemetryInterval = std::chrono::milliseconds(std::stol(value));
+            }
+            else if(option == "--idle-interval")
+            {
+                p_config.idleInterval = std::chrono::milliseconds(std::stol(value));
+            }
+            else if(option == "--duration")
+            {
+                p_config.duration = std::chrono::seconds(std::stol(value));
+            }
+            else if(option == "--seed")
+            {
+                p_config.link.seed = static_cast<unsigned int>(std::stoul(value));
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    SimulatorConfig config;
+    try
+    {
+        if(!parseArguments(argc, argv, config))
+        {
+            printUsage();
+            return -1;
+        }
+    }
+    catch(const std::exception&)
+    {
+        printUsage();
+        return -1;
+    }
+
+    std::signal(SIGINT, onSignal);
+    std::signal(SIGTERM, onSignal);
+
+    PtyLink link(config.link);
+    if(!link.open())
+    {
+        std::cout << "Could not open pseudo terminal" << std::endl;
+        return -1;
+    }
+    std::cout << "Table controller listening on " << link.getSlaveName()
+              << (config.link.linkPath.empty() ? "" : " (" + config.link.linkPath + ")") << std::endl;
+
+    TableSimulator simulator(config.speedFactor);
+
+    struct DelayedAck
+    {
+        Clock::time_point due;
+        SimulatorAck ack;
+    };
+    std::deque<DelayedAck> delayedAcks;
+    std::vector<SimulatorAck> acks;
+    std::uint64_t commands{0};
+    std::uint16_t telemetrySequence{0};
+
+    const auto start = Clock::now();
+    auto last = start;
+    auto lastTelemetry = start;
+    std::uint8_t frame[TableProtocol::MAX_FRAME_SIZE];
+
+    while(!stopRequested)
+    {
+        link.receive(std::chrono::milliseconds(5), [&](const Frame& p_frame) {
+            TableCommand command;
+            if(TableProtocol::decodeCommand(p_frame, command))
+            {
+                ++commands;
+                simulator.handle(command, p_frame.sequence);
+            }
+        });
+
+        const auto now = Clock::now();
+        const auto elapsed = std::chrono::duration<double>(now - last);
+        last = now;
+
+        simulator.advance(elapsed, acks);
+        for(const auto& ack : acks)
+        {
+            delayedAcks.push_back({now + config.ackDelay, ack});
+        }
+        acks.clear();
+
+        // Without a peer, acknowledgements and telemetry are lost like on an unplugged line
+        const bool connected = link.isPeerConnected();
+        while(!delayedAcks.empty() && delayedAcks.front().due <= now)
+        {
+            if(connected)
+            {
+                const auto size = TableProtocol::encodeAck(delayedAcks.front().ack.status, delayedAcks.front().ack.sequence, frame);
+                link.send(frame, size);
+            }
+            delayedAcks.pop_front();
+        }
+
+        const auto interval = simulator.isMoving() ? config.telemetryInterval : config.idleInterval;
+        if(now - lastTelemetry >= interval)
+        {
+            lastTelemetry = now;
+            if(connected)
+            {
+                const auto size = TableProtocol::encodeTelemetry(simulator.getTelemetry(), telemetrySequence++, frame);
+                link.send(frame, size);
+            }
+        }
+
+        link.transmit(elapsed);
+
+        if(config.duration.count() > 0 && now - start >= config.duration)
+        {
+            break;
+        }
+    }
+
+    const auto counters = link.getCounters();
+    const auto& parserCounters = link.getParserCounters();
+    std::cout << "Commands: " << commands << ", frames sent: " << counters.framesSent
+              << ", corrupted: " << counters.corruptedFrames << ", garbage bytes: " << counters.garbageBytes
+              << ", overruns: " << counters.overruns << ", receive CRC errors: " << parserCounters.crcErrors
+              << ", receive header errors: " << parserCounters.headerErrors << std::endl;
+    return 0;
+}
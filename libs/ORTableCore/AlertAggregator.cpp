@@ -0,0 +1,273 @@
+#include "AlertAggregator.h"
+
+#include <algorithm>
+
+AlertAggregator::AlertAggregator(std::shared_ptr<AlertStateEngine> p_alerts,
+                                 TimerWheel& p_timerWheel,
+                                 AlertAggregationConfig p_config,
+                                 PublishFunction p_publish)
+    : m_alerts(std::move(p_alerts))
+    , m_timerWheel(p_timerWheel)
+    , m_config(std::move(p_config))
+    , m_publish(std::move(p_publish))
+{
+}
+
+AlertAggregator::~AlertAggregator()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_flushScheduled)
+    {
+        m_timerWheel.cancel(m_flushTimer);
+    }
+}
+
+int AlertAggregator::valueOf(const Pending& p_entry)
+{
+    if(p_entry.isSignal)
+    {
+        return static_cast<int>(p_entry.signal.presence);
+    }
+    return (p_entry.condition.present ? 16 : 0) + static_cast<int>(p_entry.condition.actualPriority);
+}
+
+bool AlertAggregator::takeToken(const std::string& p_handle, TimerWheel::Clock::time_point p_now)
+{
+    const auto burst = static_cast<double>(std::max(m_config.burst, 1u));
+    auto it = m_buckets.find(p_handle);
+    if(it == m_buckets.end())
+    {
+        it = m_buckets.emplace(p_handle, Bucket{burst, p_now}).first;
+    }
+    auto& bucket = it->second;
+    if(m_config.refillInterval.count() > 0)
+    {
+        const auto elapsed = std::chrono::duration<double, std::milli>(p_now - bucket.lastRefill).count();
+        bucket.tokens = std::min(burst, bucket.tokens + elapsed / static_cast<double>(m_config.refillInterval.count()));
+    }
+    bucket.lastRefill = p_now;
+    if(bucket.tokens < 1.0)
+    {
+        return false;
+    }
+    bucket.tokens -= 1.0;
+    return true;
+}
+
+void AlertAggregator::returnToken(const std::string& p_handle)
+{
+    const auto it = m_buckets.find(p_handle);
+    if(it != m_buckets.end())
+    {
+        it->second.tokens = std::min(static_cast<double>(std::max(m_config.burst, 1u)), it->second.tokens + 1.0);
+    }
+}
+
+bool AlertAggregator::isKnown(const std::string& p_handle, bool p_isSignal) const
+{
+    const auto id = p_isSignal ? m_alerts->findSignal(p_handle) : m_alerts->findCondition(p_handle);
+    return id != AlertStateEngine::NO_ENTRY;
+}
+
+void AlertAggregator::requeue(std::vector<std::pair<std::string, Pending>> p_entries)
+{
+    std::vector<std::string> order;
+    for(auto& entry : p_entries)
+    {
+        // The rejected attempt does not count against the rate limit
+        returnToken(entry.first);
+        // A newer state replaces the rejected one, alerts removed by an MDIB reload are not retried at all
+        if(m_pending.count(entry.first) > 0 || !isKnown(entry.first, entry.second.isSignal))
+        {
+            continue;
+        }
+        order.push_back(entry.first);
+        m_pending.emplace(entry.first, std::move(entry.second));
+    }
+    order.insert(order.end(), m_pendingOrder.begin(), m_pendingOrder.end());
+    m_pendingOrder = std::move(order);
+}
+
+void AlertAggregator::scheduleFlush(TimerWheel::Clock::duration p_delay)
+{
+    m_flushScheduled = true;
+    m_flushDue = TimerWheel::Clock::now() + p_delay;
+    m_flushTimer = m_timerWheel.schedule(p_delay, [this]() { flush(); });
+}
+
+void AlertAggregator::notify()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    openWindow();
+}
+
+void AlertAggregator::notify(const std::string& p_handle, CompletionFunction p_done)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_waiting[p_handle].push_back({m_flushes, std::move(p_done)});
+    openWindow();
+}
+
+void AlertAggregator::openWindow()
+{
+    if(!m_flushScheduled)
+    {
+        scheduleFlush(m_config.window);
+        return;
+    }
+    // The scheduled flush may be the retry of a rate limited or rejected state, new transitions do not wait for it.
+    // If the timer fired already, its flush waits for the lock and takes the new transitions along
+    if(TimerWheel::Clock::now() + m_config.window < m_flushDue && m_timerWheel.cancel(m_flushTimer))
+    {
+        scheduleFlush(m_config.window);
+    }
+}
+
+void AlertAggregator::flush()
+{
+    AlertStateChanges outgoing;
+    // Handles and states of the outgoing changes, recorded as published once the commit succeeded
+    std::vector<std::pair<std::string, Pending>> sent;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_flushScheduled = false;
+
+        // Merge the new transitions into the held back ones, only the latest state per handle is kept
+        auto changes = m_alerts->takeChanges();
+        ++m_flushes;
+        m_counters.transitions += changes.conditions.size() + changes.signals.size();
+        const auto merge = [this](const std::string& p_handle, const Pending& p_entry) {
+            const auto it = m_pending.find(p_handle);
+            if(it == m_pending.end())
+            {
+                m_pendingOrder.push_back(p_handle);
+                m_pending.emplace(p_handle, p_entry);
+                return;
+            }
+            ++m_counters.coalesced;
+            const bool suppressed = it->second.suppressed;
+            it->second = p_entry;
+            it->second.suppressed = suppressed;
+        };
+        for(auto& condition : changes.conditions)
+        {
+            merge(condition.handle, Pending{false, condition, {}, false});
+        }
+        for(auto& signal : changes.signals)
+        {
+            merge(signal.handle, Pending{true, {}, signal, false});
+        }
+
+        const auto now = TimerWheel::Clock::now();
+        std::vector<std::string> heldBack;
+        for(const auto& handle : m_pendingOrder)
+        {
+            auto& entry = m_pending[handle];
+            const auto value = valueOf(entry);
+            const auto published = m_published.find(handle);
+            if(published != m_published.end() && published->second == value)
+            {
+                // E.g. a condition that appeared and disappeared again within the window
+                ++m_counters.coalesced;
+                m_pending.erase(handle);
+                continue;
+            }
+            if(!takeToken(handle, now))
+            {
+                if(!entry.suppressed)
+                {
+                    entry.suppressed = true;
+                    ++m_counters.suppressed;
+                }
+                heldBack.push_back(handle);
+                continue;
+            }
+
+            if(entry.isSignal)
+            {
+                outgoing.signals.push_back(entry.signal);
+            }
+            else
+            {
+                outgoing.conditions.push_back(entry.condition);
+            }
+            sent.emplace_back(handle, std::move(entry));
+            m_pending.erase(handle);
+        }
+        m_pendingOrder = std::move(heldBack);
+
+        if(!m_pendingOrder.empty() && !m_flushScheduled)
+        {
+            // Retry as soon as the next token is available
+            const auto retry = std::max<TimerWheel::Clock::duration>(m_config.refillInterval, m_config.window);
+            scheduleFlush(retry);
+        }
+    }
+
+    // Only the wheel thread flushes, so commits happen in order
+    const bool published = outgoing.empty() || m_publish(outgoing);
+
+    std::vector<CompletionFunction> succeeded;
+    std::vector<CompletionFunction> failed;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> sentHandles;
+        for(const auto& entry : sent)
+        {
+            sentHandles.push_back(entry.first);
+        }
+        if(!published)
+        {
+            ++m_counters.failed;
+            requeue(std::move(sent));
+            if(!m_pendingOrder.empty() && !m_flushScheduled)
+            {
+                scheduleFlush(std::max<TimerWheel::Clock::duration>(m_config.refillInterval, m_config.window));
+            }
+        }
+        else if(!outgoing.empty())
+        {
+            ++m_counters.reports;
+            for(const auto& entry : sent)
+            {
+                m_published[entry.first] = valueOf(entry.second);
+            }
+        }
+
+        // Requests whose state this flush took from the engine learn the result of its commit, or succeeded if there
+        // was nothing to publish. Requests made after that wait for the next flush, so do held back states
+        for(auto it = m_waiting.begin(); it != m_waiting.end();)
+        {
+            const bool wasSent = std::find(sentHandles.begin(), sentHandles.end(), it->first) != sentHandles.end();
+            if(!wasSent && m_pending.count(it->first) > 0)
+            {
+                ++it;
+                continue;
+            }
+            auto& waiters = it->second;
+            const auto taken = std::stable_partition(waiters.begin(), waiters.end(), [this](const Waiter& p_waiter) {
+                return p_waiter.flushes >= m_flushes;
+            });
+            for(auto waiter = taken; waiter != waiters.end(); ++waiter)
+            {
+                (wasSent && !published ? failed : succeeded).push_back(std::move(waiter->done));
+            }
+            waiters.erase(taken, waiters.end());
+            it = waiters.empty() ? m_waiting.erase(it) : std::next(it);
+        }
+    }
+    for(const auto& done : succeeded)
+    {
+        done(true);
+    }
+    for(const auto& done : failed)
+    {
+        done(false);
+    }
+}
+
+AlertAggregationCounters AlertAggregator::getCounters()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counters;
+}
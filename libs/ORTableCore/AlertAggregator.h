@@ -0,0 +1,128 @@
+/**
+ * @brief Aggregation stage between the AlertStateEngine and the MDIB. Alert transitions that occur together, e.g. when
+ * a predefined position moves several axes into their limits, are collected for a short window and published in one
+ * commit, so consumers receive one EpisodicAlertReport instead of one per transition.
+ *
+ * Each alert state may publish a burst of transitions, further transitions are rate limited by a token bucket.
+ * A rate limited transition is not lost: it is held back and its latest state is published as soon as the bucket
+ * refills. States that end up where they were last published are not published at all. If the commit is rejected,
+ * its states are queued again and retried, unless a newer state of the same alert is pending by then. A pending retry
+ * does not delay other transitions: notify() moves the flush forward to the end of a new window.
+ *
+ * A remote request waits for the commit of its state: notify() with a completion function learns whether the commit
+ * that carried the state was accepted, or that there was nothing to publish. A held back state keeps it waiting.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "AlertStateEngine.h"
+#include "TimerWheel.h"
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+struct AlertAggregationConfig
+{
+    // Transitions within this time after the first one go into the same report
+    std::chrono::milliseconds window{50};
+    // Transitions per alert state that are published without delay
+    unsigned int burst{3};
+    // One further transition per alert state and interval
+    std::chrono::milliseconds refillInterval{2000};
+};
+
+struct AlertAggregationCounters
+{
+    std::uint64_t transitions{0}; // changed states taken from the engine
+    std::uint64_t reports{0};     // commits, i.e. EpisodicAlertReports
+    std::uint64_t coalesced{0};   // transitions replaced by a later one before publishing or ending in the published state
+    std::uint64_t suppressed{0};  // transitions held back by the rate limit
+    std::uint64_t failed{0};      // rejected commits, their states are retried
+};
+
+class AlertAggregator
+{
+public:
+    // Commits the given states in one update. Called on the timer wheel thread
+    using PublishFunction = std::function<bool(const AlertStateChanges& p_changes)>;
+    // Result of the commit of a requested state, called on the timer wheel thread without the aggregator locked
+    using CompletionFunction = std::function<void(bool p_published)>;
+
+private:
+    struct Bucket
+    {
+        double tokens;
+        TimerWheel::Clock::time_point lastRefill;
+    };
+
+    struct Pending
+    {
+        bool isSignal;
+        AlertStateChanges::Condition condition;
+        AlertStateChanges::Signal signal;
+        bool suppressed;
+    };
+
+    struct Waiter
+    {
+        // Flushes that took the changes of the engine before the request, see flush()
+        std::uint64_t flushes;
+        CompletionFunction done;
+    };
+
+    std::shared_ptr<AlertStateEngine> m_alerts;
+    TimerWheel& m_timerWheel;
+    const AlertAggregationConfig m_config;
+    PublishFunction m_publish;
+
+    std::mutex m_mutex;
+    bool m_flushScheduled{false};
+    TimerWheel::TimerId m_flushTimer{TimerWheel::INVALID_TIMER};
+    TimerWheel::Clock::time_point m_flushDue;
+    std::vector<std::string> m_pendingOrder;
+    std::unordered_map<std::string, Pending> m_pending;
+    // Last value per handle the MDIB accepted, see valueOf()
+    std::unordered_map<std::string, int> m_published;
+    std::unordered_map<std::string, Bucket> m_buckets;
+    std::uint64_t m_flushes{0};
+    std::unordered_map<std::string, std::vector<Waiter>> m_waiting;
+    AlertAggregationCounters m_counters;
+
+    static int valueOf(const Pending& p_entry);
+    bool takeToken(const std::string& p_handle, TimerWheel::Clock::time_point p_now);
+    void returnToken(const std::string& p_handle);
+    bool isKnown(const std::string& p_handle, bool p_isSignal) const;
+    // Puts the states of a rejected commit back in front of the pending ones
+    void requeue(std::vector<std::pair<std::string, Pending>> p_entries);
+    void scheduleFlush(TimerWheel::Clock::duration p_delay);
+    // Opens an aggregation window, the caller holds m_mutex
+    void openWindow();
+    void flush();
+
+public:
+    AlertAggregator(std::shared_ptr<AlertStateEngine> p_alerts,
+                    TimerWheel& p_timerWheel,
+                    AlertAggregationConfig p_config,
+                    PublishFunction p_publish);
+    ~AlertAggregator();
+
+    AlertAggregator(const AlertAggregator&) = delete;
+    AlertAggregator& operator=(const AlertAggregator&) = delete;
+
+    // Call after changing the engine. Opens an aggregation window unless a flush is scheduled before its end
+    void notify();
+    // Same, p_done is called with the result of the commit that carries the state of the given alert
+    void notify(const std::string& p_handle, CompletionFunction p_done);
+
+    AlertAggregationCounters getCounters();
+};
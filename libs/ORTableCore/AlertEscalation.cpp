@@ -0,0 +1,144 @@
+#include "AlertEscalation.h"
+
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+
+void EscalationTable::add(const std::string& p_conditionHandle, EscalationStep p_step)
+{
+    auto& steps = m_steps[p_conditionHandle];
+    const auto position = std::upper_bound(
+        steps.begin(), steps.end(), p_step, [](const EscalationStep& p_lhs, const EscalationStep& p_rhs) {
+            return p_lhs.delay < p_rhs.delay;
+        });
+    steps.insert(position, p_step);
+}
+
+const std::vector<EscalationStep>& EscalationTable::getSteps(const std::string& p_conditionHandle) const
+{
+    static const std::vector<EscalationStep> NO_STEPS;
+    const auto it = m_steps.find(p_conditionHandle);
+    return it != m_steps.end() ? it->second : NO_STEPS;
+}
+
+std::size_t EscalationTable::size() const
+{
+    return m_steps.size();
+}
+
+bool EscalationTable::loadFile(const std::string& p_path, std::string& p_error)
+{
+    std::ifstream file(p_path);
+    if(!file)
+    {
+        p_error = "0: cannot open " + p_path;
+        return false;
+    }
+
+    std::string line;
+    std::size_t lineNumber{0};
+    while(std::getline(file, line))
+    {
+        ++lineNumber;
+        std::istringstream stream(line);
+        std::string handle;
+        if(!(stream >> handle) || handle[0] == '#')
+        {
+            continue;
+        }
+
+        double seconds{0};
+        std::string priorityName;
+        AlertPriority priority;
+        if(!(stream >> seconds >> priorityName) || seconds < 0)
+        {
+            p_error = std::to_string(lineNumber) + ": expected \"<handle> <seconds> <priority>\"";
+            return false;
+        }
+        if(!AlertStateEngine::fromString(priorityName, priority))
+        {
+            p_error = std::to_string(lineNumber) + ": unknown priority " + priorityName;
+            return false;
+        }
+        add(handle, {std::chrono::milliseconds(static_cast<long long>(seconds * 1000)), priority});
+    }
+    return true;
+}
+
+AlertEscalator::AlertEscalator(std::shared_ptr<AlertStateEngine> p_alerts,
+                               const EscalationTable& p_table,
+                               TimerWheel& p_timerWheel,
+                               EscalationCallback p_onEscalation)
+    : m_alerts(std::move(p_alerts))
+    , m_table(p_table)
+    , m_timerWheel(p_timerWheel)
+    , m_onEscalation(std::move(p_onEscalation))
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    addConditions();
+}
+
+AlertEscalator::~AlertEscalator()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(const auto& timers : m_timers)
+    {
+        for(const auto timer : timers)
+        {
+            m_timerWheel.cancel(timer);
+        }
+    }
+}
+
+void AlertEscalator::addConditions()
+{
+    // Ids of the engine are stable, so only the conditions beyond the known ones are new
+    const auto count = m_alerts->conditionCount();
+    for(auto condition = static_cast<std::uint32_t>(m_steps.size()); condition < count; ++condition)
+    {
+        m_steps.push_back(m_table.getSteps(m_alerts->getConditionHandle(condition)));
+    }
+    m_timers.resize(count);
+    m_generations.resize(count, 0);
+}
+
+void AlertEscalator::onMdibReloaded()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    addConditions();
+}
+
+void AlertEscalator::onConditionPresence(std::uint32_t p_condition, bool p_present)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& timers = m_timers.at(p_condition);
+    for(const auto timer : timers)
+    {
+        m_timerWheel.cancel(timer);
+    }
+    timers.clear();
+    const auto generation = ++m_generations[p_condition];
+    if(!p_present)
+    {
+        return;
+    }
+
+    for(const auto& step : m_steps[p_condition])
+    {
+        const auto priority = step.priority;
+        timers.push_back(m_timerWheel.schedule(step.delay, [this, p_condition, generation, priority]() {
+            {
+                // A timer that fired while the condition disappeared (and maybe returned) belongs to an old episode
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_generations[p_condition] != generation || !m_alerts->escalate(p_condition, priority))
+                {
+                    return;
+                }
+            }
+            if(m_onEscalation)
+            {
+                m_onEscalation();
+            }
+        }));
+    }
+}
@@ -0,0 +1,85 @@
+/**
+ * @brief Time based escalation of alert conditions. An escalation table lists per condition the steps
+ * "after N seconds of presence, raise the actual priority to P". When a condition becomes present, one timer per
+ * step is put on a TimerWheel; when it disappears, the pending timers are cancelled. Escalation therefore happens
+ * at the configured time and not at the next run of the update loop.
+ *
+ * Table files have one step per line: "<condition handle> <seconds> <None|Lo|Me|Hi>". Empty lines and lines
+ * starting with '#' are ignored.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "AlertStateEngine.h"
+#include "TimerWheel.h"
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct EscalationStep
+{
+    std::chrono::milliseconds delay;
+    AlertPriority priority;
+};
+
+class EscalationTable
+{
+private:
+    std::unordered_map<std::string, std::vector<EscalationStep>> m_steps;
+
+public:
+    void add(const std::string& p_conditionHandle, EscalationStep p_step);
+    // Steps of the condition ordered by delay, empty for conditions without escalation
+    const std::vector<EscalationStep>& getSteps(const std::string& p_conditionHandle) const;
+    std::size_t size() const;
+
+    // Adds the steps of a table file. On errors p_error is set to "line: message" and false is returned
+    bool loadFile(const std::string& p_path, std::string& p_error);
+};
+
+class AlertEscalator
+{
+public:
+    // Called on the wheel thread after a condition was escalated, e.g. to publish the changes
+    using EscalationCallback = std::function<void()>;
+
+private:
+    std::shared_ptr<AlertStateEngine> m_alerts;
+    const EscalationTable m_table;
+    TimerWheel& m_timerWheel;
+    EscalationCallback m_onEscalation;
+
+    // Per condition id of the engine
+    std::vector<std::vector<EscalationStep>> m_steps;
+    std::mutex m_mutex;
+    std::vector<std::vector<TimerWheel::TimerId>> m_timers;
+    // Counts the presence changes, so timers of an earlier episode of the condition are recognized
+    std::vector<std::uint64_t> m_generations;
+
+    // Needs the lock
+    void addConditions();
+
+public:
+    AlertEscalator(std::shared_ptr<AlertStateEngine> p_alerts,
+                   const EscalationTable& p_table,
+                   TimerWheel& p_timerWheel,
+                   EscalationCallback p_onEscalation);
+    ~AlertEscalator();
+
+    AlertEscalator(const AlertEscalator&) = delete;
+    AlertEscalator& operator=(const AlertEscalator&) = delete;
+
+    // Report every presence change of a condition, i.e. whenever AlertStateEngine::setConditionPresence returned true
+    void onConditionPresence(std::uint32_t p_condition, bool p_present);
+
+    // Takes over the conditions added by AlertStateEngine::reload(), call it right after the reload
+    void onMdibReloaded();
+};
@@ -0,0 +1,429 @@
+#include "AlertStateEngine.h"
+
+#include <algorithm>
+
+constexpr std::uint32_t AlertStateEngine::NO_ENTRY;
+
+namespace
+{
+    bool isTrue(const MdibDescriptor& p_descriptor, const char* p_attribute)
+    {
+        const auto it = std::find_if(p_descriptor.attributes.begin(),
+                                     p_descriptor.attributes.end(),
+                                     [p_attribute](const MdibAttribute& p_entry) { return p_entry.first == p_attribute; });
+        return it != p_descriptor.attributes.end() && (it->second == "true" || it->second == "1");
+    }
+
+    AlertPriority priorityOf(const MdibDescriptor& p_descriptor)
+    {
+        auto priority = AlertPriority::None;
+        for(const auto& attribute : p_descriptor.attributes)
+        {
+            if(attribute.first == "Priority")
+            {
+                AlertStateEngine::fromString(attribute.second, priority);
+            }
+        }
+        return priority;
+    }
+
+    // Removed entries are only found while reloading, to take them back if their descriptor returns
+    template<typename Entry, typename Entries>
+    std::uint32_t findEntry(const std::vector<Entry>& p_ids,
+                            const Entries& p_entries,
+                            ORTable::StringView p_handle,
+                            bool p_includeRemoved = false)
+    {
+        const auto hash = MdibIndex::hashHandle(p_handle);
+        auto it = std::lower_bound(p_ids.begin(), p_ids.end(), hash, [](const Entry& p_entry, std::uint64_t p_hash) {
+            return p_entry.hash < p_hash;
+        });
+        for(; it != p_ids.end() && it->hash == hash; ++it)
+        {
+            if(p_entries[it->id].handle == p_handle)
+            {
+                return (p_includeRemoved || !p_entries[it->id].removed) ? it->id : AlertStateEngine::NO_ENTRY;
+            }
+        }
+        return AlertStateEngine::NO_ENTRY;
+    }
+
+    template<typename Entry>
+    void sortByHash(std::vector<Entry>& p_ids)
+    {
+        std::sort(p_ids.begin(), p_ids.end(), [](const Entry& p_lhs, const Entry& p_rhs) {
+            return p_lhs.hash < p_rhs.hash || (p_lhs.hash == p_rhs.hash && p_lhs.id < p_rhs.id);
+        });
+    }
+} // namespace
+
+AlertRequestResult::AlertRequestResult(std::string p_error)
+    : m_error(std::move(p_error))
+{
+}
+
+bool AlertRequestResult::success() const
+{
+    return m_error.empty();
+}
+
+const std::string& AlertRequestResult::getError() const
+{
+    return m_error;
+}
+
+AlertStateEngine::AlertStateEngine(const MdibIndex& p_index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    load(p_index);
+}
+
+void AlertStateEngine::reload(const MdibIndex& p_index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    load(p_index);
+}
+
+void AlertStateEngine::load(const MdibIndex& p_index)
+{
+    // Everything not found in the index again stays removed
+    for(auto& condition : m_conditions)
+    {
+        condition.removed = true;
+        condition.signals.clear();
+    }
+    for(auto& signal : m_signals)
+    {
+        signal.removed = true;
+    }
+
+    const auto& descriptors = p_index.getModel().descriptors;
+    const auto conditionsBefore = m_conditions.size();
+    for(const auto& descriptor : descriptors)
+    {
+        if(descriptor.element != "AlertCondition")
+        {
+            continue;
+        }
+        auto id = findEntry(m_conditionIds, m_conditions, descriptor.handle, true);
+        if(id == NO_ENTRY)
+        {
+            id = static_cast<std::uint32_t>(m_conditions.size());
+            m_conditions.emplace_back();
+            m_conditions.back().handle = descriptor.handle;
+        }
+        auto& condition = m_conditions[id];
+        condition.removed = false;
+        condition.priority = priorityOf(descriptor);
+        if(!condition.present || condition.actualPriority < condition.priority)
+        {
+            condition.actualPriority = condition.priority;
+        }
+    }
+    // Added after the loop, the lookups above need the ids sorted
+    for(auto id = static_cast<std::uint32_t>(conditionsBefore); id < m_conditions.size(); ++id)
+    {
+        m_conditionIds.push_back({MdibIndex::hashHandle(m_conditions[id].handle), id});
+    }
+    sortByHash(m_conditionIds);
+
+    const auto signalsBefore = m_signals.size();
+    for(std::uint32_t i = 0; i < descriptors.size(); ++i)
+    {
+        if(descriptors[i].element != "AlertSignal")
+        {
+            continue;
+        }
+        auto id = findEntry(m_signalIds, m_signals, descriptors[i].handle, true);
+        if(id == NO_ENTRY)
+        {
+            id = static_cast<std::uint32_t>(m_signals.size());
+            m_signals.emplace_back();
+            m_signals.back().handle = descriptors[i].handle;
+        }
+        auto& signal = m_signals[id];
+        signal.removed = false;
+        signal.latching = isTrue(descriptors[i], "Latching");
+        signal.condition = NO_ENTRY;
+        const auto target = p_index.getTarget(i);
+        if(target != MdibIndex::NO_ENTRY)
+        {
+            signal.condition = findEntry(m_conditionIds, m_conditions, descriptors[target].handle);
+        }
+        if(signal.condition != NO_ENTRY)
+        {
+            m_conditions[signal.condition].signals.push_back(id);
+        }
+    }
+    for(auto id = static_cast<std::uint32_t>(signalsBefore); id < m_signals.size(); ++id)
+    {
+        m_signalIds.push_back({MdibIndex::hashHandle(m_signals[id].handle), id});
+    }
+    sortByHash(m_signalIds);
+
+    // Removed states are not in the MDIB anymore, so they are neither kept nor published
+    for(auto& condition : m_conditions)
+    {
+        if(condition.removed)
+        {
+            condition.present = false;
+            condition.actualPriority = condition.priority;
+            condition.dirty = false;
+        }
+    }
+    for(auto& signal : m_signals)
+    {
+        if(signal.removed)
+        {
+            signal.presence = AlertSignalPresence::Off;
+            signal.dirty = false;
+        }
+    }
+    m_dirtyConditions.erase(std::remove_if(m_dirtyConditions.begin(),
+                                           m_dirtyConditions.end(),
+                                           [this](std::uint32_t p_id) { return m_conditions[p_id].removed; }),
+                            m_dirtyConditions.end());
+    m_dirtySignals.erase(std::remove_if(m_dirtySignals.begin(),
+                                        m_dirtySignals.end(),
+                                        [this](std::uint32_t p_id) { return m_signals[p_id].removed; }),
+                         m_dirtySignals.end());
+}
+
+std::uint32_t AlertStateEngine::findCondition(ORTable::StringView p_handle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return findEntry(m_conditionIds, m_conditions, p_handle);
+}
+
+std::uint32_t AlertStateEngine::findSignal(ORTable::StringView p_handle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return findEntry(m_signalIds, m_signals, p_handle);
+}
+
+std::size_t AlertStateEngine::conditionCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_conditions.size();
+}
+
+std::string AlertStateEngine::getConditionHandle(std::uint32_t p_condition) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_conditions.at(p_condition).handle;
+}
+
+std::size_t AlertStateEngine::signalCount() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_signals.size();
+}
+
+bool AlertStateEngine::isConditionPresent(std::uint32_t p_condition) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_conditions.at(p_condition).present;
+}
+
+AlertPriority AlertStateEngine::getActualPriority(std::uint32_t p_condition) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_conditions.at(p_condition).actualPriority;
+}
+
+AlertSignalPresence AlertStateEngine::getSignalPresence(std::uint32_t p_signal) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_signals.at(p_signal).presence;
+}
+
+void AlertStateEngine::setSignalPresence(std::uint32_t p_signal, AlertSignalPresence p_presence)
+{
+    auto& signal = m_signals[p_signal];
+    if(signal.presence == p_presence)
+    {
+        return;
+    }
+    signal.presence = p_presence;
+    if(!signal.dirty)
+    {
+        signal.dirty = true;
+        m_dirtySignals.push_back(p_signal);
+    }
+}
+
+void AlertStateEngine::markConditionDirty(std::uint32_t p_condition)
+{
+    auto& condition = m_conditions[p_condition];
+    if(!condition.dirty)
+    {
+        condition.dirty = true;
+        m_dirtyConditions.push_back(p_condition);
+    }
+}
+
+bool AlertStateEngine::setConditionPresence(std::uint32_t p_condition, bool p_present)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& condition = m_conditions.at(p_condition);
+    if(condition.removed || condition.present == p_present)
+    {
+        return false;
+    }
+    condition.present = p_present;
+    if(!p_present)
+    {
+        condition.actualPriority = condition.priority;
+    }
+    markConditionDirty(p_condition);
+
+    for(const auto id : condition.signals)
+    {
+        const auto& signal = m_signals[id];
+        if(p_present)
+        {
+            // A condition that returns is signaled again, also if it was latched before
+            setSignalPresence(id, AlertSignalPresence::On);
+        }
+        else if(signal.latching && signal.presence == AlertSignalPresence::On)
+        {
+            setSignalPresence(id, AlertSignalPresence::Latched);
+        }
+        else if(signal.presence != AlertSignalPresence::Latched)
+        {
+            setSignalPresence(id, AlertSignalPresence::Off);
+        }
+    }
+    return true;
+}
+
+bool AlertStateEngine::escalate(std::uint32_t p_condition, AlertPriority p_priority)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& condition = m_conditions.at(p_condition);
+    if(condition.removed || !condition.present || p_priority <= condition.actualPriority)
+    {
+        return false;
+    }
+    condition.actualPriority = p_priority;
+    markConditionDirty(p_condition);
+
+    for(const auto id : condition.signals)
+    {
+        if(m_signals[id].presence == AlertSignalPresence::Acknowledged)
+        {
+            setSignalPresence(id, AlertSignalPresence::On);
+        }
+    }
+    return true;
+}
+
+AlertRequestResult AlertStateEngine::requestSignalPresence(const std::string& p_handle, AlertSignalPresence p_requested)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto id = findEntry(m_signalIds, m_signals, p_handle);
+    if(id == NO_ENTRY)
+    {
+        return AlertRequestResult("Unknown alert signal " + p_handle);
+    }
+
+    const auto& signal = m_signals[id];
+    const bool conditionPresent = signal.condition != NO_ENTRY && m_conditions[signal.condition].present;
+    switch(p_requested)
+    {
+        case AlertSignalPresence::Acknowledged:
+            // Acknowledging a latched signal clears it, its cause is gone already.
+            // Repeated acknowledgements are accepted, several consumers may acknowledge the same signal
+            if(signal.presence == AlertSignalPresence::On)
+            {
+                setSignalPresence(id, AlertSignalPresence::Acknowledged);
+            }
+            else if(signal.presence == AlertSignalPresence::Latched)
+            {
+                setSignalPresence(id, AlertSignalPresence::Off);
+            }
+            return AlertRequestResult();
+
+        case AlertSignalPresence::Off:
+            if(conditionPresent)
+            {
+                return AlertRequestResult("Alert condition of " + p_handle + " is still present");
+            }
+            setSignalPresence(id, AlertSignalPresence::Off);
+            return AlertRequestResult();
+
+        case AlertSignalPresence::On:
+        case AlertSignalPresence::Latched:
+            break;
+    }
+    return AlertRequestResult(std::string("Presence ") + toString(p_requested) + " cannot be requested for " + p_handle);
+}
+
+AlertStateChanges AlertStateEngine::takeChanges()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    AlertStateChanges changes;
+    changes.conditions.reserve(m_dirtyConditions.size());
+    changes.signals.reserve(m_dirtySignals.size());
+
+    for(const auto id : m_dirtyConditions)
+    {
+        auto& condition = m_conditions[id];
+        condition.dirty = false;
+        changes.conditions.push_back({condition.handle, condition.present, condition.actualPriority});
+    }
+    for(const auto id : m_dirtySignals)
+    {
+        auto& signal = m_signals[id];
+        signal.dirty = false;
+        changes.signals.push_back({signal.handle, signal.presence});
+    }
+    m_dirtyConditions.clear();
+    m_dirtySignals.clear();
+    return changes;
+}
+
+const char* AlertStateEngine::toString(AlertSignalPresence p_presence)
+{
+    switch(p_presence)
+    {
+        case AlertSignalPresence::On:
+            return "On";
+        case AlertSignalPresence::Off:
+            return "Off";
+        case AlertSignalPresence::Latched:
+            return "Latch";
+        case AlertSignalPresence::Acknowledged:
+            return "Ack";
+    }
+    return "";
+}
+
+const char* AlertStateEngine::toString(AlertPriority p_priority)
+{
+    switch(p_priority)
+    {
+        case AlertPriority::None:
+            return "None";
+        case AlertPriority::Lo:
+            return "Lo";
+        case AlertPriority::Me:
+            return "Me";
+        case AlertPriority::Hi:
+            return "Hi";
+    }
+    return "";
+}
+
+bool AlertStateEngine::fromString(const std::string& p_name, AlertPriority& p_priority)
+{
+    for(const auto priority : {AlertPriority::None, AlertPriority::Lo, AlertPriority::Me, AlertPriority::Hi})
+    {
+        if(p_name == toString(priority))
+        {
+            p_priority = priority;
+            return true;
+        }
+    }
+    return false;
+}
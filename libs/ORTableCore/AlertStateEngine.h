@@ -0,0 +1,183 @@
+/**
+ * @brief Keeps the presence of all alert conditions and signals of the MDIB and applies the latching and
+ * acknowledgement rules of BICEPS to them:
+ * - a signal is On while its condition is present, unless it was acknowledged
+ * - a latching signal whose condition disappears stays Latched until it is acknowledged or switched off
+ * - a non-latching signal follows its condition
+ * - the actual priority of a condition can be raised while it is present (escalation) and falls back to the
+ *   priority of its descriptor when it disappears
+ *
+ * Handles are resolved to dense ids by a binary search over their sorted hashes, which is O(log n) in the number of
+ * alerts. Work on a resolved id is O(1), so callers that keep the id only pay the lookup once.
+ * Ids stay valid when the MDIB is reloaded: alerts that remain keep their id and state, new ones get new ids and
+ * removed ones are ignored from then on.
+ * Every change marks its state dirty; takeChanges() hands out exactly the states changed since the last call,
+ * so they can be published in one commit.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibIndex.h"
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Mirrors pm:AlertSignalPresence
+enum class AlertSignalPresence
+{
+    On,
+    Off,
+    Latched,
+    Acknowledged
+};
+
+// Mirrors pm:AlertConditionPriority, ordered by urgency
+enum class AlertPriority
+{
+    None,
+    Lo,
+    Me,
+    Hi
+};
+
+struct AlertStateChanges
+{
+    struct Condition
+    {
+        std::string handle;
+        bool present;
+        AlertPriority actualPriority;
+    };
+    struct Signal
+    {
+        std::string handle;
+        AlertSignalPresence presence;
+    };
+
+    std::vector<Condition> conditions;
+    std::vector<Signal> signals;
+
+    bool empty() const { return conditions.empty() && signals.empty(); }
+};
+
+class AlertRequestResult
+{
+private:
+    std::string m_error;
+
+public:
+    AlertRequestResult() = default;
+    explicit AlertRequestResult(std::string p_error);
+
+    bool success() const;
+    const std::string& getError() const;
+};
+
+class AlertStateEngine
+{
+public:
+    static constexpr std::uint32_t NO_ENTRY{0xFFFFFFFF};
+
+private:
+    struct Condition
+    {
+        std::string handle;
+        bool present{false};
+        AlertPriority priority{AlertPriority::None};
+        AlertPriority actualPriority{AlertPriority::None};
+        bool dirty{false};
+        // No longer in the MDIB, the id is kept but the condition does not change anymore
+        bool removed{false};
+        std::vector<std::uint32_t> signals;
+    };
+
+    struct Signal
+    {
+        std::string handle;
+        std::uint32_t condition{NO_ENTRY};
+        bool latching{false};
+        AlertSignalPresence presence{AlertSignalPresence::Off};
+        bool dirty{false};
+        bool removed{false};
+    };
+
+    mutable std::mutex m_mutex;
+
+    // Sorted by the hash of the handle, so a lookup needs neither a std::string nor a node walk
+    struct HandleEntry
+    {
+        std::uint64_t hash;
+        std::uint32_t id;
+    };
+
+    std::vector<Condition> m_conditions;
+    std::vector<Signal> m_signals;
+    std::vector<HandleEntry> m_conditionIds;
+    std::vector<HandleEntry> m_signalIds;
+
+    // Ids of the states changed since the last takeChanges(), each listed once
+    std::vector<std::uint32_t> m_dirtyConditions;
+    std::vector<std::uint32_t> m_dirtySignals;
+
+    void setSignalPresence(std::uint32_t p_signal, AlertSignalPresence p_presence);
+    void markConditionDirty(std::uint32_t p_condition);
+    void load(const MdibIndex& p_index);
+
+public:
+    // Collects the AlertCondition and AlertSignal descriptors of the index. All presences start as Off
+    explicit AlertStateEngine(const MdibIndex& p_index);
+
+    /**
+     * @brief Takes over the alert descriptors of a reloaded MDIB. Conditions and signals that remain keep their id,
+     * presence and pending changes, the priority and latching of their descriptors are updated. New ones start as
+     * Off, removed ones drop their pending changes and are unknown to the find methods from then on.
+     */
+    void reload(const MdibIndex& p_index);
+
+    std::uint32_t findCondition(ORTable::StringView p_handle) const;
+    std::uint32_t findSignal(ORTable::StringView p_handle) const;
+
+    // Including removed ones, ids are below the count
+    std::size_t conditionCount() const;
+    std::string getConditionHandle(std::uint32_t p_condition) const;
+    std::size_t signalCount() const;
+
+    bool isConditionPresent(std::uint32_t p_condition) const;
+    AlertPriority getActualPriority(std::uint32_t p_condition) const;
+    AlertSignalPresence getSignalPresence(std::uint32_t p_signal) const;
+
+    /**
+     * @brief Reports the evaluated presence of a condition, e.g. from a limit check. Its signals follow according to
+     * the latching rules. Reporting an unchanged presence does nothing.
+     * @return true if the presence changed
+     */
+    bool setConditionPresence(std::uint32_t p_condition, bool p_present);
+
+    /**
+     * @brief Raises the actual priority of a present condition. Acknowledged signals of the condition are switched
+     * on again, the raised priority needs new attention. Lowering the priority or escalating an absent
+     * condition does nothing.
+     * @return true if the priority was raised
+     */
+    bool escalate(std::uint32_t p_condition, AlertPriority p_priority);
+
+    /**
+     * @brief Applies a SetAlertState request for a signal. Accepted requests are Acknowledged (for On and Latched
+     * signals) and Off (for Latched signals and signals without present condition). On and Latched can only be
+     * caused by the condition and are rejected, just like requests for unknown handles.
+     */
+    AlertRequestResult requestSignalPresence(const std::string& p_handle, AlertSignalPresence p_requested);
+
+    // Hands out the states changed since the last call and clears the change list
+    AlertStateChanges takeChanges();
+
+    static const char* toString(AlertSignalPresence p_presence);
+    static const char* toString(AlertPriority p_priority);
+    // "None", "Lo", "Me" or "Hi"
+    static bool fromString(const std::string& p_name, AlertPriority& p_priority);
+};
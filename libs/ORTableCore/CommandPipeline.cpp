@@ -0,0 +1,171 @@
+#include "CommandPipeline.h"
+
+#include <algorithm>
+
+using namespace ORTable;
+
+CommandPipeline::CommandPipeline(TimerWheel& p_timerWheel, CommandPipelineConfig p_config, SendFunction p_send)
+    : m_timerWheel(p_timerWheel)
+    , m_config(std::move(p_config))
+    , m_send(std::move(p_send))
+{
+    m_outstanding.reserve(m_config.window);
+}
+
+CommandPipeline::~CommandPipeline()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(const auto& entry : m_outstanding)
+    {
+        m_timerWheel.cancel(entry.second.timeout);
+    }
+}
+
+void CommandPipeline::count(CommandResult p_result)
+{
+    switch(p_result)
+    {
+        case CommandResult::Done:
+            ++m_counters.done;
+            break;
+        case CommandResult::Rejected:
+            ++m_counters.rejected;
+            break;
+        case CommandResult::Failed:
+            ++m_counters.failed;
+            break;
+    }
+}
+
+void CommandPipeline::fillWindow(std::vector<Completion>& p_completions)
+{
+    while(!m_queue.empty() && m_outstanding.size() < std::max<std::size_t>(m_config.window, 1))
+    {
+        auto command = std::move(m_queue.front());
+        m_queue.pop_front();
+
+        // Sequence numbers wrap, skip any still in use by a long running command
+        auto sequence = m_nextSequence++;
+        while(m_outstanding.count(sequence) > 0)
+        {
+            sequence = m_nextSequence++;
+        }
+
+        // Before sending, so the transaction is started before its acknowledgement can complete it
+        if(command.onStart)
+        {
+            command.onStart();
+        }
+        if(!m_send(command.command, sequence))
+        {
+            count(CommandResult::Failed);
+            p_completions.push_back({std::move(command.onCompletion), CommandResult::Failed});
+            continue;
+        }
+        const auto duration = m_config.movementTime ? m_config.timeout + m_config.movementTime(command.command) : m_config.timeout;
+        const auto timeout = m_timerWheel.schedule(duration, [this, sequence]() { onTimeout(sequence); });
+        m_outstanding.emplace(sequence, Outstanding{std::move(command.onCompletion), timeout});
+    }
+}
+
+void CommandPipeline::notify(const std::vector<Completion>& p_completions)
+{
+    for(const auto& completion : p_completions)
+    {
+        if(completion.onCompletion)
+        {
+            completion.onCompletion(completion.result);
+        }
+    }
+}
+
+void CommandPipeline::submit(const TableCommand& p_command, StartFunction p_onStart, CompletionFunction p_onCompletion)
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        ++m_counters.submitted;
+        m_queue.push_back({p_command, std::move(p_onStart), std::move(p_onCompletion)});
+        fillWindow(completions);
+    }
+    notify(completions);
+}
+
+void CommandPipeline::onAck(std::uint16_t p_sequence, AckStatus p_status)
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_outstanding.find(p_sequence);
+        if(it == m_outstanding.end())
+        {
+            ++m_counters.unmatchedAcks;
+            return;
+        }
+        const auto result = p_status == AckStatus::Done ? CommandResult::Done
+                                                        : (p_status == AckStatus::Rejected ? CommandResult::Rejected : CommandResult::Failed);
+        m_timerWheel.cancel(it->second.timeout);
+        count(result);
+        completions.push_back({std::move(it->second.onCompletion), result});
+        m_outstanding.erase(it);
+        fillWindow(completions);
+    }
+    notify(completions);
+}
+
+void CommandPipeline::onTimeout(std::uint16_t p_sequence)
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto it = m_outstanding.find(p_sequence);
+        if(it == m_outstanding.end())
+        {
+            return;
+        }
+        count(CommandResult::Failed);
+        completions.push_back({std::move(it->second.onCompletion), CommandResult::Failed});
+        m_outstanding.erase(it);
+        fillWindow(completions);
+    }
+    notify(completions);
+}
+
+void CommandPipeline::onConnectionLost()
+{
+    std::vector<Completion> completions;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for(auto& entry : m_outstanding)
+        {
+            m_timerWheel.cancel(entry.second.timeout);
+            count(CommandResult::Failed);
+            completions.push_back({std::move(entry.second.onCompletion), CommandResult::Failed});
+        }
+        m_outstanding.clear();
+        for(auto& command : m_queue)
+        {
+            // The completion of a command expects it to be started, as if it had been sent
+            if(command.onStart)
+            {
+                command.onStart();
+            }
+            count(CommandResult::Failed);
+            completions.push_back({std::move(command.onCompletion), CommandResult::Failed});
+        }
+        m_queue.clear();
+    }
+    notify(completions);
+}
+
+std::size_t CommandPipeline::outstanding()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_outstanding.size();
+}
+
+CommandPipelineCounters CommandPipeline::getCounters()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counters;
+}
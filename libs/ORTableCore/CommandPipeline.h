@@ -0,0 +1,120 @@
+/**
+ * @brief Pipelined command channel to the table controller. Commands are numbered and up to a window of them are
+ * outstanding at the same time, so a burst of jog activates is not serialized on the round trip of the serial line.
+ * The controller acknowledges commands when their movement is complete, i.e. in any order; each acknowledgement is
+ * matched to its command by the sequence number and completes exactly that command.
+ *
+ * Commands beyond the window wait in submission order. Commands without acknowledgement fail after a timeout that
+ * covers their movement, outstanding and queued commands fail at once when the connection is lost. Queued commands
+ * are started before they fail, so every completion follows the start of its command.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "TableProtocol.h"
+#include "TimerWheel.h"
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+enum class CommandResult
+{
+    Done,
+    Rejected,
+    // No acknowledgement within the timeout, connection lost or not connected
+    Failed
+};
+
+struct CommandPipelineConfig
+{
+    using MovementTime = std::function<std::chrono::milliseconds(const ORTable::TableCommand& p_command)>;
+
+    std::size_t window{8};
+    // Time for the acknowledgement of a command on top of its movement
+    std::chrono::milliseconds timeout{10000};
+    // Longest time the movement of a command may take, added to its timeout. Empty for commands without movement time
+    MovementTime movementTime;
+};
+
+struct CommandPipelineCounters
+{
+    std::uint64_t submitted{0};
+    std::uint64_t done{0};
+    std::uint64_t rejected{0};
+    std::uint64_t failed{0};
+    // Acknowledgements without outstanding command, e.g. after a timeout
+    std::uint64_t unmatchedAcks{0};
+};
+
+class CommandPipeline
+{
+public:
+    // Hands a command to the line, returns false if it could not be queued. Called with the pipeline locked
+    using SendFunction = std::function<bool(const ORTable::TableCommand& p_command, std::uint16_t p_sequence)>;
+    // Called with the pipeline locked when the command leaves the queue, right before it is sent
+    using StartFunction = std::function<void()>;
+    // Called exactly once per command
+    using CompletionFunction = std::function<void(CommandResult p_result)>;
+
+private:
+    struct Command
+    {
+        ORTable::TableCommand command;
+        StartFunction onStart;
+        CompletionFunction onCompletion;
+    };
+
+    struct Outstanding
+    {
+        CompletionFunction onCompletion;
+        TimerWheel::TimerId timeout;
+    };
+
+    // A completion to call after the lock was released
+    struct Completion
+    {
+        CompletionFunction onCompletion;
+        CommandResult result;
+    };
+
+    TimerWheel& m_timerWheel;
+    const CommandPipelineConfig m_config;
+    SendFunction m_send;
+
+    std::mutex m_mutex;
+    std::uint16_t m_nextSequence{1};
+    std::deque<Command> m_queue;
+    std::unordered_map<std::uint16_t, Outstanding> m_outstanding;
+    CommandPipelineCounters m_counters;
+
+    void count(CommandResult p_result);
+    // Sends queued commands while the window has room
+    void fillWindow(std::vector<Completion>& p_completions);
+    void onTimeout(std::uint16_t p_sequence);
+    static void notify(const std::vector<Completion>& p_completions);
+
+public:
+    CommandPipeline(TimerWheel& p_timerWheel, CommandPipelineConfig p_config, SendFunction p_send);
+    ~CommandPipeline();
+
+    CommandPipeline(const CommandPipeline&) = delete;
+    CommandPipeline& operator=(const CommandPipeline&) = delete;
+
+    void submit(const ORTable::TableCommand& p_command, StartFunction p_onStart, CompletionFunction p_onCompletion);
+
+    // Connect to the acknowledgements of the serial line
+    void onAck(std::uint16_t p_sequence, ORTable::AckStatus p_status);
+    // Fails all outstanding and queued commands, the queued ones are started first
+    void onConnectionLost();
+
+    std::size_t outstanding();
+    CommandPipelineCounters getCounters();
+};
@@ -0,0 +1,89 @@
+#include "ContextCompactor.h"
+
+#include "Logging/LogBroker.h"
+
+#include <algorithm>
+
+using namespace Logging;
+
+ContextCompactor::ContextCompactor(std::shared_ptr<ContextStateStore> p_contexts,
+                                   ContextRetentionPolicy p_policy,
+                                   std::size_t p_batchSize,
+                                   std::mutex& p_commitMutex,
+                                   RemoveFunction p_remove)
+    : m_contexts(std::move(p_contexts))
+    , m_policy(std::move(p_policy))
+    , m_batchSize(std::max<std::size_t>(p_batchSize, 1))
+    , m_commitMutex(p_commitMutex)
+    , m_remove(std::move(p_remove))
+{
+}
+
+ContextCompactor::~ContextCompactor()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+std::size_t ContextCompactor::compact(long long p_now)
+{
+    std::size_t removed{0};
+    while(!m_stopRequested)
+    {
+        // The lock is released between batches, so SetContextState requests are not held up by a long compaction
+        std::lock_guard<std::mutex> lock(m_commitMutex);
+        const auto expired = m_contexts->collectExpired(m_policy, p_now, m_batchSize);
+        if(expired.empty())
+        {
+            break;
+        }
+        if(!m_remove(expired))
+        {
+            LogBroker::getInstance().log(LogMessage("ContextCompactor", Severity::Notice, "Removal of expired context states failed"));
+            break;
+        }
+        for(const auto& handle : expired)
+        {
+            m_contexts->remove(handle);
+        }
+        removed += expired.size();
+    }
+    return removed;
+}
+
+void ContextCompactor::run(std::chrono::milliseconds p_interval)
+{
+    m_running = true;
+    m_thread = std::thread([this, p_interval]() {
+        while(m_running)
+        {
+            const auto now = std::chrono::duration_cast<std::chrono::milliseconds>(
+                                 std::chrono::system_clock::now().time_since_epoch())
+                                 .count();
+            const auto removed = compact(static_cast<long long>(now));
+            if(removed > 0)
+            {
+                LogBroker::getInstance().log(LogMessage("ContextCompactor", Severity::Notice, "Removed " + std::to_string(removed) + " expired context states"));
+            }
+
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_wakeUp.wait_for(lock, p_interval, [this]() { return !m_running; });
+        }
+    });
+}
+
+void ContextCompactor::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_running = false;
+        m_stopRequested = true;
+    }
+    m_wakeUp.notify_all();
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
@@ -0,0 +1,68 @@
+/**
+ * @brief Enforces the ContextRetentionPolicy of the provider. Disassociated Patient and Workflow context states would
+ * otherwise accumulate with every patient and workflow, growing the MDIB and every GetContextStates response over
+ * weeks of uptime. The compactor periodically removes the expired states in batches of limited size, so a single
+ * commit never blocks the provider for long, even after the policy was tightened.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "ContextStateStore.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class ContextCompactor
+{
+public:
+    // Removes the given context states from the MDIB in one commit, returns true on success
+    using RemoveFunction = std::function<bool(const std::vector<std::string>& p_handles)>;
+
+private:
+    std::shared_ptr<ContextStateStore> m_contexts;
+    const ContextRetentionPolicy m_policy;
+    const std::size_t m_batchSize;
+    // Shared with the SetContextState handler, a removal is never interleaved with a request
+    std::mutex& m_commitMutex;
+    RemoveFunction m_remove;
+
+    std::atomic<bool> m_running{false};
+    // Ends a running compaction after the current batch
+    std::atomic<bool> m_stopRequested{false};
+    std::mutex m_waitMutex;
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+
+public:
+    ContextCompactor(std::shared_ptr<ContextStateStore> p_contexts,
+                     ContextRetentionPolicy p_policy,
+                     std::size_t p_batchSize,
+                     std::mutex& p_commitMutex,
+                     RemoveFunction p_remove);
+    ~ContextCompactor();
+
+    ContextCompactor(const ContextCompactor&) = delete;
+    ContextCompactor& operator=(const ContextCompactor&) = delete;
+
+    /**
+     * @brief Removes all expired states, one commit per batch. States are only removed from the store once their
+     * removal was committed, a failed commit leaves them for the next run.
+     * @param p_now milliseconds since epoch
+     * @return the number of removed states
+     */
+    std::size_t compact(long long p_now);
+
+    void run(std::chrono::milliseconds p_interval);
+    void stop();
+};
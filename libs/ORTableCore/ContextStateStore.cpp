@@ -0,0 +1,597 @@
+#include "ContextStateStore.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+constexpr std::uint32_t ContextStateStore::NO_ENTRY;
+constexpr std::size_t ContextStateStore::ASSOCIATION_COUNT;
+
+namespace
+{
+    std::size_t indexOf(ContextAssociation p_association)
+    {
+        return static_cast<std::size_t>(p_association);
+    }
+
+    bool isContextDescriptor(const MdibDescriptor& p_descriptor)
+    {
+        const auto& element = p_descriptor.element;
+        return element.size() > 7 && element.compare(element.size() - 7, 7, "Context") == 0 && element != "SystemContext";
+    }
+
+    const std::string* findAttribute(const MdibState& p_state, const char* p_name)
+    {
+        for(const auto& attribute : p_state.attributes)
+        {
+            if(attribute.first == p_name)
+            {
+                return &attribute.second;
+            }
+        }
+        return nullptr;
+    }
+} // namespace
+
+ContextRequestResult ContextRequestResult::ok(std::string p_handle)
+{
+    ContextRequestResult result;
+    result.m_handle = std::move(p_handle);
+    return result;
+}
+
+ContextRequestResult ContextRequestResult::failed(std::string p_error)
+{
+    ContextRequestResult result;
+    result.m_error = std::move(p_error);
+    return result;
+}
+
+bool ContextRequestResult::success() const
+{
+    return m_error.empty();
+}
+
+const std::string& ContextRequestResult::getError() const
+{
+    return m_error;
+}
+
+const std::string& ContextRequestResult::getHandle() const
+{
+    return m_handle;
+}
+
+ContextStateStore::ContextStateStore(const MdibIndex& p_index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    load(p_index);
+}
+
+void ContextStateStore::reload(const MdibIndex& p_index)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    load(p_index);
+}
+
+void ContextStateStore::load(const MdibIndex& p_index)
+{
+    const auto now =
+        std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+    const auto& model = p_index.getModel();
+    std::unordered_map<std::string, std::uint32_t> descriptorIds;
+    std::vector<bool> added;
+    for(const auto& descriptor : model.descriptors)
+    {
+        if(!isContextDescriptor(descriptor))
+        {
+            continue;
+        }
+        const auto known = m_descriptorIds.find(descriptor.handle);
+        if(known != m_descriptorIds.end())
+        {
+            descriptorIds.emplace(descriptor.handle, known->second);
+            continue;
+        }
+        const auto id = static_cast<std::uint32_t>(m_descriptors.size());
+        descriptorIds.emplace(descriptor.handle, id);
+        m_descriptors.emplace_back();
+        m_descriptors.back().handle = descriptor.handle;
+        added.resize(id + 1, false);
+        added[id] = true;
+    }
+
+    // The states of removed descriptors left the MDIB with them. Their slot stays, with empty lists
+    for(const auto& known : m_descriptorIds)
+    {
+        if(descriptorIds.count(known.first) > 0)
+        {
+            continue;
+        }
+        for(auto& list : m_descriptors[known.second].lists)
+        {
+            while(list.newest != NO_ENTRY)
+            {
+                release(list.newest);
+            }
+        }
+    }
+    m_descriptorIds = std::move(descriptorIds);
+
+    // States of known descriptors are kept by the store, the MDIB file only provides the ones of new descriptors
+    for(const auto& state : model.states)
+    {
+        const auto descriptor = m_descriptorIds.find(state.descriptorHandle);
+        if(descriptor == m_descriptorIds.end() || descriptor->second >= added.size() || !added[descriptor->second]
+           || state.handle.empty())
+        {
+            continue;
+        }
+        ContextStateRecord record;
+        record.descriptorHandle = state.descriptorHandle;
+        record.handle = state.handle;
+        const auto association = findAttribute(state, "ContextAssociation");
+        if(association)
+        {
+            fromString(*association, record.association);
+        }
+        const auto startTime = findAttribute(state, "BindingStartTime");
+        record.bindingStartTime = startTime ? std::atoll(startTime->c_str()) : 0;
+        const auto endTime = findAttribute(state, "BindingEndTime");
+        record.bindingEndTime = endTime ? std::atoll(endTime->c_str()) : 0;
+
+        // States of the MDIB are published already
+        const auto entry = insert(std::move(record), descriptor->second, now);
+        m_entries[entry].dirty = false;
+        m_dirty.pop_back();
+    }
+}
+
+ContextStateStore::List& ContextStateStore::listOf(const Entry& p_entry)
+{
+    return m_descriptors[p_entry.descriptor].lists[indexOf(p_entry.record.association)];
+}
+
+void ContextStateStore::linkAt(std::uint32_t p_entry, std::uint32_t p_previous, std::uint32_t p_next)
+{
+    auto& entry = m_entries[p_entry];
+    auto& list = listOf(entry);
+    entry.previous = p_previous;
+    entry.next = p_next;
+    if(p_previous != NO_ENTRY)
+    {
+        m_entries[p_previous].next = p_entry;
+    }
+    else
+    {
+        list.newest = p_entry;
+    }
+    if(p_next != NO_ENTRY)
+    {
+        m_entries[p_next].previous = p_entry;
+    }
+    else
+    {
+        list.oldest = p_entry;
+    }
+    ++list.size;
+}
+
+void ContextStateStore::link(std::uint32_t p_entry)
+{
+    linkAt(p_entry, NO_ENTRY, listOf(m_entries[p_entry]).newest);
+}
+
+void ContextStateStore::unlink(std::uint32_t p_entry)
+{
+    auto& entry = m_entries[p_entry];
+    auto& list = listOf(entry);
+    if(entry.previous != NO_ENTRY)
+    {
+        m_entries[entry.previous].next = entry.next;
+    }
+    else
+    {
+        list.newest = entry.next;
+    }
+    if(entry.next != NO_ENTRY)
+    {
+        m_entries[entry.next].previous = entry.previous;
+    }
+    else
+    {
+        list.oldest = entry.previous;
+    }
+    entry.previous = NO_ENTRY;
+    entry.next = NO_ENTRY;
+    --list.size;
+}
+
+void ContextStateStore::markDirty(std::uint32_t p_entry)
+{
+    auto& entry = m_entries[p_entry];
+    if(!entry.dirty)
+    {
+        entry.dirty = true;
+        m_dirty.push_back(p_entry);
+    }
+}
+
+std::uint32_t ContextStateStore::insert(ContextStateRecord p_record, std::uint32_t p_descriptor, long long p_now)
+{
+    std::uint32_t id;
+    if(!m_freeEntries.empty())
+    {
+        id = m_freeEntries.back();
+        m_freeEntries.pop_back();
+    }
+    else
+    {
+        id = static_cast<std::uint32_t>(m_entries.size());
+        m_entries.emplace_back();
+    }
+    auto& entry = m_entries[id];
+    entry.record = std::move(p_record);
+    entry.descriptor = p_descriptor;
+    entry.firstSeen = p_now;
+
+    m_handles.emplace(entry.record.handle, id);
+    link(id);
+    markDirty(id);
+    return id;
+}
+
+void ContextStateStore::setAssociation(std::uint32_t p_entry, ContextAssociation p_association, long long p_now)
+{
+    auto& entry = m_entries[p_entry];
+    if(entry.record.association == p_association)
+    {
+        return;
+    }
+    if(m_recording)
+    {
+        m_undo.push_back({p_entry, false, entry.record, entry.previous, entry.next});
+    }
+    unlink(p_entry);
+    if(p_association == ContextAssociation::Associated)
+    {
+        entry.record.bindingStartTime = p_now;
+        entry.record.bindingEndTime = 0;
+    }
+    else if(p_association == ContextAssociation::Disassociated && entry.record.association == ContextAssociation::Associated)
+    {
+        entry.record.bindingEndTime = p_now;
+    }
+    entry.record.association = p_association;
+    link(p_entry);
+    markDirty(p_entry);
+}
+
+void ContextStateStore::release(std::uint32_t p_entry)
+{
+    auto& entry = m_entries[p_entry];
+    unlink(p_entry);
+    if(entry.dirty)
+    {
+        m_dirty.erase(std::find(m_dirty.begin(), m_dirty.end(), p_entry));
+    }
+    m_handles.erase(entry.record.handle);
+    entry = Entry();
+    m_freeEntries.push_back(p_entry);
+}
+
+std::string ContextStateStore::makeHandle(Descriptor& p_descriptor)
+{
+    // Handles share one namespace with the descriptors, skip numbers that are taken already
+    std::string handle;
+    do
+    {
+        handle = p_descriptor.handle + "_" + std::to_string(p_descriptor.nextHandleNumber++);
+    } while(m_handles.count(handle) > 0);
+    return handle;
+}
+
+bool ContextStateStore::hasDescriptor(const std::string& p_descriptorHandle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_descriptorIds.count(p_descriptorHandle) > 0;
+}
+
+ContextRequestResult ContextStateStore::validate(const std::string& p_descriptorHandle, const std::string& p_handle) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto descriptor = m_descriptorIds.find(p_descriptorHandle);
+    if(descriptor == m_descriptorIds.end())
+    {
+        return ContextRequestResult::failed("Unknown context descriptor " + p_descriptorHandle);
+    }
+    if(p_handle.empty() || p_handle == p_descriptorHandle)
+    {
+        return ContextRequestResult::ok(p_handle);
+    }
+
+    const auto entry = m_handles.find(p_handle);
+    if(entry == m_handles.end())
+    {
+        return ContextRequestResult::failed("Unknown context state " + p_handle);
+    }
+    if(m_entries[entry->second].descriptor != descriptor->second)
+    {
+        return ContextRequestResult::failed("Context state " + p_handle + " does not belong to " + p_descriptorHandle);
+    }
+    return ContextRequestResult::ok(p_handle);
+}
+
+ContextRequestResult ContextStateStore::apply(const std::string& p_descriptorHandle,
+                                              const std::string& p_handle,
+                                              ContextAssociation p_association,
+                                              long long p_now)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto descriptorIt = m_descriptorIds.find(p_descriptorHandle);
+    if(descriptorIt == m_descriptorIds.end())
+    {
+        return ContextRequestResult::failed("Unknown context descriptor " + p_descriptorHandle);
+    }
+    const auto descriptor = descriptorIt->second;
+
+    std::uint32_t entry = NO_ENTRY;
+    if(p_handle.empty() || p_handle == p_descriptorHandle)
+    {
+        ContextStateRecord record;
+        record.descriptorHandle = p_descriptorHandle;
+        record.handle = makeHandle(m_descriptors[descriptor]);
+        entry = insert(std::move(record), descriptor, p_now);
+        if(m_recording)
+        {
+            m_undo.push_back({entry, true, ContextStateRecord(), NO_ENTRY, NO_ENTRY});
+        }
+    }
+    else
+    {
+        const auto handleIt = m_handles.find(p_handle);
+        if(handleIt == m_handles.end())
+        {
+            return ContextRequestResult::failed("Unknown context state " + p_handle);
+        }
+        entry = handleIt->second;
+        if(m_entries[entry].descriptor != descriptor)
+        {
+            return ContextRequestResult::failed("Context state " + p_handle + " does not belong to " + p_descriptorHandle);
+        }
+        // Values of the state may have changed even if the association did not
+        markDirty(entry);
+    }
+
+    if(p_association == ContextAssociation::Associated)
+    {
+        // At most one state per descriptor is associated
+        const auto previous = m_descriptors[descriptor].lists[indexOf(ContextAssociation::Associated)].newest;
+        if(previous != NO_ENTRY && previous != entry)
+        {
+            setAssociation(previous, ContextAssociation::Disassociated, p_now);
+        }
+    }
+    setAssociation(entry, p_association, p_now);
+    return ContextRequestResult::ok(m_entries[entry].record.handle);
+}
+
+std::vector<std::string> ContextStateStore::collectExpired(const ContextRetentionPolicy& p_policy,
+                                                            long long p_now,
+                                                            std::size_t p_maxCount) const
+{
+    const long long maxAge = std::chrono::duration_cast<std::chrono::milliseconds>(p_policy.maxAge).count();
+    std::vector<std::string> expired;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for(const auto& descriptor : m_descriptors)
+    {
+        const auto& list = descriptor.lists[indexOf(ContextAssociation::Disassociated)];
+        std::size_t excess = (p_policy.keepLast > 0 && list.size > p_policy.keepLast) ? list.size - p_policy.keepLast : 0;
+
+        // The list is ordered by disassociation, so walking from the oldest end stops at the first retained state
+        for(auto entry = list.oldest; entry != NO_ENTRY && expired.size() < p_maxCount; entry = m_entries[entry].previous)
+        {
+            const auto& record = m_entries[entry].record;
+            // 0 is an unknown time, not the epoch
+            auto unboundSince = record.bindingEndTime != 0 ? record.bindingEndTime : record.bindingStartTime;
+            if(unboundSince == 0)
+            {
+                unboundSince = m_entries[entry].firstSeen;
+            }
+            const bool tooOld = maxAge > 0 && p_now - unboundSince > maxAge;
+            if(excess == 0 && !tooOld)
+            {
+                break;
+            }
+            if(excess > 0)
+            {
+                --excess;
+            }
+            expired.push_back(record.handle);
+        }
+    }
+    return expired;
+}
+
+void ContextStateStore::begin()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording = true;
+    m_undo.clear();
+    m_savedDirty = m_dirty;
+    m_savedHandleNumbers.clear();
+    for(const auto& descriptor : m_descriptors)
+    {
+        m_savedHandleNumbers.push_back(descriptor.nextHandleNumber);
+    }
+}
+
+void ContextStateStore::end()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_recording = false;
+    m_undo.clear();
+}
+
+void ContextStateStore::rollback()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // In reverse, so the neighbours of each step are adjacent again when it is undone
+    for(auto step = m_undo.rbegin(); step != m_undo.rend(); ++step)
+    {
+        if(step->inserted)
+        {
+            release(step->entry);
+            continue;
+        }
+        unlink(step->entry);
+        m_entries[step->entry].record = std::move(step->record);
+        linkAt(step->entry, step->previous, step->next);
+    }
+    for(std::size_t i = 0; i < m_savedHandleNumbers.size(); ++i)
+    {
+        m_descriptors[i].nextHandleNumber = m_savedHandleNumbers[i];
+    }
+
+    // The changes taken by the failed commit are pending again, the ones of the request are gone
+    for(const auto id : m_dirty)
+    {
+        m_entries[id].dirty = false;
+    }
+    m_dirty = std::move(m_savedDirty);
+    m_savedDirty.clear();
+    for(const auto id : m_dirty)
+    {
+        m_entries[id].dirty = true;
+    }
+    m_recording = false;
+    m_undo.clear();
+}
+
+bool ContextStateStore::remove(const std::string& p_handle)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_handles.find(p_handle);
+    if(it == m_handles.end())
+    {
+        return false;
+    }
+    const auto id = it->second;
+    auto& entry = m_entries[id];
+    if(entry.record.association != ContextAssociation::Disassociated)
+    {
+        return false;
+    }
+
+    release(id);
+    return true;
+}
+
+bool ContextStateStore::find(const std::string& p_handle, ContextStateRecord& p_record) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = m_handles.find(p_handle);
+    if(it == m_handles.end())
+    {
+        return false;
+    }
+    p_record = m_entries[it->second].record;
+    return true;
+}
+
+bool ContextStateStore::findAssociated(const std::string& p_descriptorHandle, ContextStateRecord& p_record) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto descriptor = m_descriptorIds.find(p_descriptorHandle);
+    if(descriptor == m_descriptorIds.end())
+    {
+        return false;
+    }
+    const auto entry = m_descriptors[descriptor->second].lists[indexOf(ContextAssociation::Associated)].newest;
+    if(entry == NO_ENTRY)
+    {
+        return false;
+    }
+    p_record = m_entries[entry].record;
+    return true;
+}
+
+std::size_t ContextStateStore::count(const std::string& p_descriptorHandle, ContextAssociation p_association) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto descriptor = m_descriptorIds.find(p_descriptorHandle);
+    if(descriptor == m_descriptorIds.end())
+    {
+        return 0;
+    }
+    return m_descriptors[descriptor->second].lists[indexOf(p_association)].size;
+}
+
+std::size_t ContextStateStore::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_handles.size();
+}
+
+void ContextStateStore::visit(const std::string& p_descriptorHandle,
+                              ContextAssociation p_association,
+                              const std::function<bool(const ContextStateRecord&)>& p_visitor) const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto descriptor = m_descriptorIds.find(p_descriptorHandle);
+    if(descriptor == m_descriptorIds.end())
+    {
+        return;
+    }
+    auto entry = m_descriptors[descriptor->second].lists[indexOf(p_association)].newest;
+    while(entry != NO_ENTRY && p_visitor(m_entries[entry].record))
+    {
+        entry = m_entries[entry].next;
+    }
+}
+
+std::vector<ContextStateRecord> ContextStateStore::takeChanges()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<ContextStateRecord> changes;
+    changes.reserve(m_dirty.size());
+    for(const auto id : m_dirty)
+    {
+        m_entries[id].dirty = false;
+        changes.push_back(m_entries[id].record);
+    }
+    m_dirty.clear();
+    return changes;
+}
+
+const char* ContextStateStore::toString(ContextAssociation p_association)
+{
+    switch(p_association)
+    {
+        case ContextAssociation::NoAssociation:
+            return "No";
+        case ContextAssociation::PreAssociated:
+            return "Pre";
+        case ContextAssociation::Associated:
+            return "Assoc";
+        case ContextAssociation::Disassociated:
+            return "Dis";
+    }
+    return "";
+}
+
+bool ContextStateStore::fromString(const std::string& p_name, ContextAssociation& p_association)
+{
+    for(const auto association : {ContextAssociation::NoAssociation,
+                                  ContextAssociation::PreAssociated,
+                                  ContextAssociation::Associated,
+                                  ContextAssociation::Disassociated})
+    {
+        if(p_name == toString(association))
+        {
+            p_association = association;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,211 @@
+/**
+ * @brief Keeps the context states (Patient, Workflow, ...) of the provider. States are indexed by handle and, per
+ * context descriptor, by their association. The association index is a set of intrusive lists, newest state first,
+ * so finding the associated patient or moving a state between associations is O(1) regardless of how many states
+ * the history holds.
+ *
+ * Like the AlertStateEngine, the store marks changed states dirty and takeChanges() hands out exactly those,
+ * including the side effects of a request (e.g. the previous patient being disassociated), for one commit. If that
+ * commit fails, rollback() undoes the request, so the store does not get ahead of the MDIB.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibIndex.h"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Mirrors pm:ContextAssociation
+enum class ContextAssociation
+{
+    NoAssociation,
+    PreAssociated,
+    Associated,
+    Disassociated
+};
+
+struct ContextRetentionPolicy
+{
+    // Disassociated states beyond the newest keepLast per descriptor are removed, 0 keeps all
+    std::size_t keepLast{100};
+    // Disassociated states unbound for longer than this are removed, 0 keeps all
+    std::chrono::hours maxAge{24 * 7};
+};
+
+struct ContextStateRecord
+{
+    std::string descriptorHandle;
+    std::string handle;
+    ContextAssociation association{ContextAssociation::NoAssociation};
+    // Milliseconds since epoch, 0 if not set
+    long long bindingStartTime{0};
+    long long bindingEndTime{0};
+};
+
+class ContextRequestResult
+{
+private:
+    std::string m_handle;
+    std::string m_error;
+
+public:
+    static ContextRequestResult ok(std::string p_handle);
+    static ContextRequestResult failed(std::string p_error);
+
+    bool success() const;
+    const std::string& getError() const;
+    // Handle of the created or updated state
+    const std::string& getHandle() const;
+};
+
+class ContextStateStore
+{
+public:
+    static constexpr std::uint32_t NO_ENTRY{0xFFFFFFFF};
+    static constexpr std::size_t ASSOCIATION_COUNT{4};
+
+private:
+    struct Entry
+    {
+        ContextStateRecord record;
+        std::uint32_t descriptor{NO_ENTRY}; // NO_ENTRY marks a removed entry
+        std::uint32_t previous{NO_ENTRY};   // towards the newest state of the same association
+        std::uint32_t next{NO_ENTRY};       // towards the oldest state of the same association
+        // Milliseconds since epoch when the store took over or created the state, stands in for unknown binding times
+        long long firstSeen{0};
+        bool dirty{false};
+    };
+
+    struct List
+    {
+        std::uint32_t newest{NO_ENTRY};
+        std::uint32_t oldest{NO_ENTRY};
+        std::size_t size{0};
+    };
+
+    struct Descriptor
+    {
+        std::string handle;
+        std::array<List, ASSOCIATION_COUNT> lists;
+        std::uint64_t nextHandleNumber{1};
+    };
+
+    mutable std::mutex m_mutex;
+
+    std::vector<Descriptor> m_descriptors;
+    std::unordered_map<std::string, std::uint32_t> m_descriptorIds;
+
+    // Removed entries are reused, so the entries do not grow with the history
+    std::vector<Entry> m_entries;
+    std::vector<std::uint32_t> m_freeEntries;
+    std::unordered_map<std::string, std::uint32_t> m_handles;
+
+    std::vector<std::uint32_t> m_dirty;
+
+    // Before-image of an entry changed by apply() between begin() and end()
+    struct UndoStep
+    {
+        std::uint32_t entry;
+        // Created by the request, undone by releasing it
+        bool inserted;
+        ContextStateRecord record;
+        // Neighbours in the list of its previous association
+        std::uint32_t previous;
+        std::uint32_t next;
+    };
+    bool m_recording{false};
+    std::vector<UndoStep> m_undo;
+    std::vector<std::uint32_t> m_savedDirty;
+    std::vector<std::uint64_t> m_savedHandleNumbers;
+
+    List& listOf(const Entry& p_entry);
+    // Links the entry between the given neighbours of its list, NO_ENTRY for the ends
+    void linkAt(std::uint32_t p_entry, std::uint32_t p_previous, std::uint32_t p_next);
+    void link(std::uint32_t p_entry);
+    void unlink(std::uint32_t p_entry);
+    void markDirty(std::uint32_t p_entry);
+    std::uint32_t insert(ContextStateRecord p_record, std::uint32_t p_descriptor, long long p_now);
+    // Unlinks the entry and frees it for reuse
+    void release(std::uint32_t p_entry);
+    void load(const MdibIndex& p_index);
+    void setAssociation(std::uint32_t p_entry, ContextAssociation p_association, long long p_now);
+    std::string makeHandle(Descriptor& p_descriptor);
+
+public:
+    // Registers all context descriptors of the index and takes over the context states of the MDIB
+    explicit ContextStateStore(const MdibIndex& p_index);
+
+    /**
+     * @brief Takes over the context descriptors of a reloaded MDIB. Descriptors that remain keep their states, new
+     * ones take over their states from the MDIB, the states of removed ones are dropped with their pending changes.
+     */
+    void reload(const MdibIndex& p_index);
+
+    bool hasDescriptor(const std::string& p_descriptorHandle) const;
+
+    // Checks the handles of a proposed context state like apply() does, without changing anything
+    ContextRequestResult validate(const std::string& p_descriptorHandle, const std::string& p_handle) const;
+
+    /**
+     * @brief Applies a proposed context state of a SetContextState request.
+     * An empty handle or the descriptor handle creates a new state, any other handle must belong to an existing state
+     * of the same descriptor. Associating a state disassociates the state associated before.
+     * @param p_now milliseconds since epoch, used for the binding times
+     */
+    ContextRequestResult apply(const std::string& p_descriptorHandle,
+                               const std::string& p_handle,
+                               ContextAssociation p_association,
+                               long long p_now);
+
+    /**
+     * @brief Collects the handles of disassociated states the policy no longer retains, oldest first.
+     * Only looks at the expired states, so the cost does not depend on the retained history. The age counts from the
+     * binding end time, the binding start time if there is none, or the time the store first saw the state if neither
+     * is known (e.g. states of the MDIB file without binding times).
+     * @param p_now milliseconds since epoch
+     * @param p_maxCount upper bound for the result, e.g. the batch size of the compaction
+     */
+    std::vector<std::string> collectExpired(const ContextRetentionPolicy& p_policy, long long p_now, std::size_t p_maxCount) const;
+
+    /**
+     * @brief Records the changes of the following apply() calls until end() or rollback(). One request at a time,
+     * the caller serializes them, e.g. with the commit mutex of the handler.
+     */
+    void begin();
+    // Keeps the changes since begin()
+    void end();
+    // Undoes the changes since begin(), including the position of the states in their association lists
+    void rollback();
+
+    // Removes a disassociated state, e.g. after collectExpired(). Returns false for other states
+    bool remove(const std::string& p_handle);
+
+    bool find(const std::string& p_handle, ContextStateRecord& p_record) const;
+    bool findAssociated(const std::string& p_descriptorHandle, ContextStateRecord& p_record) const;
+    std::size_t count(const std::string& p_descriptorHandle, ContextAssociation p_association) const;
+    std::size_t size() const;
+
+    /**
+     * @brief Visits the states of a descriptor with the given association, newest first, until the visitor returns false.
+     */
+    void visit(const std::string& p_descriptorHandle,
+               ContextAssociation p_association,
+               const std::function<bool(const ContextStateRecord&)>& p_visitor) const;
+
+    // Hands out the states changed since the last call and clears the change list
+    std::vector<ContextStateRecord> takeChanges();
+
+    static const char* toString(ContextAssociation p_association);
+    // "No", "Pre", "Assoc" or "Dis"
+    static bool fromString(const std::string& p_name, ContextAssociation& p_association);
+};
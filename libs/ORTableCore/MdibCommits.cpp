@@ -0,0 +1,183 @@
+#include "MdibCommits.h"
+
+#include "ProviderAPI/MDIBAccess/ProviderMDIBAccess.h"
+
+#include "ParticipantModel/PM/AlertConditionState.h"
+#include "ParticipantModel/PM/AlertSignalState.h"
+
+#include "Tracing.h"
+
+#include <iostream>
+
+using namespace ProviderAPI;
+
+bool commitAlertChanges(ProviderAPI::SDCProvider* p_provider, const AlertStateChanges& p_changes)
+{
+    ORTABLE_TRACE_SCOPE("provider", "commitAlertChanges");
+    auto updateAccess = p_provider->getMDIBGateway()->makeUpdateAccess();
+    for(const auto& condition : p_changes.conditions)
+    {
+        auto state = updateAccess->getState<ParticipantModel::PM::AlertConditionState>(condition.handle);
+        state->setPresence(condition.present);
+        switch(condition.actualPriority)
+        {
+            case AlertPriority::None:
+                state->setActualPriority(ParticipantModel::PM::AlertConditionPriority::None);
+                break;
+            case AlertPriority::Lo:
+                state->setActualPriority(ParticipantModel::PM::AlertConditionPriority::Lo);
+                break;
+            case AlertPriority::Me:
+                state->setActualPriority(ParticipantModel::PM::AlertConditionPriority::Me);
+                break;
+            case AlertPriority::Hi:
+                state->setActualPriority(ParticipantModel::PM::AlertConditionPriority::Hi);
+                break;
+        }
+        updateAccess->updateState(state);
+    }
+    for(const auto& signal : p_changes.signals)
+    {
+        auto state = updateAccess->getState<ParticipantModel::PM::AlertSignalState>(signal.handle);
+        switch(signal.presence)
+        {
+            case AlertSignalPresence::On:
+                state->setPresence(ParticipantModel::PM::AlertSignalPresence::On);
+                break;
+            case AlertSignalPresence::Off:
+                state->setPresence(ParticipantModel::PM::AlertSignalPresence::Off);
+                break;
+            case AlertSignalPresence::Latched:
+                state->setPresence(ParticipantModel::PM::AlertSignalPresence::Latch);
+                break;
+            case AlertSignalPresence::Acknowledged:
+                state->setPresence(ParticipantModel::PM::AlertSignalPresence::Ack);
+                break;
+        }
+        updateAccess->updateState(state);
+    }
+
+    ORTABLE_TRACE_SCOPE("provider", "commit");
+    auto result = p_provider->getMDIBGateway()->commit(std::move(updateAccess));
+    if (!result.success())
+    {
+        std::cout << "Update of alerts not successful: " + result.getError();
+        return false;
+    }
+    return true;
+}
+
+bool commitContextChanges(
+    ProviderAPI::SDCProvider* p_provider,
+    ContextStateStore& p_contexts,
+    const std::unordered_map<std::string, std::shared_ptr<ParticipantModel::PM::AbstractContextState>>& p_proposed)
+{
+    ORTABLE_TRACE_SCOPE("provider", "commitContextChanges");
+    using namespace ParticipantModel::PM;
+
+    const auto changes = p_contexts.takeChanges();
+    if(changes.empty())
+    {
+        return true;
+    }
+
+    auto updateAccess = p_provider->getMDIBGateway()->makeUpdateAccess();
+    for(const auto& change : changes)
+    {
+        const auto proposed = p_proposed.find(change.handle);
+        auto state = (proposed != p_proposed.end()) ? proposed->second
+                                                    : updateAccess->getState<AbstractContextState>(change.handle);
+        state->setHandle(Handle(change.handle));
+        switch(change.association)
+        {
+            case ::ContextAssociation::NoAssociation:
+                state->setContextAssociation(ContextAssociation::No);
+                break;
+            case ::ContextAssociation::PreAssociated:
+                state->setContextAssociation(ContextAssociation::Pre);
+                break;
+            case ::ContextAssociation::Associated:
+                state->setContextAssociation(ContextAssociation::Assoc);
+                break;
+            case ::ContextAssociation::Disassociated:
+                state->setContextAssociation(ContextAssociation::Dis);
+                break;
+        }
+        if(change.bindingStartTime != 0)
+        {
+            state->setBindingStartTime(Timestamp(static_cast<unsigned long long>(change.bindingStartTime)));
+        }
+        if(change.bindingEndTime != 0)
+        {
+            state->setBindingEndTime(Timestamp(static_cast<unsigned long long>(change.bindingEndTime)));
+        }
+        updateAccess->updateState(state);
+    }
+
+    ORTABLE_TRACE_SCOPE("provider", "commit");
+    auto result = p_provider->getMDIBGateway()->commit(std::move(updateAccess));
+    if (!result.success())
+    {
+        std::cout << "Update of contexts not successful: " + result.getError();
+        return false;
+    }
+    return true;
+}
+
+bool removeContextStates(ProviderAPI::SDCProvider* p_provider, const std::vector<std::string>& p_handles)
+{
+    ORTABLE_TRACE_SCOPE("provider", "removeContextStates");
+    auto updateAccess = p_provider->getMDIBGateway()->makeUpdateAccess();
+    for(const auto& handle : p_handles)
+    {
+        updateAccess->removeState(handle);
+    }
+
+    ORTABLE_TRACE_SCOPE("provider", "commit");
+    auto result = p_provider->getMDIBGateway()->commit(std::move(updateAccess));
+    if (!result.success())
+    {
+        std::cout << "Removal of context states not successful: " + result.getError();
+        return false;
+    }
+    return true;
+}
+
+bool applyDescriptionModifications(ProviderAPI::SDCProvider* p_provider,
+                                   const MdibIndex& p_next,
+                                   const std::vector<DescriptionModification>& p_modifications)
+{
+    ORTABLE_TRACE_SCOPE("provider", "applyDescriptionModifications");
+    auto descriptionAccess = p_provider->getMDIBGateway()->makeDescriptionUpdateAccess();
+
+    for(const auto& modification : p_modifications)
+    {
+        if(modification.type == DescriptionModification::Type::Deleted)
+        {
+            descriptionAccess->deleteDescriptor(modification.handle);
+            continue;
+        }
+
+        const auto& descriptor = p_next.getDescriptor(modification.descriptor);
+        const auto state = p_next.getState(modification.descriptor);
+        const auto stateXml = (state != MdibIndex::NO_ENTRY) ? p_next.getModel().states[state].xml : std::string();
+
+        if(modification.type == DescriptionModification::Type::Created)
+        {
+            descriptionAccess->createDescriptorFromXml(modification.parentHandle, descriptor.xml, stateXml);
+        }
+        else
+        {
+            descriptionAccess->updateDescriptorFromXml(descriptor.xml);
+        }
+    }
+
+    ORTABLE_TRACE_SCOPE("provider", "commit");
+    auto result = p_provider->getMDIBGateway()->commit(std::move(descriptionAccess));
+    if (!result.success())
+    {
+        std::cout << "Update of description not successful: " + result.getError();
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,43 @@
+/**
+ * @brief Commits of the provider. Each function writes one batch of changes computed by the alert, context or reload
+ * modules to the MDIB in one update access, so consumers receive one report per batch. They return false and print
+ * the error if the commit was rejected.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "ProviderAPI/SDCProvider.h"
+#include "ParticipantModel/PM/AbstractContextState.h"
+
+#include "AlertStateEngine.h"
+#include "ContextStateStore.h"
+#include "MdibDiff.h"
+#include "MdibIndex.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+// Commits the given alert states in one update, so consumers receive them in one EpisodicAlertReport.
+// Unchanged states are not touched. Called by the AlertAggregator
+bool commitAlertChanges(ProviderAPI::SDCProvider* p_provider, const AlertStateChanges& p_changes);
+
+// Commits the context states changed in the store in one update. Proposed states of the current request are committed
+// with their content, all other changes (e.g. a disassociated previous patient) only change association and binding
+bool commitContextChanges(
+    ProviderAPI::SDCProvider* p_provider,
+    ContextStateStore& p_contexts,
+    const std::unordered_map<std::string, std::shared_ptr<ParticipantModel::PM::AbstractContextState>>& p_proposed);
+
+// Removes context states expired by the retention policy from the MDIB, one batch of the ContextCompactor per commit
+bool removeContextStates(ProviderAPI::SDCProvider* p_provider, const std::vector<std::string>& p_handles);
+
+// Applies the modifications found by the MdibReloader to the running provider. They are committed at once,
+// so consumers receive one DescriptionModificationReport and keep their subscriptions.
+bool applyDescriptionModifications(ProviderAPI::SDCProvider* p_provider,
+                                   const MdibIndex& p_next,
+                                   const std::vector<DescriptionModification>& p_modifications);
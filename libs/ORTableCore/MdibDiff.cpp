@@ -0,0 +1,60 @@
+#include "MdibDiff.h"
+
+std::vector<DescriptionModification> MdibDiff::compute(const MdibIndex& p_current, const MdibIndex& p_next)
+{
+    std::vector<DescriptionModification> deletions;
+    std::vector<DescriptionModification> creations;
+    std::vector<DescriptionModification> updates;
+
+    // Descriptors are in document order, so a parent is always decided before its children
+    std::vector<bool> deleted(p_current.size(), false);
+    for(std::uint32_t i = 0; i < p_current.size(); ++i)
+    {
+        const auto& descriptor = p_current.getDescriptor(i);
+        const auto parent = p_current.getParent(i);
+        const auto parentDeleted = parent != MdibIndex::NO_ENTRY && deleted[parent];
+
+        const auto match = p_next.find(descriptor.handle);
+        const auto replaced = match != MdibIndex::NO_ENTRY
+                              && (p_next.getDescriptor(match).type != descriptor.type
+                                  || p_next.getDescriptor(match).parentHandle != descriptor.parentHandle);
+        if(!parentDeleted && (match == MdibIndex::NO_ENTRY || replaced))
+        {
+            deletions.push_back({DescriptionModification::Type::Deleted, i, descriptor.handle, descriptor.parentHandle});
+        }
+        deleted[i] = parentDeleted || match == MdibIndex::NO_ENTRY || replaced;
+    }
+
+    for(std::uint32_t i = 0; i < p_next.size(); ++i)
+    {
+        const auto& descriptor = p_next.getDescriptor(i);
+        const auto match = p_current.find(descriptor.handle);
+        if(match == MdibIndex::NO_ENTRY || deleted[match])
+        {
+            creations.push_back({DescriptionModification::Type::Created, i, descriptor.handle, descriptor.parentHandle});
+        }
+        else if(p_current.getDescriptor(match).contentHash != descriptor.contentHash)
+        {
+            updates.push_back({DescriptionModification::Type::Updated, i, descriptor.handle, descriptor.parentHandle});
+        }
+    }
+
+    auto result = std::move(deletions);
+    result.insert(result.end(), creations.begin(), creations.end());
+    result.insert(result.end(), updates.begin(), updates.end());
+    return result;
+}
+
+const char* MdibDiff::toString(DescriptionModification::Type p_type)
+{
+    switch(p_type)
+    {
+        case DescriptionModification::Type::Created:
+            return "Crt";
+        case DescriptionModification::Type::Updated:
+            return "Upt";
+        case DescriptionModification::Type::Deleted:
+            return "Del";
+    }
+    return "";
+}
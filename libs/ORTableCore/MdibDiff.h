@@ -0,0 +1,44 @@
+/**
+ * @brief Computes the minimal set of description modifications that turns one MDIB into another.
+ * Descriptors are matched by handle. A descriptor that changed its type or parent cannot be updated in place
+ * and is deleted and created again.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibIndex.h"
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct DescriptionModification
+{
+    enum class Type
+    {
+        Created,
+        Updated,
+        Deleted
+    };
+
+    Type type;
+    // Position in the next index for Created/Updated, in the current index for Deleted
+    std::uint32_t descriptor;
+    std::string handle;
+    std::string parentHandle;
+};
+
+class MdibDiff
+{
+public:
+    /**
+     * @brief Order of the result: deletions, creations (parents before children), updates.
+     * Only the top-most descriptor of a deleted subtree is listed, its children are deleted along with it.
+     */
+    static std::vector<DescriptionModification> compute(const MdibIndex& p_current, const MdibIndex& p_next);
+
+    static const char* toString(DescriptionModification::Type p_type);
+};
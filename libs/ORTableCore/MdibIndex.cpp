@@ -0,0 +1,441 @@
+#include "MdibIndex.h"
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <thread>
+#include <unordered_map>
+
+namespace
+{
+    // Allowed parent elements per descriptor element, following the BICEPS containment tree
+    struct NestingRule
+    {
+        const char* element;
+        std::vector<std::string> parents;
+    };
+
+    const std::vector<NestingRule>& nestingRules()
+    {
+        static const std::vector<NestingRule> rules{
+            {"Sco", {"Mds", "Vmd"}},
+            {"Operation", {"Sco"}},
+            {"Vmd", {"Mds"}},
+            {"AlertSystem", {"Mds", "Vmd"}},
+            {"AlertCondition", {"AlertSystem"}},
+            {"AlertSignal", {"AlertSystem"}},
+            {"Channel", {"Vmd"}},
+            {"Metric", {"Channel"}},
+            {"SystemContext", {"Mds"}},
+            {"PatientContext", {"SystemContext"}},
+            {"LocationContext", {"SystemContext"}},
+            {"EnsembleContext", {"SystemContext"}},
+            {"OperatorContext", {"SystemContext"}},
+            {"WorkflowContext", {"SystemContext"}},
+            {"MeansContext", {"SystemContext"}},
+            {"Clock", {"Mds"}},
+            {"Battery", {"Mds"}},
+        };
+        return rules;
+    }
+
+    bool endsWith(const std::string& p_value, const std::string& p_suffix)
+    {
+        return p_value.size() >= p_suffix.size()
+               && p_value.compare(p_value.size() - p_suffix.size(), p_suffix.size(), p_suffix) == 0;
+    }
+
+    // NumericMetricDescriptor -> NumericMetricState, AlertSignal -> AlertSignalState
+    std::string expectedStateType(const std::string& p_descriptorType)
+    {
+        static const std::string DESCRIPTOR{"Descriptor"};
+        if(endsWith(p_descriptorType, DESCRIPTOR))
+        {
+            return p_descriptorType.substr(0, p_descriptorType.size() - DESCRIPTOR.size()) + "State";
+        }
+        return p_descriptorType + "State";
+    }
+
+    bool isContextDescriptor(const MdibDescriptor& p_descriptor)
+    {
+        return endsWith(p_descriptor.element, "Context") && p_descriptor.element != "SystemContext";
+    }
+
+    std::string describe(const MdibDescriptor& p_descriptor)
+    {
+        return "line " + std::to_string(p_descriptor.line) + ": " + p_descriptor.element + " " + p_descriptor.handle;
+    }
+
+    // Runs the passes on up to p_maxThreads threads, the calling thread takes part
+    void runPasses(std::vector<std::function<void()>>& p_passes, std::size_t p_maxThreads)
+    {
+        auto threads = p_maxThreads > 0 ? p_maxThreads : static_cast<std::size_t>(std::thread::hardware_concurrency());
+        threads = std::max<std::size_t>(1, std::min(threads, p_passes.size()));
+
+        std::atomic<std::size_t> next{0};
+        auto worker = [&]() {
+            for(auto pass = next++; pass < p_passes.size(); pass = next++)
+            {
+                p_passes[pass]();
+            }
+        };
+
+        std::vector<std::thread> pool;
+        for(std::size_t i = 1; i < threads; ++i)
+        {
+            pool.emplace_back(worker);
+        }
+        worker();
+        for(auto& thread : pool)
+        {
+            thread.join();
+        }
+    }
+} // namespace
+
+
+constexpr std::uint32_t MdibIndex::NO_ENTRY;
+
+bool MdibValidationResult::success() const
+{
+    return m_errors.empty();
+}
+
+const std::vector<std::string>& MdibValidationResult::getErrors() const
+{
+    return m_errors;
+}
+
+std::string MdibValidationResult::getError() const
+{
+    std::string result;
+    for(const auto& error : m_errors)
+    {
+        result += error + "\n";
+    }
+    return result;
+}
+
+void MdibValidationResult::addError(std::string p_error)
+{
+    m_errors.push_back(std::move(p_error));
+}
+
+void MdibValidationResult::append(const MdibValidationResult& p_other)
+{
+    m_errors.insert(m_errors.end(), p_other.m_errors.begin(), p_other.m_errors.end());
+}
+
+
+std::uint64_t MdibIndex::hashHandle(ORTable::StringView p_handle)
+{
+    std::uint64_t hash{14695981039346656037ULL};
+    for(const auto c : p_handle)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+MdibValidationResult MdibIndex::build(MdibModel p_model, MdibIndex& p_index, std::size_t p_maxThreads)
+{
+    MdibIndex index;
+    index.m_model = std::move(p_model);
+
+    MdibValidationResult result;
+    if(index.m_model.descriptors.size() >= NO_ENTRY || index.m_model.states.size() >= NO_ENTRY)
+    {
+        result.addError("MDIB exceeds the supported number of descriptors");
+        return result;
+    }
+
+    // The sorted handle table is shared by all passes, so it is built upfront
+    const auto& descriptors = index.m_model.descriptors;
+    index.m_handles.reserve(descriptors.size());
+    for(std::uint32_t i = 0; i < descriptors.size(); ++i)
+    {
+        index.m_handles.push_back({hashHandle(descriptors[i].handle), i});
+    }
+    std::sort(index.m_handles.begin(), index.m_handles.end(), [](const HandleEntry& p_lhs, const HandleEntry& p_rhs) {
+        return p_lhs.hash < p_rhs.hash || (p_lhs.hash == p_rhs.hash && p_lhs.descriptor < p_rhs.descriptor);
+    });
+
+    MdibValidationResult uniqueness;
+    MdibValidationResult hierarchy;
+    MdibValidationResult references;
+    MdibValidationResult states;
+    std::vector<std::function<void()>> passes{
+        [&]() { uniqueness = index.checkUniqueness(); },
+        [&]() { hierarchy = index.buildHierarchy(); },
+        [&]() { references = index.buildReferences(); },
+        [&]() { states = index.buildStates(); },
+    };
+    runPasses(passes, p_maxThreads);
+
+    // Merged in a fixed order, so the report does not depend on scheduling
+    result.append(uniqueness);
+    result.append(hierarchy);
+    result.append(references);
+    result.append(states);
+
+    if(result.success())
+    {
+        p_index = std::move(index);
+    }
+    return result;
+}
+
+MdibValidationResult MdibIndex::checkUniqueness() const
+{
+    MdibValidationResult result;
+    std::unordered_map<std::string, std::uint32_t> stateHandles;
+
+    for(std::size_t i = 1; i < m_handles.size(); ++i)
+    {
+        if(m_handles[i].hash != m_handles[i - 1].hash)
+        {
+            continue;
+        }
+        // Walk back over the run of equal hashes to tell real duplicates from hash collisions
+        for(auto j = i; j-- > 0 && m_handles[j].hash == m_handles[i].hash;)
+        {
+            const auto& current = m_model.descriptors[m_handles[i].descriptor];
+            const auto& previous = m_model.descriptors[m_handles[j].descriptor];
+            if(current.handle == previous.handle)
+            {
+                result.addError(describe(current) + ": handle already used in line " + std::to_string(previous.line));
+                break;
+            }
+        }
+    }
+
+    // Context states carry own handles that share the namespace of the descriptor handles
+    for(std::uint32_t i = 0; i < m_model.states.size(); ++i)
+    {
+        const auto& state = m_model.states[i];
+        if(state.handle.empty())
+        {
+            continue;
+        }
+        if(find(state.handle) != NO_ENTRY || !stateHandles.emplace(state.handle, i).second)
+        {
+            result.addError("line " + std::to_string(state.line) + ": state handle " + state.handle + " is not unique");
+        }
+    }
+    return result;
+}
+
+MdibValidationResult MdibIndex::buildHierarchy()
+{
+    MdibValidationResult result;
+    const auto& descriptors = m_model.descriptors;
+    const auto count = static_cast<std::uint32_t>(descriptors.size());
+
+    m_parents.assign(count, NO_ENTRY);
+    m_childOffsets.assign(count + 1, 0);
+
+    for(std::uint32_t i = 0; i < count; ++i)
+    {
+        const auto& descriptor = descriptors[i];
+        if(descriptor.parentHandle.empty())
+        {
+            if(descriptor.element != "Mds")
+            {
+                result.addError(describe(descriptor) + ": only an Mds may be a top level descriptor");
+            }
+            continue;
+        }
+        const auto parent = find(descriptor.parentHandle);
+        if(parent == NO_ENTRY)
+        {
+            result.addError(describe(descriptor) + ": unknown parent " + descriptor.parentHandle);
+            continue;
+        }
+        m_parents[i] = parent;
+        ++m_childOffsets[parent + 1];
+
+        const auto& parentElement = descriptors[parent].element;
+        for(const auto& rule : nestingRules())
+        {
+            if(descriptor.element == rule.element
+               && std::find(rule.parents.begin(), rule.parents.end(), parentElement) == rule.parents.end())
+            {
+                result.addError(describe(descriptor) + ": must not be contained in " + parentElement);
+            }
+        }
+    }
+
+    // Prefix sum turns the child counts into offsets, children keep document order
+    for(std::uint32_t i = 0; i < count; ++i)
+    {
+        m_childOffsets[i + 1] += m_childOffsets[i];
+    }
+    m_children.assign(m_childOffsets[count], NO_ENTRY);
+    auto fill = m_childOffsets;
+    for(std::uint32_t i = 0; i < count; ++i)
+    {
+        if(m_parents[i] != NO_ENTRY)
+        {
+            m_children[fill[m_parents[i]]++] = i;
+        }
+    }
+    return result;
+}
+
+MdibValidationResult MdibIndex::buildReferences()
+{
+    MdibValidationResult result;
+    const auto& descriptors = m_model.descriptors;
+    const auto count = static_cast<std::uint32_t>(descriptors.size());
+
+    m_targets.assign(count, NO_ENTRY);
+    m_sourceOffsets.assign(count + 1, 0);
+    m_sources.clear();
+
+    for(std::uint32_t i = 0; i < count; ++i)
+    {
+        const auto& descriptor = descriptors[i];
+        m_sourceOffsets[i] = static_cast<std::uint32_t>(m_sources.size());
+
+        for(const auto& reference : descriptor.references)
+        {
+            const auto target = find(reference.second);
+            if(target == NO_ENTRY)
+            {
+                result.addError(describe(descriptor) + ": " + reference.first + " references unknown handle " + reference.second);
+                continue;
+            }
+            const auto& targetType = descriptors[target].type;
+
+            if(reference.first == "Source")
+            {
+                m_sources.push_back(target);
+                continue;
+            }
+            m_targets[i] = target;
+
+            if(reference.first == "ConditionSignaled" && descriptors[target].element != "AlertCondition")
+            {
+                result.addError(describe(descriptor) + ": ConditionSignaled " + reference.second + " is no alert condition");
+            }
+            else if(descriptor.type == "SetStringOperationDescriptor" && !endsWith(targetType, "StringMetricDescriptor"))
+            {
+                result.addError(describe(descriptor) + ": OperationTarget " + reference.second + " is no string metric");
+            }
+            else if(descriptor.type == "SetValueOperationDescriptor" && targetType != "NumericMetricDescriptor")
+            {
+                result.addError(describe(descriptor) + ": OperationTarget " + reference.second + " is no numeric metric");
+            }
+            else if(descriptor.type == "SetContextStateOperationDescriptor" && !isContextDescriptor(descriptors[target]))
+            {
+                result.addError(describe(descriptor) + ": OperationTarget " + reference.second + " is no context descriptor");
+            }
+        }
+
+        if(descriptor.element == "Operation" && m_targets[i] == NO_ENTRY)
+        {
+            result.addError(describe(descriptor) + ": operation without valid OperationTarget");
+        }
+    }
+    m_sourceOffsets[count] = static_cast<std::uint32_t>(m_sources.size());
+    return result;
+}
+
+MdibValidationResult MdibIndex::buildStates()
+{
+    MdibValidationResult result;
+    const auto& descriptors = m_model.descriptors;
+
+    m_states.assign(descriptors.size(), NO_ENTRY);
+
+    for(std::uint32_t i = 0; i < m_model.states.size(); ++i)
+    {
+        const auto& state = m_model.states[i];
+        const auto descriptor = find(state.descriptorHandle);
+        const auto location = "line " + std::to_string(state.line) + ": " + state.type + " for " + state.descriptorHandle;
+        if(descriptor == NO_ENTRY)
+        {
+            result.addError(location + ": unknown descriptor");
+            continue;
+        }
+
+        const auto& expected = expectedStateType(descriptors[descriptor].type);
+        if(state.type != expected)
+        {
+            result.addError(location + ": type does not match descriptor, expected " + expected);
+        }
+
+        const auto multiState = isContextDescriptor(descriptors[descriptor]);
+        if(multiState && state.handle.empty())
+        {
+            result.addError(location + ": context state without handle");
+        }
+        if(m_states[descriptor] != NO_ENTRY)
+        {
+            if(!multiState)
+            {
+                result.addError(location + ": descriptor already has a state");
+            }
+            continue;
+        }
+        m_states[descriptor] = i;
+    }
+    return result;
+}
+
+const MdibModel& MdibIndex::getModel() const
+{
+    return m_model;
+}
+
+std::size_t MdibIndex::size() const
+{
+    return m_model.descriptors.size();
+}
+
+std::uint32_t MdibIndex::find(ORTable::StringView p_handle) const
+{
+    const auto hash = hashHandle(p_handle);
+    auto it = std::lower_bound(m_handles.begin(), m_handles.end(), hash, [](const HandleEntry& p_entry, std::uint64_t p_hash) {
+        return p_entry.hash < p_hash;
+    });
+    for(; it != m_handles.end() && it->hash == hash; ++it)
+    {
+        if(m_model.descriptors[it->descriptor].handle == p_handle)
+        {
+            return it->descriptor;
+        }
+    }
+    return NO_ENTRY;
+}
+
+const MdibDescriptor& MdibIndex::getDescriptor(std::uint32_t p_descriptor) const
+{
+    return m_model.descriptors[p_descriptor];
+}
+
+std::uint32_t MdibIndex::getParent(std::uint32_t p_descriptor) const
+{
+    return m_parents[p_descriptor];
+}
+
+MdibIndex::ChildRange MdibIndex::getChildren(std::uint32_t p_descriptor) const
+{
+    return {m_children.data() + m_childOffsets[p_descriptor], m_children.data() + m_childOffsets[p_descriptor + 1]};
+}
+
+std::uint32_t MdibIndex::getTarget(std::uint32_t p_descriptor) const
+{
+    return m_targets[p_descriptor];
+}
+
+MdibIndex::ChildRange MdibIndex::getSources(std::uint32_t p_descriptor) const
+{
+    return {m_sources.data() + m_sourceOffsets[p_descriptor], m_sources.data() + m_sourceOffsets[p_descriptor + 1]};
+}
+
+std::uint32_t MdibIndex::getState(std::uint32_t p_descriptor) const
+{
+    return m_states[p_descriptor];
+}
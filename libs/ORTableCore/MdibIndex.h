@@ -0,0 +1,109 @@
+/**
+ * @brief Frozen lookup structure over an MdibModel. All relations are resolved to positions once while building,
+ * so lookups afterwards do not touch handle strings except for the initial find().
+ * Building validates the MDIB in independent passes that run in parallel:
+ * handle uniqueness, hierarchy and nesting, handle references (OperationTarget, ConditionSignaled, Source) and states.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibModel.h"
+#include "StringView.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class MdibValidationResult
+{
+private:
+    std::vector<std::string> m_errors;
+
+public:
+    bool success() const;
+    const std::vector<std::string>& getErrors() const;
+    // All errors, one per line
+    std::string getError() const;
+
+    void addError(std::string p_error);
+    void append(const MdibValidationResult& p_other);
+};
+
+class MdibIndex
+{
+public:
+    static constexpr std::uint32_t NO_ENTRY{0xFFFFFFFF};
+
+    struct ChildRange
+    {
+        const std::uint32_t* first;
+        const std::uint32_t* last;
+
+        const std::uint32_t* begin() const { return first; }
+        const std::uint32_t* end() const { return last; }
+        std::size_t size() const { return static_cast<std::size_t>(last - first); }
+    };
+
+private:
+    struct HandleEntry
+    {
+        std::uint64_t hash;
+        std::uint32_t descriptor;
+    };
+
+    MdibModel m_model;
+
+    // Sorted by hash, collisions are resolved by comparing the handle
+    std::vector<HandleEntry> m_handles;
+
+    // One entry per descriptor, in the order of m_model.descriptors
+    std::vector<std::uint32_t> m_parents;
+    std::vector<std::uint32_t> m_targets;  // OperationTarget of operations, ConditionSignaled of alert signals
+    std::vector<std::uint32_t> m_states;   // first state of the descriptor
+
+    // Children in compressed form: the children of descriptor i are m_children[m_childOffsets[i] .. m_childOffsets[i + 1])
+    std::vector<std::uint32_t> m_childOffsets;
+    std::vector<std::uint32_t> m_children;
+
+    // Resolved Source references of alert conditions, same layout as the children
+    std::vector<std::uint32_t> m_sourceOffsets;
+    std::vector<std::uint32_t> m_sources;
+
+    MdibValidationResult checkUniqueness() const;
+    MdibValidationResult buildHierarchy();
+    MdibValidationResult buildReferences();
+    MdibValidationResult buildStates();
+
+public:
+    MdibIndex() = default;
+    MdibIndex(const MdibIndex&) = delete;
+    MdibIndex& operator=(const MdibIndex&) = delete;
+    MdibIndex(MdibIndex&&) = default;
+    MdibIndex& operator=(MdibIndex&&) = default;
+
+    /**
+     * @brief Takes over the model, validates it and builds all lookup tables.
+     * @param p_maxThreads upper bound for the worker threads used by the passes, 0 selects the hardware concurrency
+     */
+    static MdibValidationResult build(MdibModel p_model, MdibIndex& p_index, std::size_t p_maxThreads = 0);
+
+    const MdibModel& getModel() const;
+    std::size_t size() const;
+
+    // Position of the descriptor with the given handle or NO_ENTRY
+    std::uint32_t find(ORTable::StringView p_handle) const;
+
+    const MdibDescriptor& getDescriptor(std::uint32_t p_descriptor) const;
+    std::uint32_t getParent(std::uint32_t p_descriptor) const;
+    ChildRange getChildren(std::uint32_t p_descriptor) const;
+    std::uint32_t getTarget(std::uint32_t p_descriptor) const;
+    ChildRange getSources(std::uint32_t p_descriptor) const;
+    // Position in getModel().states or NO_ENTRY
+    std::uint32_t getState(std::uint32_t p_descriptor) const;
+
+    static std::uint64_t hashHandle(ORTable::StringView p_handle);
+};
@@ -0,0 +1,60 @@
+/**
+ * @brief Lightweight description of an MDIB document as built by the MdibStreamLoader. It only keeps what the provider
+ * needs to reason about the structure of the MDIB (handles, types, hierarchy, references) instead of the full XML tree.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// A handle reference of a descriptor, e.g. {"OperationTarget", "MDC_OR_TABLE_TREND"}
+using MdibReference = std::pair<std::string, std::string>;
+// An attribute the provider logic depends on, e.g. {"Latching", "true"}
+using MdibAttribute = std::pair<std::string, std::string>;
+
+struct MdibDescriptor
+{
+    std::string handle;
+    std::string element;          // local element name, e.g. "Metric" or "AlertSignal"
+    std::string type;             // local xsi:type, e.g. "NumericMetricDescriptor". Falls back to the element name
+    std::string parentHandle;     // empty for the Mds
+    std::string descriptorVersion;
+    std::vector<MdibReference> references;
+    // Alert attributes (Kind, Priority, Latching, Manifestation), other attributes only go into the content hash
+    std::vector<MdibAttribute> attributes;
+    // Hash over all attributes and non-descriptor child content (Type, Unit, TechnicalRange, ...).
+    // DescriptorVersion is excluded, so only semantic changes alter it.
+    std::uint64_t contentHash{0};
+    std::size_t line{0};
+    // Compact XML of the descriptor without its child descriptors. Only kept when requested from the loader
+    std::string xml;
+};
+
+struct MdibState
+{
+    std::string descriptorHandle;
+    std::string handle;           // only set for multi states (context states)
+    std::string type;             // local xsi:type, e.g. "NumericMetricState"
+    // Context attributes (ContextAssociation, BindingStartTime, BindingEndTime)
+    std::vector<MdibAttribute> attributes;
+    std::uint64_t contentHash{0}; // like MdibDescriptor::contentHash, without StateVersion
+    std::size_t line{0};
+    std::string xml;              // like MdibDescriptor::xml
+};
+
+struct MdibModel
+{
+    std::string sequenceId;
+    std::string mdibVersion;
+    std::string descriptionVersion;
+    // In document order, i.e. every parent precedes its children
+    std::vector<MdibDescriptor> descriptors;
+    std::vector<MdibState> states;
+};
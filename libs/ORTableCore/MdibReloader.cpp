@@ -0,0 +1,134 @@
+#include "MdibReloader.h"
+
+#include "MdibStreamLoader.h"
+
+#include "Logging/LogBroker.h"
+
+#include <sys/stat.h>
+
+using namespace Logging;
+
+MdibReloader::MdibReloader(std::string p_path, std::shared_ptr<const MdibIndex> p_current, ApplyFunction p_apply)
+    : m_path(std::move(p_path))
+    , m_apply(std::move(p_apply))
+    , m_current(std::move(p_current))
+{
+    fileVersion(m_path, m_applied);
+}
+
+MdibReloader::~MdibReloader()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+bool MdibReloader::fileVersion(const std::string& p_path, FileVersion& p_version)
+{
+    struct stat status;
+    if(stat(p_path.c_str(), &status) != 0)
+    {
+        return false;
+    }
+#ifdef __APPLE__
+    const auto& time = status.st_mtimespec;
+#else
+    const auto& time = status.st_mtim;
+#endif
+    p_version.modificationTime = static_cast<long long>(time.tv_sec) * 1000000000LL + static_cast<long long>(time.tv_nsec);
+    p_version.size = static_cast<long long>(status.st_size);
+    return true;
+}
+
+bool MdibReloader::reloadIfChanged()
+{
+    FileVersion version;
+    if(!fileVersion(m_path, version) || version == m_applied)
+    {
+        return true;
+    }
+    // A failed version is tried again on every check, e.g. while it is still being written, but reported only once
+    const bool report = version != m_rejected;
+    const auto reject = [this, &version, report](const std::string& p_error) {
+        if(report)
+        {
+            LogBroker::getInstance().log(LogMessage("MdibReloader", Severity::Error, "Ignoring changed " + m_path + p_error));
+        }
+        m_rejected = version;
+        return false;
+    };
+
+    MdibModel model;
+    const auto loadResult = MdibStreamLoader::loadFile(m_path, model, nullptr, true);
+    if(!loadResult.success())
+    {
+        return reject(":" + loadResult.getError());
+    }
+
+    auto next = std::make_shared<MdibIndex>();
+    const auto validationResult = MdibIndex::build(std::move(model), *next);
+    if(!validationResult.success())
+    {
+        return reject(", validation failed:\n" + validationResult.getError());
+    }
+
+    const auto current = getCurrent();
+    const auto modifications = MdibDiff::compute(*current, *next);
+    if(modifications.empty())
+    {
+        m_applied = version;
+        return true;
+    }
+
+    if(report)
+    {
+        for(const auto& modification : modifications)
+        {
+            LogBroker::getInstance().log(LogMessage(
+                "MdibReloader", Severity::Notice, std::string(MdibDiff::toString(modification.type)) + " " + modification.handle));
+        }
+    }
+    if(!m_apply(*next, modifications))
+    {
+        return reject(", the modifications were not applied");
+    }
+
+    std::lock_guard<std::mutex> lock(m_currentMutex);
+    m_current = std::move(next);
+    m_applied = version;
+    return true;
+}
+
+void MdibReloader::run(std::chrono::milliseconds p_interval)
+{
+    m_running = true;
+    m_thread = std::thread([this, p_interval]() {
+        while(m_running)
+        {
+            reloadIfChanged();
+
+            std::unique_lock<std::mutex> lock(m_waitMutex);
+            m_wakeUp.wait_for(lock, p_interval, [this]() { return !m_running; });
+        }
+    });
+}
+
+void MdibReloader::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_all();
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
+
+std::shared_ptr<const MdibIndex> MdibReloader::getCurrent() const
+{
+    std::lock_guard<std::mutex> lock(m_currentMutex);
+    return m_current;
+}
@@ -0,0 +1,84 @@
+/**
+ * @brief Watches the MDIB file of the provider. When it changes, the new file is loaded and validated, diffed against
+ * the active MDIB and the resulting modifications are handed to the apply function. The provider keeps running,
+ * so consumers keep their subscriptions and only receive a DescriptionModificationReport.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibDiff.h"
+#include "MdibIndex.h"
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class MdibReloader
+{
+public:
+    // Returns true in case the modifications were committed to the provider
+    using ApplyFunction =
+        std::function<bool(const MdibIndex& p_next, const std::vector<DescriptionModification>& p_modifications)>;
+
+private:
+    // Identifies a saved version of the file. With the size, a rewrite within the resolution of the timestamp is
+    // still noticed in most cases
+    struct FileVersion
+    {
+        // Nanoseconds since epoch
+        long long modificationTime{0};
+        long long size{-1};
+
+        bool operator==(const FileVersion& p_other) const
+        {
+            return modificationTime == p_other.modificationTime && size == p_other.size;
+        }
+        bool operator!=(const FileVersion& p_other) const
+        {
+            return !(*this == p_other);
+        }
+    };
+
+    const std::string m_path;
+    ApplyFunction m_apply;
+
+    mutable std::mutex m_currentMutex;
+    std::shared_ptr<const MdibIndex> m_current;
+    // Version of the active MDIB, only advanced once a version was applied
+    FileVersion m_applied;
+    // Last version that failed, retried on every check but only reported once
+    FileVersion m_rejected;
+
+    std::atomic<bool> m_running{false};
+    std::mutex m_waitMutex;
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+
+    // False if the file does not exist
+    static bool fileVersion(const std::string& p_path, FileVersion& p_version);
+
+public:
+    MdibReloader(std::string p_path, std::shared_ptr<const MdibIndex> p_current, ApplyFunction p_apply);
+    ~MdibReloader();
+
+    /**
+     * @brief Reloads the file in case its modification time or size differ from the version applied last.
+     * @return false if the new file could not be parsed, validated or applied. The active MDIB stays unchanged then
+     * and the file is tried again on the next check, e.g. after it was written completely.
+     */
+    bool reloadIfChanged();
+
+    void run(std::chrono::milliseconds p_interval);
+    void stop();
+
+    std::shared_ptr<const MdibIndex> getCurrent() const;
+};
@@ -0,0 +1,465 @@
+#include "MdibStreamLoader.h"
+
+#include "XmlCompactWriter.h"
+#include "XmlStreamReader.h"
+
+#include <algorithm>
+#include <fstream>
+#include <memory>
+
+using namespace ORTable;
+
+namespace
+{
+    constexpr std::uint64_t FNV_OFFSET_BASIS{14695981039346656037ULL};
+    constexpr std::uint64_t FNV_PRIME{1099511628211ULL};
+
+    std::uint64_t hashString(StringView p_value, std::uint64_t p_hash = FNV_OFFSET_BASIS)
+    {
+        for(const auto c : p_value)
+        {
+            p_hash ^= static_cast<unsigned char>(c);
+            p_hash *= FNV_PRIME;
+        }
+        return p_hash;
+    }
+
+    std::uint64_t combine(std::uint64_t p_hash, std::uint64_t p_value)
+    {
+        return p_hash ^ (p_value + 0x9E3779B97F4A7C15ULL + (p_hash << 6) + (p_hash >> 2));
+    }
+
+    // Attribute order carries no meaning in XML, so the attribute hashes are summed up
+    std::uint64_t hashAttributes(const std::vector<XmlAttribute>& p_attributes, const char* p_ignored)
+    {
+        std::uint64_t sum = 0;
+        for(const auto& attribute : p_attributes)
+        {
+            if(attribute.name == p_ignored)
+            {
+                continue;
+            }
+            sum += hashString(attribute.value, hashString(attribute.name));
+        }
+        return sum;
+    }
+
+    const std::string* findAttribute(const std::vector<XmlAttribute>& p_attributes, const char* p_name)
+    {
+        for(const auto& attribute : p_attributes)
+        {
+            if(attribute.name == p_name)
+            {
+                return &attribute.value;
+            }
+        }
+        return nullptr;
+    }
+
+    std::string attributeOrEmpty(const std::vector<XmlAttribute>& p_attributes, const char* p_name)
+    {
+        const auto value = findAttribute(p_attributes, p_name);
+        return value ? *value : std::string();
+    }
+
+    enum class Section
+    {
+        None,
+        Description,
+        State
+    };
+
+    /**
+     * @brief Builds the MdibModel from the reader events. Every descriptor (element with a Handle inside MdDescription)
+     * and every state (element with a DescriptorHandle inside MdState) becomes one entry, all other elements are folded
+     * into the content hash of the descriptor/state they belong to.
+     */
+    class MdibModelBuilder : public XmlStreamHandler
+    {
+    private:
+        struct Frame
+        {
+            int descriptor{-1};
+            int state{-1};
+            int fragment{-1};
+            bool isSource{false};
+            std::size_t namespaceCount{0};
+        };
+
+        // Compact XML of one descriptor/state, written while its element is open
+        struct Fragment
+        {
+            std::string xml;
+            XmlCompactWriter writer{xml};
+        };
+
+        XmlStreamReader& m_reader;
+        MdibModel& m_model;
+        XmlStreamHandler* m_forward{nullptr};
+        bool m_keepFragments{false};
+
+        Section m_section{Section::None};
+        std::vector<Frame> m_frames;
+        bool m_rootSeen{false};
+
+        // xmlns declarations in scope, fragments need them to be parseable on their own
+        std::vector<XmlAttribute> m_namespaces;
+        std::vector<std::unique_ptr<Fragment>> m_fragments;
+
+        std::uint64_t* ownerHash()
+        {
+            for(auto it = m_frames.rbegin(); it != m_frames.rend(); ++it)
+            {
+                if(it->descriptor >= 0)
+                {
+                    return &m_model.descriptors[static_cast<std::size_t>(it->descriptor)].contentHash;
+                }
+                if(it->state >= 0)
+                {
+                    return &m_model.states[static_cast<std::size_t>(it->state)].contentHash;
+                }
+            }
+            return nullptr;
+        }
+
+        XmlCompactWriter* ownerWriter()
+        {
+            for(auto it = m_frames.rbegin(); it != m_frames.rend(); ++it)
+            {
+                if(it->descriptor >= 0 || it->state >= 0)
+                {
+                    return it->fragment >= 0 ? &m_fragments[static_cast<std::size_t>(it->fragment)]->writer : nullptr;
+                }
+            }
+            return nullptr;
+        }
+
+        void startFragment(const std::string& p_name, const std::vector<XmlAttribute>& p_attributes, Frame& p_frame)
+        {
+            auto attributes = p_attributes;
+            for(auto it = m_namespaces.rbegin(); it != m_namespaces.rend(); ++it)
+            {
+                const auto& name = it->name;
+                const auto declared = std::find_if(attributes.begin(), attributes.end(), [&name](const XmlAttribute& p_attribute) {
+                    return p_attribute.name == name;
+                });
+                if(declared == attributes.end())
+                {
+                    attributes.push_back(*it);
+                }
+            }
+            p_frame.fragment = static_cast<int>(m_fragments.size());
+            m_fragments.push_back(std::make_unique<Fragment>());
+            m_fragments.back()->writer.onStartElement(p_name, attributes);
+        }
+
+        int ownerDescriptor() const
+        {
+            for(auto it = m_frames.rbegin(); it != m_frames.rend(); ++it)
+            {
+                if(it->descriptor >= 0)
+                {
+                    return it->descriptor;
+                }
+            }
+            return -1;
+        }
+
+        void startDescriptor(StringView p_localName, const std::vector<XmlAttribute>& p_attributes, Frame& p_frame)
+        {
+            MdibDescriptor descriptor;
+            descriptor.handle = *findAttribute(p_attributes, "Handle");
+            descriptor.element = std::string(p_localName);
+            const auto type = findAttribute(p_attributes, "xsi:type");
+            descriptor.type = std::string(type ? XmlStreamReader::localName(*type) : p_localName);
+            descriptor.descriptorVersion = attributeOrEmpty(p_attributes, "DescriptorVersion");
+
+            const auto parent = ownerDescriptor();
+            if(parent >= 0)
+            {
+                descriptor.parentHandle = m_model.descriptors[static_cast<std::size_t>(parent)].handle;
+            }
+            for(const auto reference : {"OperationTarget", "ConditionSignaled"})
+            {
+                const auto value = findAttribute(p_attributes, reference);
+                if(value)
+                {
+                    descriptor.references.emplace_back(reference, *value);
+                }
+            }
+            for(const auto attribute : {"Kind", "Priority", "Latching", "Manifestation"})
+            {
+                const auto value = findAttribute(p_attributes, attribute);
+                if(value)
+                {
+                    descriptor.attributes.emplace_back(attribute, *value);
+                }
+            }
+            descriptor.contentHash = combine(hashString(p_localName), hashAttributes(p_attributes, "DescriptorVersion"));
+
+            p_frame.descriptor = static_cast<int>(m_model.descriptors.size());
+            m_model.descriptors.push_back(std::move(descriptor));
+        }
+
+        void startState(StringView p_localName, const std::vector<XmlAttribute>& p_attributes, Frame& p_frame)
+        {
+            MdibState state;
+            state.descriptorHandle = *findAttribute(p_attributes, "DescriptorHandle");
+            state.handle = attributeOrEmpty(p_attributes, "Handle");
+            const auto type = findAttribute(p_attributes, "xsi:type");
+            state.type = std::string(type ? XmlStreamReader::localName(*type) : p_localName);
+            for(const auto attribute : {"ContextAssociation", "BindingStartTime", "BindingEndTime"})
+            {
+                const auto value = findAttribute(p_attributes, attribute);
+                if(value)
+                {
+                    state.attributes.emplace_back(attribute, *value);
+                }
+            }
+            state.contentHash = combine(hashString(p_localName), hashAttributes(p_attributes, "StateVersion"));
+
+            p_frame.state = static_cast<int>(m_model.states.size());
+            m_model.states.push_back(std::move(state));
+        }
+
+    public:
+        MdibModelBuilder(XmlStreamReader& p_reader, MdibModel& p_model, XmlStreamHandler* p_forward, bool p_keepFragments)
+            : m_reader(p_reader)
+            , m_model(p_model)
+            , m_forward(p_forward)
+            , m_keepFragments(p_keepFragments)
+        {
+        }
+
+        void onStartElement(const std::string& p_name, const std::vector<XmlAttribute>& p_attributes) override
+        {
+            if(m_forward)
+            {
+                m_forward->onStartElement(p_name, p_attributes);
+            }
+
+            const auto localName = XmlStreamReader::localName(p_name);
+            Frame frame;
+            // The owner has to be determined before the new namespaces and frame are pushed
+            const auto writer = ownerWriter();
+
+            frame.namespaceCount = m_namespaces.size();
+            for(const auto& attribute : p_attributes)
+            {
+                if(attribute.name.compare(0, 5, "xmlns") == 0)
+                {
+                    m_namespaces.push_back(attribute);
+                }
+            }
+
+            if(!m_rootSeen)
+            {
+                m_rootSeen = true;
+                if(localName != "GetMdibResponse" && localName != "Mdib")
+                {
+                    m_reader.abort("unexpected root element <" + p_name + ">, expected GetMdibResponse or Mdib");
+                    return;
+                }
+            }
+
+            if(localName == "Mdib")
+            {
+                m_model.sequenceId = attributeOrEmpty(p_attributes, "SequenceId");
+                m_model.mdibVersion = attributeOrEmpty(p_attributes, "MdibVersion");
+            }
+            else if(localName == "MdDescription" && m_section == Section::None)
+            {
+                m_section = Section::Description;
+                m_model.descriptionVersion = attributeOrEmpty(p_attributes, "DescriptionVersion");
+            }
+            else if(localName == "MdState" && m_section == Section::None)
+            {
+                m_section = Section::State;
+            }
+            else if(m_section == Section::Description && findAttribute(p_attributes, "Handle"))
+            {
+                startDescriptor(localName, p_attributes, frame);
+                m_model.descriptors.back().line = m_reader.getLine();
+                if(m_keepFragments)
+                {
+                    startFragment(p_name, p_attributes, frame);
+                }
+            }
+            else if(m_section == Section::State && localName == "State" && ownerHash() == nullptr)
+            {
+                if(!findAttribute(p_attributes, "DescriptorHandle"))
+                {
+                    m_reader.abort("state without DescriptorHandle");
+                    return;
+                }
+                startState(localName, p_attributes, frame);
+                m_model.states.back().line = m_reader.getLine();
+                if(m_keepFragments)
+                {
+                    startFragment(p_name, p_attributes, frame);
+                }
+            }
+            else if(const auto hash = ownerHash())
+            {
+                // Non-descriptor content of a descriptor/state
+                *hash = combine(*hash, combine(hashString(localName), hashAttributes(p_attributes, "")));
+                frame.isSource = localName == "Source" && ownerDescriptor() >= 0;
+                if(writer)
+                {
+                    writer->onStartElement(p_name, p_attributes);
+                }
+            }
+
+            m_frames.push_back(frame);
+        }
+
+        void onEndElement(const std::string& p_name) override
+        {
+            if(m_forward)
+            {
+                m_forward->onEndElement(p_name);
+            }
+            if(m_frames.empty())
+            {
+                return;
+            }
+            const auto frame = m_frames.back();
+            m_frames.pop_back();
+            m_namespaces.resize(frame.namespaceCount);
+
+            if(frame.fragment >= 0)
+            {
+                auto& fragment = *m_fragments.back();
+                fragment.writer.onEndElement(p_name);
+                auto& xml = frame.descriptor >= 0 ? m_model.descriptors[static_cast<std::size_t>(frame.descriptor)].xml
+                                                  : m_model.states[static_cast<std::size_t>(frame.state)].xml;
+                xml = std::move(fragment.xml);
+                m_fragments.pop_back();
+            }
+            else if(frame.descriptor < 0 && frame.state < 0)
+            {
+                const auto localName = XmlStreamReader::localName(p_name);
+                if(localName == "MdDescription" || localName == "MdState")
+                {
+                    m_section = Section::None;
+                }
+                else if(const auto hash = ownerHash())
+                {
+                    // Closing marker, so <a/><b/> and <a><b/></a> hash differently
+                    *hash = combine(*hash, 0x2F);
+                    if(const auto writer = ownerWriter())
+                    {
+                        writer->onEndElement(p_name);
+                    }
+                }
+            }
+        }
+
+        void onText(const std::string& p_text) override
+        {
+            if(m_forward)
+            {
+                m_forward->onText(p_text);
+            }
+            if(m_frames.empty())
+            {
+                return;
+            }
+            if(m_frames.back().isSource)
+            {
+                auto& descriptor = m_model.descriptors[static_cast<std::size_t>(ownerDescriptor())];
+                descriptor.references.emplace_back("Source", p_text);
+            }
+            if(const auto hash = ownerHash())
+            {
+                *hash = combine(*hash, hashString(p_text));
+            }
+            if(const auto writer = ownerWriter())
+            {
+                writer->onText(p_text);
+            }
+        }
+    };
+} // namespace
+
+
+MdibLoadResult::MdibLoadResult(std::string p_error, std::size_t p_line, std::size_t p_column)
+    : m_success(false)
+    , m_error(std::move(p_error))
+    , m_line(p_line)
+    , m_column(p_column)
+{
+}
+
+bool MdibLoadResult::success() const
+{
+    return m_success;
+}
+
+std::string MdibLoadResult::getError() const
+{
+    return std::to_string(m_line) + ":" + std::to_string(m_column) + ": " + m_error;
+}
+
+std::size_t MdibLoadResult::getLine() const
+{
+    return m_line;
+}
+
+std::size_t MdibLoadResult::getColumn() const
+{
+    return m_column;
+}
+
+
+MdibLoadResult MdibStreamLoader::load(std::istream& p_stream,
+                                      MdibModel& p_model,
+                                      std::string* p_compactDocument,
+                                      bool p_keepFragments)
+{
+    p_model = MdibModel();
+
+    std::unique_ptr<XmlCompactWriter> writer;
+    if(p_compactDocument)
+    {
+        p_compactDocument->clear();
+        writer = std::make_unique<XmlCompactWriter>(*p_compactDocument);
+    }
+
+    XmlStreamReader reader;
+    MdibModelBuilder builder(reader, p_model, writer.get(), p_keepFragments);
+    if(!reader.parse(p_stream, builder))
+    {
+        const auto& error = reader.getError();
+        return MdibLoadResult(error.getMessage(), error.getLine(), error.getColumn());
+    }
+    if(p_model.descriptors.empty())
+    {
+        return MdibLoadResult("MDIB contains no descriptors", 0, 0);
+    }
+    return MdibLoadResult();
+}
+
+MdibLoadResult MdibStreamLoader::loadFile(const std::string& p_path,
+                                          MdibModel& p_model,
+                                          std::string* p_compactDocument,
+                                          bool p_keepFragments)
+{
+    std::ifstream file(p_path, std::ios::binary);
+    if(!file)
+    {
+        return MdibLoadResult("could not open " + p_path, 0, 0);
+    }
+    if(p_compactDocument)
+    {
+        // Without indentation the compact document fits into the size of the file, so it is allocated once
+        file.seekg(0, std::ios::end);
+        const auto size = file.tellg();
+        file.seekg(0, std::ios::beg);
+        if(size > 0)
+        {
+            p_compactDocument->reserve(static_cast<std::size_t>(size));
+        }
+    }
+    return load(file, p_model, p_compactDocument, p_keepFragments);
+}
@@ -0,0 +1,52 @@
+/**
+ * @brief Loads an MDIB document (GetMdibResponse or Mdib root) in chunks and builds the MdibModel on the fly.
+ * There is no intermediate DOM: memory usage while loading is bounded by the chunk size and the resulting model.
+ * Optionally a compact copy of the document (no indentation, no comments) is produced for ProviderAPI::SDCProvider::loadMdib.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "MdibModel.h"
+
+#include <cstddef>
+#include <istream>
+#include <string>
+
+class MdibLoadResult
+{
+private:
+    bool m_success{true};
+    std::string m_error;
+    std::size_t m_line{0};
+    std::size_t m_column{0};
+
+public:
+    MdibLoadResult() = default;
+    MdibLoadResult(std::string p_error, std::size_t p_line, std::size_t p_column);
+
+    bool success() const;
+    // Error message prefixed with "line:column"
+    std::string getError() const;
+    std::size_t getLine() const;
+    std::size_t getColumn() const;
+};
+
+class MdibStreamLoader
+{
+public:
+    /**
+     * @param p_compactDocument receives the compacted document if set
+     * @param p_keepFragments fills MdibDescriptor::xml and MdibState::xml, needed to apply description modifications
+     */
+    static MdibLoadResult load(std::istream& p_stream,
+                               MdibModel& p_model,
+                               std::string* p_compactDocument = nullptr,
+                               bool p_keepFragments = false);
+    static MdibLoadResult loadFile(const std::string& p_path,
+                                   MdibModel& p_model,
+                                   std::string* p_compactDocument = nullptr,
+                                   bool p_keepFragments = false);
+};
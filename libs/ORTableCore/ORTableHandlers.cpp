@@ -0,0 +1,223 @@
+#include "ORTableHandlers.h"
+
+#include "Common/DateTimeHelper.h"
+
+#include "Logging/LogBroker.h"
+
+#include "ParticipantModel/PM/AbstractContextState.h"
+#include "ParticipantModel/PM/AlertSignalState.h"
+
+#include "MdibCommits.h"
+#include "MdibHandles.h"
+#include "Tracing.h"
+
+using namespace Logging;
+using namespace ProviderAPI;
+using namespace ProviderAPI::StateHandler;
+
+ORTableSetStringHandler::ORTableSetStringHandler(std::shared_ptr<VirtualORTableModel> p_table)
+    : m_table(std::move(p_table))
+{
+}
+
+void ORTableSetStringHandler::onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::SetStringStates>> p_transactionHandler)
+{
+    ORTABLE_TRACE_SCOPE("provider", "SetString.onNewTransaction");
+    /*
+
+    TODO
+    When receiving the MDC_OR_TABLE_SETSTRING_PREDEFINED_POSITIONS_SCO operation, set the predefined position of m_table accordingly. Then, transition to "FIN"
+    */
+}
+
+ORTableActivateHandler::ORTableActivateHandler(std::shared_ptr<VirtualORTableModel> p_table,
+                                               std::shared_ptr<CommandPipeline> p_pipeline)
+    : m_table(std::move(p_table))
+    , m_pipeline(std::move(p_pipeline))
+{
+    using ORTable::ActivateOperation;
+    using ORTable::CommandCode;
+    using ORTable::Handle;
+    namespace Mdib = ORTable::Mdib;
+
+    // Height moves by 1 cm, the angles by 0.1 degree
+    m_commands = {
+        {Handle<ActivateOperation, Mdib::ActivateIncreaseTableHeightSco>::value(), {CommandCode::MoveHeight, 1.0}},
+        {Handle<ActivateOperation, Mdib::ActivateDecreaseTableHeightSco>::value(), {CommandCode::MoveHeight, -1.0}},
+        {Handle<ActivateOperation, Mdib::ActivateIncreaseTrendSco>::value(), {CommandCode::MoveTrend, 0.1}},
+        {Handle<ActivateOperation, Mdib::ActivateDecreaseTrendSco>::value(), {CommandCode::MoveTrend, -0.1}},
+        {Handle<ActivateOperation, Mdib::ActivateIncreaseTiltSco>::value(), {CommandCode::MoveTilt, 0.1}},
+        {Handle<ActivateOperation, Mdib::ActivateDecreaseTiltSco>::value(), {CommandCode::MoveTilt, -0.1}},
+        {Handle<ActivateOperation, Mdib::ActivateIncreaseBackplateSco>::value(), {CommandCode::MoveBackplate, 0.1}},
+        {Handle<ActivateOperation, Mdib::ActivateDecreaseBackplateSco>::value(), {CommandCode::MoveBackplate, -0.1}},
+        {Handle<ActivateOperation, Mdib::ActivateApplyPredefinedPosition>::value(), {CommandCode::ApplyPosition, 0}},
+    };
+}
+
+void ORTableActivateHandler::onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::ActivateStates>> p_transactionHandler)
+{
+    ORTABLE_TRACE_SCOPE("provider", "Activate.onNewTransaction");
+    p_transactionHandler->transitionFromEntryTo(UserInterfaces::Set::OnEntryInvocationState::Wait);
+
+    const auto entry = m_commands.find(p_transactionHandler->getOperationHandleRef().getValue());
+    if(entry == m_commands.end())
+    {
+        p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
+        p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fail);
+        return;
+    }
+    auto command = entry->second;
+    if(command.code == ORTable::CommandCode::ApplyPosition)
+    {
+        command.argument = static_cast<double>(m_table->getPredefinedPosition());
+    }
+
+    if(!m_pipeline)
+    {
+        p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
+        p_transactionHandler->transitionFromStartedTo(m_table->apply(command) ? UserInterfaces::Set::OnStartedInvocationState::Fin
+                                                                              : UserInterfaces::Set::OnStartedInvocationState::Fail);
+        return;
+    }
+
+    // The transaction waits while the command is queued behind a full window, starts when the command is sent
+    // and finishes with the acknowledgement of exactly this command, independent of the others in flight
+    m_pipeline->submit(
+        command,
+        [p_transactionHandler]() {
+            p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
+        },
+        [p_transactionHandler](CommandResult p_result) {
+            p_transactionHandler->transitionFromStartedTo(p_result == CommandResult::Done
+                                                              ? UserInterfaces::Set::OnStartedInvocationState::Fin
+                                                              : UserInterfaces::Set::OnStartedInvocationState::Fail);
+        });
+}
+
+ORTableSetContextStateHandler::ORTableSetContextStateHandler(ProviderAPI::SDCProvider* p_provider,
+                                                             std::shared_ptr<ContextStateStore> p_contexts,
+                                                             std::mutex& p_commitMutex)
+    : m_provider(p_provider)
+    , m_contexts(std::move(p_contexts))
+    , m_commitMutex(p_commitMutex)
+{
+}
+
+void ORTableSetContextStateHandler::onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::SetContextStates>> p_transactionHandler)
+{
+    ORTABLE_TRACE_SCOPE("provider", "SetContextState.onNewTransaction");
+    using namespace ParticipantModel::PM;
+
+    p_transactionHandler->transitionFromEntryTo(UserInterfaces::Set::OnEntryInvocationState::Wait);
+    p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
+
+    std::lock_guard<std::mutex> lock(m_commitMutex);
+
+    // The request fails as a whole, so all states are checked before the first one is applied
+    const auto& proposedStates = p_transactionHandler->getProposedContextStates();
+    for(const auto& state : proposedStates)
+    {
+        const auto result = m_contexts->validate(state->getDescriptorHandle().getValue(),
+                                                 state->getHandle() ? state->getHandle()->getValue() : std::string());
+        if(!result.success())
+        {
+            LogBroker::getInstance().log(LogMessage("ORTableProvider", Severity::Notice, "SetContextState rejected: " + result.getError()));
+            p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fail);
+            return;
+        }
+    }
+
+    const auto now = static_cast<long long>(DateTimeHelper::millisecondsSinceEpoch());
+    std::unordered_map<std::string, std::shared_ptr<AbstractContextState>> proposed;
+    m_contexts->begin();
+    for(const auto& state : proposedStates)
+    {
+        auto association = ::ContextAssociation::NoAssociation;
+        if(state->getContextAssociation())
+        {
+            switch(*state->getContextAssociation())
+            {
+                case ContextAssociation::Pre:
+                    association = ::ContextAssociation::PreAssociated;
+                    break;
+                case ContextAssociation::Assoc:
+                    association = ::ContextAssociation::Associated;
+                    break;
+                case ContextAssociation::Dis:
+                    association = ::ContextAssociation::Disassociated;
+                    break;
+                default:
+                    break;
+            }
+        }
+
+        const auto result = m_contexts->apply(state->getDescriptorHandle().getValue(),
+                                              state->getHandle() ? state->getHandle()->getValue() : std::string(),
+                                              association,
+                                              now);
+        proposed[result.getHandle()] = state;
+    }
+
+    if(!commitContextChanges(m_provider, *m_contexts, proposed))
+    {
+        // The MDIB kept the states from before the request, so does the store
+        m_contexts->rollback();
+        p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fail);
+        return;
+    }
+    m_contexts->end();
+    p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fin);
+}
+
+ORTableSetAlertStateHandler::ORTableSetAlertStateHandler(std::shared_ptr<AlertStateEngine> p_alerts,
+                                                         std::shared_ptr<AlertAggregator> p_aggregator)
+    : m_alerts(std::move(p_alerts))
+    , m_aggregator(std::move(p_aggregator))
+{
+}
+
+void ORTableSetAlertStateHandler::onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::SetAlertStates>> p_transactionHandler)
+{
+    ORTABLE_TRACE_SCOPE("provider", "SetAlertState.onNewTransaction");
+    p_transactionHandler->transitionFromEntryTo(UserInterfaces::Set::OnEntryInvocationState::Wait);
+    p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
+
+    // Only signal presences can be set remotely, conditions are evaluated by the provider
+    const auto proposedState = std::dynamic_pointer_cast<ParticipantModel::PM::AlertSignalState>(p_transactionHandler->getProposedAlertState());
+    if(!proposedState || !proposedState->getPresence())
+    {
+        p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fail);
+        return;
+    }
+
+    auto requested = AlertSignalPresence::On;
+    switch(*proposedState->getPresence())
+    {
+        case ParticipantModel::PM::AlertSignalPresence::Ack:
+            requested = AlertSignalPresence::Acknowledged;
+            break;
+        case ParticipantModel::PM::AlertSignalPresence::Off:
+            requested = AlertSignalPresence::Off;
+            break;
+        case ParticipantModel::PM::AlertSignalPresence::Latch:
+            requested = AlertSignalPresence::Latched;
+            break;
+        default:
+            break;
+    }
+
+    const auto handle = proposedState->getDescriptorHandle().getValue();
+    const auto result = m_alerts->requestSignalPresence(handle, requested);
+    if(!result.success())
+    {
+        LogBroker::getInstance().log(LogMessage("ORTableProvider", Severity::Notice, "SetAlertState rejected: " + result.getError()));
+        p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fail);
+        return;
+    }
+
+    // The transaction finishes with the commit of the new presence, which the aggregator may hold back for a while
+    m_aggregator->notify(handle, [p_transactionHandler](bool p_published) {
+        p_transactionHandler->transitionFromStartedTo(p_published ? UserInterfaces::Set::OnStartedInvocationState::Fin
+                                                                  : UserInterfaces::Set::OnStartedInvocationState::Fail);
+    });
+}
@@ -0,0 +1,118 @@
+/**
+ * @brief External control handlers of the OR table for the SetString, Activate, SetContextState and SetAlertState
+ * operations. Each handler drives the transactions of its operations to their final invocation state.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "ProviderAPI/SDCProvider.h"
+#include "ProviderAPI/StateHandler/ExternalControlHandler.h"
+#include "ProviderAPI/StateHandler/TransactionHandler.h"
+#include "ProviderAPI/StateHandler/SetOperationStatesContainer/ActivateStates.h"
+#include "ProviderAPI/StateHandler/SetOperationStatesContainer/SetAlertStates.h"
+#include "ProviderAPI/StateHandler/SetOperationStatesContainer/SetContextStates.h"
+#include "ProviderAPI/StateHandler/SetOperationStatesContainer/SetStringStates.h"
+
+#include "AlertAggregator.h"
+#include "AlertStateEngine.h"
+#include "CommandPipeline.h"
+#include "ContextStateStore.h"
+#include "TableProtocol.h"
+#include "VirtualORTable.h"
+
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+/**
+ * @brief This state handler is used for SetString requests. On each SetString request for an enabled operation,
+ * the "onNewTransaction"-method is triggered. Here, the predefined position of the table is selected.
+ */
+class ORTableSetStringHandler
+    : public ProviderAPI::StateHandler::ExternalControlHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::SetStringStates>
+{
+private:
+    std::shared_ptr<VirtualORTableModel> m_table;
+
+public:
+    explicit ORTableSetStringHandler(std::shared_ptr<VirtualORTableModel> p_table);
+
+    // call to user code
+    virtual void onNewTransaction(
+        std::shared_ptr<ProviderAPI::StateHandler::TransactionHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::SetStringStates>>
+            p_transactionHandler) override;
+};
+
+/**
+ * @brief This state handler is used for Activate requests. On each Activate request for an enabled operation,
+ * the "onNewTransaction"-method is triggered. Here, the Activate is turned into a command for the table controller,
+ * or applied to the table model if there is none.
+ */
+class ORTableActivateHandler
+    : public ProviderAPI::StateHandler::ExternalControlHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::ActivateStates>
+{
+private:
+    std::shared_ptr<VirtualORTableModel> m_table;
+    // Null when no table controller is connected
+    std::shared_ptr<CommandPipeline> m_pipeline;
+    std::unordered_map<std::string, ORTable::TableCommand> m_commands;
+
+public:
+    ORTableActivateHandler(std::shared_ptr<VirtualORTableModel> p_table, std::shared_ptr<CommandPipeline> p_pipeline);
+
+    // call to user code
+    virtual void onNewTransaction(
+        std::shared_ptr<ProviderAPI::StateHandler::TransactionHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::ActivateStates>>
+            p_transactionHandler) override;
+};
+
+/**
+ * @brief This state handler is used for SetContextState requests. On each SetContextState request for an enabled operation,
+ * the "onNewTransaction"-method is triggered. Here, the proposed states are applied to the context state store and
+ * all resulting changes are committed at once.
+ */
+class ORTableSetContextStateHandler
+    : public ProviderAPI::StateHandler::ExternalControlHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::SetContextStates>
+{
+private:
+    ProviderAPI::SDCProvider* m_provider{nullptr};
+    std::shared_ptr<ContextStateStore> m_contexts;
+    // A request is applied and committed as a whole, concurrent requests and compactions do not interleave
+    std::mutex& m_commitMutex;
+
+public:
+    ORTableSetContextStateHandler(ProviderAPI::SDCProvider* p_provider,
+                                  std::shared_ptr<ContextStateStore> p_contexts,
+                                  std::mutex& p_commitMutex);
+
+    // call to user code
+    virtual void onNewTransaction(
+        std::shared_ptr<ProviderAPI::StateHandler::TransactionHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::SetContextStates>>
+            p_transactionHandler) override;
+};
+
+/**
+ * @brief This state handler is used for SetAlert requests. On each SetAlert request for an enabled operation,
+ * the "onNewTransaction"-method is triggered. Here, the requested signal presence (Ack/Off) is applied to the
+ * alert state engine and the resulting changes are handed to the aggregator for publishing. The transaction
+ * finishes once the aggregator committed the new presence, with Fail if the commit was rejected.
+ */
+class ORTableSetAlertStateHandler
+    : public ProviderAPI::StateHandler::ExternalControlHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::SetAlertStates>
+{
+private:
+    std::shared_ptr<AlertStateEngine> m_alerts;
+    std::shared_ptr<AlertAggregator> m_aggregator;
+
+public:
+    ORTableSetAlertStateHandler(std::shared_ptr<AlertStateEngine> p_alerts, std::shared_ptr<AlertAggregator> p_aggregator);
+
+    // call to user code
+    virtual void onNewTransaction(
+        std::shared_ptr<ProviderAPI::StateHandler::TransactionHandler<ProviderAPI::StateHandler::SetOperationStatesContainer::SetAlertStates>>
+            p_transactionHandler) override;
+};
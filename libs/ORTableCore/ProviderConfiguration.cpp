@@ -0,0 +1,109 @@
+#include "ProviderConfiguration.h"
+
+#include "Logging/LogBroker.h"
+
+#include "MdibHandles.h"
+
+#include <chrono>
+#include <fstream>
+
+using namespace Logging;
+
+std::shared_ptr<MessageModel::DPWS::ThisModel> prepareModelDescription()
+{
+    using namespace MessageModel::DPWS;
+
+    std::vector<ThisModel::Manufacturer> manufacturerNames;
+    manufacturerNames.push_back(ThisModel::Manufacturer{{"SurgiTAIX"}});
+
+    std::vector<ThisModel::ModelName> modelNames;
+    modelNames.push_back(ThisModel::ModelName{{"sdcX OR Table Demo Provider"}});
+
+    auto model = std::make_shared<ThisModel>(std::move(manufacturerNames), std::move(modelNames));
+    model->setModelUrl(XS::AnyURI("http://surgitaix.com"));
+    model->setPresentationUrl(ThisModel::PresentationUrl{"http://surgitaix.com"});
+    model->setManufacturerUrl(ThisModel::ManufacturerUrl{"http://surgitaix.com"});
+    model->setModelNumber(ThisModel::ModelNumber{"1234"});
+
+    return model;
+}
+
+std::shared_ptr<MessageModel::DPWS::ThisDevice> prepareDeviceDescription()
+{
+    using namespace MessageModel::DPWS;
+
+    std::vector<ThisDevice::FriendlyName> friendlyNames;
+    friendlyNames.emplace_back(std::string{"sdcX OR Table Demo Provider"});
+
+    auto device = std::make_shared<ThisDevice>(std::move(friendlyNames));
+    device->setSerialNumber(ThisDevice::SerialNumber("4567"));
+    device->setFirmwareVersion(ThisDevice::FirmwareVersion{"1.3.0"});
+    return device;
+}
+
+std::shared_ptr<Config::TLSConfig> createTLSConfig()
+{
+    auto tlsConfig = std::make_shared<Config::TLSConfig>();
+
+    tlsConfig->setTrustedAuthorityLocation("./certificates/pat_ca.pem");
+    tlsConfig->setCertificateLocation("./certificates/pat_cert.pem");
+    tlsConfig->setPrivateKeyLocation("./certificates/pat_private.pem");
+
+    return tlsConfig;
+}
+
+std::shared_ptr<Config::ProviderConfig> createProviderConfig(const std::string& p_epr,
+                                                             bool p_enableTls,
+                                                             std::shared_ptr<SDCCommon::DataTypes::NetworkInterface> p_networkInterface,
+                                                             const SDCCommon::DataTypes::NetworkAddress p_localAddress)
+{
+    auto config = std::make_shared<Config::ProviderConfig>(p_epr,
+                                                           (p_enableTls ? createTLSConfig() : nullptr),
+                                                           prepareModelDescription(),
+                                                           prepareDeviceDescription(),
+                                                           p_localAddress,
+                                                           p_networkInterface);
+
+    return config;
+}
+
+EscalationTable createEscalationTable()
+{
+    EscalationTable escalationTable;
+
+    if(std::ifstream("ORTableEscalation.txt"))
+    {
+        std::string error;
+        if(escalationTable.loadFile("ORTableEscalation.txt", error))
+        {
+            return escalationTable;
+        }
+        LogBroker::getInstance().log(
+            LogMessage("ORTableProvider", Severity::Error, "Ignoring ORTableEscalation.txt:" + error));
+        escalationTable = EscalationTable();
+    }
+
+    using ORTable::AlertCondition;
+    using ORTable::Handle;
+    namespace Mdib = ORTable::Mdib;
+    for(const auto handle : {Handle<AlertCondition, Mdib::HeightUpper>::value(),
+                             Handle<AlertCondition, Mdib::HeightLower>::value(),
+                             Handle<AlertCondition, Mdib::TrendUpper>::value(),
+                             Handle<AlertCondition, Mdib::TrendLower>::value(),
+                             Handle<AlertCondition, Mdib::TiltUpper>::value(),
+                             Handle<AlertCondition, Mdib::TiltLower>::value(),
+                             Handle<AlertCondition, Mdib::BackplateUpper>::value(),
+                             Handle<AlertCondition, Mdib::BackplateLower>::value()})
+    {
+        escalationTable.add(handle, {std::chrono::seconds(10), AlertPriority::Hi});
+    }
+    return escalationTable;
+}
+
+ContextRetentionPolicy createContextRetentionPolicy()
+{
+    ContextRetentionPolicy policy;
+    policy.keepLast = 100;
+    policy.maxAge = std::chrono::hours(24 * 7);
+    return policy;
+}
@@ -0,0 +1,40 @@
+/**
+ * @brief Builders of the provider configuration: the DPWS model and device description, the TLS and provider config,
+ * and the policies of the alert escalation and the context retention.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "SDCCore/Prerequisites.h"
+#include "ProviderAPI/SDCProvider.h"
+
+#include "AlertEscalation.h"
+#include "ContextStateStore.h"
+
+#include <memory>
+#include <string>
+
+// The model and device description data are send to a consumer answering Get Request (DPWS).
+// They contain general information of the model, such as the model and manucaturers name and
+// the device such as the serial number or firmware version
+std::shared_ptr<MessageModel::DPWS::ThisModel> prepareModelDescription();
+std::shared_ptr<MessageModel::DPWS::ThisDevice> prepareDeviceDescription();
+
+// generates config that contains the locations of the TLS-certificates
+std::shared_ptr<Config::TLSConfig> createTLSConfig();
+
+// The Provider config contains all information needed to set up a provider. The configs content is described in the regarding class.
+std::shared_ptr<Config::ProviderConfig> createProviderConfig(const std::string& p_epr,
+                                                             bool p_enableTls,
+                                                             std::shared_ptr<SDCCommon::DataTypes::NetworkInterface> p_networkInterface,
+                                                             const SDCCommon::DataTypes::NetworkAddress p_localAddress);
+
+// builder for the alert escalation table. By default every axis alert escalates to high priority after
+// 10 seconds of presence. If ORTableEscalation.txt exists next to the executable, its steps are used instead
+EscalationTable createEscalationTable();
+
+// Disassociated patients and workflows are kept for a week, at most the last 100 per context descriptor
+ContextRetentionPolicy createContextRetentionPolicy();
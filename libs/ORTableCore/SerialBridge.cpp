@@ -0,0 +1,400 @@
+#include "SerialBridge.h"
+
+#include "Logging/LogBroker.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/uio.h>
+#include <termios.h>
+#include <unistd.h>
+
+using namespace Logging;
+using namespace ORTable;
+
+namespace
+{
+    bool speedOf(unsigned int p_baudRate, speed_t& p_speed)
+    {
+        switch(p_baudRate)
+        {
+            case 9600:
+                p_speed = B9600;
+                return true;
+            case 19200:
+                p_speed = B19200;
+                return true;
+            case 38400:
+                p_speed = B38400;
+                return true;
+            case 57600:
+                p_speed = B57600;
+                return true;
+            case 115200:
+                p_speed = B115200;
+                return true;
+            case 230400:
+                p_speed = B230400;
+                return true;
+            case 460800:
+                p_speed = B460800;
+                return true;
+            case 921600:
+                p_speed = B921600;
+                return true;
+            default:
+                return false;
+        }
+    }
+} // namespace
+
+SerialBridge::SerialBridge(SerialBridgeConfig p_config,
+                           TelemetryFunction p_onTelemetry,
+                           AckFunction p_onAck,
+                           ConnectionFunction p_onConnection)
+    : m_config(std::move(p_config))
+    , m_onTelemetry(std::move(p_onTelemetry))
+    , m_onAck(std::move(p_onAck))
+    , m_onConnection(std::move(p_onConnection))
+    // A complete frame always fits, so the parser can make progress
+    , m_receiveBuffer(std::max(m_config.bufferSize, 2 * TableProtocol::MAX_FRAME_SIZE))
+    , m_sendBuffer(std::max(m_config.bufferSize, 2 * TableProtocol::MAX_FRAME_SIZE))
+{
+}
+
+SerialBridge::~SerialBridge()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+bool SerialBridge::openPort()
+{
+    const int port = ::open(m_config.device.c_str(), O_RDWR | O_NOCTTY | O_NONBLOCK | O_CLOEXEC);
+    if(port < 0)
+    {
+        return false;
+    }
+
+    // Raw 8N1 without flow control, reads return whatever is available
+    termios settings;
+    if(tcgetattr(port, &settings) == 0)
+    {
+        cfmakeraw(&settings);
+        settings.c_cflag |= CLOCAL | CREAD;
+        settings.c_cflag &= ~static_cast<tcflag_t>(CSTOPB | CRTSCTS);
+        settings.c_cc[VMIN] = 0;
+        settings.c_cc[VTIME] = 0;
+        speed_t speed;
+        if(!speedOf(m_config.baudRate, speed))
+        {
+            LogBroker::getInstance().log(LogMessage(
+                "SerialBridge", Severity::Error, "Unsupported baud rate " + std::to_string(m_config.baudRate) + ", using 115200"));
+            speed = B115200;
+        }
+        cfsetispeed(&settings, speed);
+        cfsetospeed(&settings, speed);
+        tcsetattr(port, TCSANOW, &settings);
+        tcflush(port, TCIOFLUSH);
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = port;
+    if(epoll_ctl(m_epoll, EPOLL_CTL_ADD, port, &event) != 0)
+    {
+        ::close(port);
+        return false;
+    }
+    m_port = port;
+    m_writeInterest = false;
+    m_receiveBuffer.consume(m_receiveBuffer.size());
+    {
+        // Commands queued for the lost connection are outdated
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_sendBuffer.consume(m_sendBuffer.size());
+        if(m_wasConnected)
+        {
+            ++m_counters.reconnects;
+        }
+        m_wasConnected = true;
+    }
+    m_connected = true;
+
+    LogBroker::getInstance().log(LogMessage("SerialBridge", Severity::Notice, "Connected to " + m_config.device));
+    if(m_onConnection)
+    {
+        m_onConnection(true);
+    }
+    return true;
+}
+
+void SerialBridge::closePort()
+{
+    if(m_port < 0)
+    {
+        return;
+    }
+    epoll_ctl(m_epoll, EPOLL_CTL_DEL, m_port, nullptr);
+    ::close(m_port);
+    m_port = -1;
+    m_connected = false;
+
+    LogBroker::getInstance().log(LogMessage("SerialBridge", Severity::Notice, "Lost connection to " + m_config.device));
+    if(m_onConnection)
+    {
+        m_onConnection(false);
+    }
+}
+
+void SerialBridge::updateWriteInterest(bool p_enable)
+{
+    if(m_port < 0 || m_writeInterest == p_enable)
+    {
+        return;
+    }
+    epoll_event event{};
+    event.events = p_enable ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+    event.data.fd = m_port;
+    epoll_ctl(m_epoll, EPOLL_CTL_MOD, m_port, &event);
+    m_writeInterest = p_enable;
+}
+
+bool SerialBridge::readPort()
+{
+    while(true)
+    {
+        const auto regions = m_receiveBuffer.writable();
+        iovec vectors[2]{{regions[0].data, regions[0].size}, {regions[1].data, regions[1].size}};
+        const auto received = ::readv(m_port, vectors, regions[1].size > 0 ? 2 : 1);
+        if(received > 0)
+        {
+            m_receiveBuffer.produce(static_cast<std::size_t>(received));
+            m_parser.parse(m_receiveBuffer, [this](const Frame& p_frame) { dispatch(p_frame); });
+
+            std::lock_guard<std::mutex> lock(m_mutex);
+            const auto& parserCounters = m_parser.getCounters();
+            m_counters.bytesReceived += static_cast<std::uint64_t>(received);
+            m_counters.frames = parserCounters.frames;
+            m_counters.crcErrors = parserCounters.crcErrors;
+            m_counters.headerErrors = parserCounters.headerErrors;
+            m_counters.droppedBytes = parserCounters.droppedBytes;
+            continue;
+        }
+        if(received < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        // A tty in raw mode returns 0 instead of EAGAIN when drained. A lost port shows as EIO or EPOLLHUP
+        return received == 0 || errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+}
+
+bool SerialBridge::writePort()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    while(!m_sendBuffer.empty())
+    {
+        const auto regions = m_sendBuffer.readable();
+        iovec vectors[2]{{const_cast<std::uint8_t*>(regions[0].data), regions[0].size},
+                         {const_cast<std::uint8_t*>(regions[1].data), regions[1].size}};
+        const auto sent = ::writev(m_port, vectors, regions[1].size > 0 ? 2 : 1);
+        if(sent < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            if(errno == EAGAIN || errno == EWOULDBLOCK)
+            {
+                // Continue as soon as the port drained
+                updateWriteInterest(true);
+                return true;
+            }
+            return false;
+        }
+        m_sendBuffer.consume(static_cast<std::size_t>(sent));
+        m_counters.bytesSent += static_cast<std::uint64_t>(sent);
+    }
+    updateWriteInterest(false);
+    return true;
+}
+
+void SerialBridge::dispatch(const Frame& p_frame)
+{
+    switch(p_frame.type)
+    {
+        case FrameType::Telemetry:
+        {
+            TableTelemetry telemetry;
+            if(TableProtocol::decodeTelemetry(p_frame, telemetry) && m_onTelemetry)
+            {
+                m_onTelemetry(telemetry);
+            }
+            break;
+        }
+        case FrameType::Ack:
+        {
+            AckStatus status;
+            if(TableProtocol::decodeAck(p_frame, status) && m_onAck)
+            {
+                m_onAck(p_frame.sequence, status);
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void SerialBridge::signalWakeUp()
+{
+    const std::uint64_t one{1};
+    const auto written = ::write(m_wakeUp, &one, sizeof(one));
+    static_cast<void>(written);
+}
+
+void SerialBridge::drainWakeUp()
+{
+    std::uint64_t value;
+    const auto received = ::read(m_wakeUp, &value, sizeof(value));
+    static_cast<void>(received);
+}
+
+void SerialBridge::loop()
+{
+    epoll_event events[4];
+    // A lost port is not reopened right away, e.g. a pty whose other side closed would be lost again immediately
+    bool waitBeforeOpen{false};
+    while(m_running)
+    {
+        if(m_port < 0 && (waitBeforeOpen || !openPort()))
+        {
+            waitBeforeOpen = false;
+            // Only the wake up is registered, so this waits for the next attempt or stop()
+            const auto count = epoll_wait(m_epoll, events, 4, static_cast<int>(m_config.reconnectInterval.count()));
+            if(count > 0)
+            {
+                drainWakeUp();
+            }
+            continue;
+        }
+
+        const auto count = epoll_wait(m_epoll, events, 4, -1);
+        if(count < 0)
+        {
+            if(errno == EINTR)
+            {
+                continue;
+            }
+            LogBroker::getInstance().log(LogMessage("SerialBridge", Severity::Error, std::string("epoll_wait failed: ") + std::strerror(errno)));
+            break;
+        }
+
+        bool lost{false};
+        bool wokenUp{false};
+        for(int i = 0; i < count; ++i)
+        {
+            if(events[i].data.fd == m_wakeUp)
+            {
+                drainWakeUp();
+                wokenUp = true;
+                continue;
+            }
+            if(events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR))
+            {
+                // Data received before a hang up is still delivered
+                lost = !readPort() || (events[i].events & (EPOLLHUP | EPOLLERR)) != 0;
+            }
+            if(!lost && (events[i].events & EPOLLOUT))
+            {
+                lost = !writePort();
+            }
+        }
+        // Queued commands are written right away, EPOLLOUT is only used while the port is congested
+        if(!lost && wokenUp && !m_writeInterest)
+        {
+            lost = !writePort();
+        }
+        if(lost)
+        {
+            closePort();
+            waitBeforeOpen = true;
+        }
+    }
+    closePort();
+}
+
+bool SerialBridge::send(const TableCommand& p_command, std::uint16_t p_sequence)
+{
+    std::uint8_t frame[TableProtocol::MAX_FRAME_SIZE];
+    const auto size = TableProtocol::encodeCommand(p_command, p_sequence, frame);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_connected || !m_sendBuffer.write(frame, size))
+        {
+            return false;
+        }
+    }
+    signalWakeUp();
+    return true;
+}
+
+bool SerialBridge::isConnected() const
+{
+    return m_connected;
+}
+
+SerialBridgeCounters SerialBridge::getCounters() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_counters;
+}
+
+bool SerialBridge::run()
+{
+    m_epoll = epoll_create1(EPOLL_CLOEXEC);
+    m_wakeUp = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_epoll < 0 || m_wakeUp < 0)
+    {
+        LogBroker::getInstance().log(LogMessage("SerialBridge", Severity::Error, "Could not create epoll instance"));
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.fd = m_wakeUp;
+    epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeUp, &event);
+
+    m_running = true;
+    m_thread = std::thread([this]() { loop(); });
+    return true;
+}
+
+void SerialBridge::stop()
+{
+    m_running = false;
+    if(m_wakeUp >= 0)
+    {
+        signalWakeUp();
+    }
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+    if(m_wakeUp >= 0)
+    {
+        ::close(m_wakeUp);
+        m_wakeUp = -1;
+    }
+    if(m_epoll >= 0)
+    {
+        ::close(m_epoll);
+        m_epoll = -1;
+    }
+}
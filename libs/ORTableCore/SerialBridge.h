@@ -0,0 +1,110 @@
+/**
+ * @brief Connection to the table controller on a serial port (RS232, USB serial adapter or a pty for testing).
+ * One I/O thread waits on the port with epoll, reads straight into a ring buffer, parses the frames in place and hands
+ * telemetry and acknowledgements to the callbacks as soon as they arrive. Commands are queued into a second ring
+ * buffer and written by the same thread whenever the port accepts data, so senders never block on the line.
+ *
+ * A lost port (e.g. an unplugged adapter) is reopened periodically.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "RingBuffer.h"
+#include "TableProtocol.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+
+struct SerialBridgeConfig
+{
+    std::string device;
+    unsigned int baudRate{115200};
+    std::chrono::milliseconds reconnectInterval{1000};
+    // Size of the receive and the send buffer each
+    std::size_t bufferSize{4096};
+};
+
+struct SerialBridgeCounters
+{
+    std::uint64_t bytesReceived{0};
+    std::uint64_t bytesSent{0};
+    std::uint64_t frames{0};
+    std::uint64_t crcErrors{0};
+    std::uint64_t headerErrors{0};
+    std::uint64_t droppedBytes{0};
+    std::uint64_t reconnects{0};
+};
+
+class SerialBridge
+{
+public:
+    // Both are called on the I/O thread
+    using TelemetryFunction = std::function<void(const ORTable::TableTelemetry& p_telemetry)>;
+    using AckFunction = std::function<void(std::uint16_t p_sequence, ORTable::AckStatus p_status)>;
+    // Called on the I/O thread whenever the port is opened or lost
+    using ConnectionFunction = std::function<void(bool p_connected)>;
+
+private:
+    const SerialBridgeConfig m_config;
+    TelemetryFunction m_onTelemetry;
+    AckFunction m_onAck;
+    ConnectionFunction m_onConnection;
+
+    int m_port{-1};
+    int m_epoll{-1};
+    // Wakes the I/O thread for queued commands and stop()
+    int m_wakeUp{-1};
+    bool m_writeInterest{false};
+
+    // Only touched by the I/O thread
+    ORTable::RingBuffer m_receiveBuffer;
+    ORTable::FrameParser m_parser;
+
+    // Guards the send buffer and the counters
+    mutable std::mutex m_mutex;
+    ORTable::RingBuffer m_sendBuffer;
+    SerialBridgeCounters m_counters;
+    bool m_wasConnected{false};
+
+    std::atomic<bool> m_connected{false};
+    std::atomic<bool> m_running{false};
+    std::thread m_thread;
+
+    bool openPort();
+    void closePort();
+    void updateWriteInterest(bool p_enable);
+    bool readPort();
+    bool writePort();
+    void dispatch(const ORTable::Frame& p_frame);
+    void signalWakeUp();
+    void drainWakeUp();
+    void loop();
+
+public:
+    SerialBridge(SerialBridgeConfig p_config,
+                 TelemetryFunction p_onTelemetry,
+                 AckFunction p_onAck,
+                 ConnectionFunction p_onConnection = nullptr);
+    ~SerialBridge();
+
+    SerialBridge(const SerialBridge&) = delete;
+    SerialBridge& operator=(const SerialBridge&) = delete;
+
+    // Queues a command, returns false if the port is not open or the send buffer is full
+    bool send(const ORTable::TableCommand& p_command, std::uint16_t p_sequence);
+
+    bool isConnected() const;
+    SerialBridgeCounters getCounters() const;
+
+    // Returns false if epoll is not available
+    bool run();
+    void stop();
+};
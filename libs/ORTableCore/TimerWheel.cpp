@@ -0,0 +1,135 @@
+#include "TimerWheel.h"
+
+#include <algorithm>
+
+constexpr TimerWheel::TimerId TimerWheel::INVALID_TIMER;
+
+TimerWheel::TimerWheel(std::chrono::milliseconds p_resolution, std::size_t p_slots)
+    : m_resolution(std::max<Clock::duration>(p_resolution, std::chrono::milliseconds(1)))
+    , m_start(Clock::now())
+    , m_slots(std::max<std::size_t>(p_slots, 1))
+{
+}
+
+TimerWheel::~TimerWheel()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+std::uint64_t TimerWheel::tickOf(Clock::time_point p_time) const
+{
+    if(p_time <= m_start)
+    {
+        return 0;
+    }
+    return static_cast<std::uint64_t>((p_time - m_start) / m_resolution);
+}
+
+TimerWheel::TimerId TimerWheel::schedule(Clock::duration p_delay, Callback p_callback)
+{
+    const auto deadline = Clock::now() + p_delay;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    // Rounded up, a timer never fires early. Ticks already visited are skipped
+    auto tick = tickOf(deadline);
+    if(m_start + tick * m_resolution < deadline)
+    {
+        ++tick;
+    }
+    tick = std::max(tick, m_currentTick + 1);
+
+    const auto id = m_nextId++;
+    m_timers.emplace(id, Timer{deadline, std::move(p_callback)});
+    m_slots[tick % m_slots.size()].push_back(id);
+    return id;
+}
+
+bool TimerWheel::cancel(TimerId p_timer)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timers.erase(p_timer) > 0;
+}
+
+std::size_t TimerWheel::pending() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_timers.size();
+}
+
+std::size_t TimerWheel::advance(Clock::time_point p_now)
+{
+    std::vector<Callback> due;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        const auto nowTick = tickOf(p_now);
+        if(nowTick <= m_currentTick)
+        {
+            return 0;
+        }
+        // After a stall longer than one round every slot is visited once
+        const auto steps = std::min<std::uint64_t>(nowTick - m_currentTick, m_slots.size());
+        for(std::uint64_t step = 1; step <= steps; ++step)
+        {
+            auto& slot = m_slots[(m_currentTick + step) % m_slots.size()];
+            for(std::size_t i = 0; i < slot.size();)
+            {
+                const auto timer = m_timers.find(slot[i]);
+                const bool cancelled = timer == m_timers.end();
+                if(!cancelled && timer->second.deadline > p_now)
+                {
+                    // Due in a later round
+                    ++i;
+                    continue;
+                }
+                if(!cancelled)
+                {
+                    due.push_back(std::move(timer->second.callback));
+                    m_timers.erase(timer);
+                }
+                slot[i] = slot.back();
+                slot.pop_back();
+            }
+        }
+        m_currentTick = nowTick;
+    }
+
+    for(auto& callback : due)
+    {
+        callback();
+    }
+    return due.size();
+}
+
+void TimerWheel::run()
+{
+    m_running = true;
+    m_thread = std::thread([this]() {
+        auto next = Clock::now() + m_resolution;
+        while(m_running)
+        {
+            {
+                std::unique_lock<std::mutex> lock(m_waitMutex);
+                m_wakeUp.wait_until(lock, next, [this]() { return !m_running; });
+            }
+            advance(Clock::now());
+            // Aligned to the tick grid, so a slow callback does not shift later timers
+            next = m_start + (tickOf(Clock::now()) + 1) * m_resolution;
+        }
+    });
+}
+
+void TimerWheel::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_waitMutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_all();
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
@@ -0,0 +1,78 @@
+/**
+ * @brief Hashed timing wheel for many short-lived timers, e.g. alert escalations. Scheduling and cancelling are O(1),
+ * a tick only visits the timers of one slot. Timers fire on the wheel thread with an accuracy of one resolution step,
+ * independent of any other update loop of the provider.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class TimerWheel
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    using TimerId = std::uint64_t;
+    using Callback = std::function<void()>;
+
+    static constexpr TimerId INVALID_TIMER{0};
+
+private:
+    struct Timer
+    {
+        Clock::time_point deadline;
+        Callback callback;
+    };
+
+    const Clock::duration m_resolution;
+    const Clock::time_point m_start;
+
+    mutable std::mutex m_mutex;
+    // A timer is listed in the slot of its deadline tick. Ids of cancelled timers are dropped when the slot is visited
+    std::vector<std::vector<TimerId>> m_slots;
+    std::unordered_map<TimerId, Timer> m_timers;
+    std::uint64_t m_currentTick{0};
+    TimerId m_nextId{1};
+
+    std::atomic<bool> m_running{false};
+    std::mutex m_waitMutex;
+    std::condition_variable m_wakeUp;
+    std::thread m_thread;
+
+    std::uint64_t tickOf(Clock::time_point p_time) const;
+
+public:
+    // The wheel covers p_slots * p_resolution per round, longer delays take several rounds
+    explicit TimerWheel(std::chrono::milliseconds p_resolution = std::chrono::milliseconds(10), std::size_t p_slots = 512);
+    ~TimerWheel();
+
+    TimerWheel(const TimerWheel&) = delete;
+    TimerWheel& operator=(const TimerWheel&) = delete;
+
+    TimerId schedule(Clock::duration p_delay, Callback p_callback);
+    // Returns false if the timer already fired or was cancelled before
+    bool cancel(TimerId p_timer);
+    std::size_t pending() const;
+
+    /**
+     * @brief Fires all timers due at the given time. Callbacks are invoked without holding the internal lock,
+     * so they may schedule or cancel timers themselves.
+     * @return the number of fired timers
+     */
+    std::size_t advance(Clock::time_point p_now);
+
+    void run();
+    void stop();
+};
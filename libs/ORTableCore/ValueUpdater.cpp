@@ -0,0 +1,168 @@
+#include "ValueUpdater.h"
+
+#include "ProviderAPI/MDIBAccess/ProviderMDIBAccess.h"
+
+#include "Common/DateTimeHelper.h"
+
+#include "Logging/LogBroker.h"
+
+#include "MdibHandles.h"
+#include "Tracing.h"
+
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace Logging;
+
+ValueUpdater::ValueUpdater(ProviderAPI::SDCProvider* p_provider,
+                           std::shared_ptr<VirtualORTableModel> p_table,
+                           std::shared_ptr<AlertStateEngine> p_alerts,
+                           std::shared_ptr<AlertEscalator> p_escalator,
+                           std::shared_ptr<AlertAggregator> p_aggregator)
+    : m_provider(p_provider)
+    , m_table(std::move(p_table))
+    , m_alerts(std::move(p_alerts))
+    , m_escalator(std::move(p_escalator))
+    , m_aggregator(std::move(p_aggregator))
+{
+    resolveAlarmLimits();
+}
+
+ValueUpdater::~ValueUpdater()
+{
+    if(m_running)
+    {
+        stop();
+    }
+}
+
+void ValueUpdater::resolveAlarmLimits()
+{
+    using ORTable::AlertCondition;
+    using ORTable::Handle;
+    namespace Mdib = ORTable::Mdib;
+
+    const AlarmLimit limits[]{
+        {Handle<AlertCondition, Mdib::HeightUpper>::value(), &VirtualORTable::height, 135, 140},
+        {Handle<AlertCondition, Mdib::HeightLower>::value(), &VirtualORTable::height, 60, 65},
+        {Handle<AlertCondition, Mdib::TrendUpper>::value(), &VirtualORTable::trend, 40, 45},
+        {Handle<AlertCondition, Mdib::TrendLower>::value(), &VirtualORTable::trend, -45, -40},
+        {Handle<AlertCondition, Mdib::TiltUpper>::value(), &VirtualORTable::tilt, 20, 25},
+        {Handle<AlertCondition, Mdib::TiltLower>::value(), &VirtualORTable::tilt, -25, -20},
+        {Handle<AlertCondition, Mdib::BackplateUpper>::value(), &VirtualORTable::backplate, 75, 80},
+        {Handle<AlertCondition, Mdib::BackplateLower>::value(), &VirtualORTable::backplate, -40, -35},
+    };
+    m_alarmLimits.clear();
+    for(const auto& limit : limits)
+    {
+        const auto condition = m_alerts->findCondition(limit.conditionHandle);
+        if(condition == AlertStateEngine::NO_ENTRY)
+        {
+            LogBroker::getInstance().log(LogMessage(
+                "ORTableProvider", Severity::Error, std::string("Alert condition missing in Mdib: ") + limit.conditionHandle));
+            continue;
+        }
+        m_alarmLimits.emplace_back(condition, limit);
+    }
+}
+
+void ValueUpdater::applyChanges()
+{
+    ORTABLE_TRACE_SCOPE("provider", "applyChanges");
+    namespace Mdib = ORTable::Mdib;
+
+    // An idle table does not cause a commit every interval
+    const auto table = m_table->getTable();
+    bool changed = m_positions.update<Mdib::Height>(table.height);
+    changed = m_positions.update<Mdib::Trend>(table.trend) || changed;
+    changed = m_positions.update<Mdib::Tilt>(table.tilt) || changed;
+    changed = m_positions.update<Mdib::Backplate>(table.backplate) || changed;
+    if(!changed)
+    {
+        return;
+    }
+    auto time = DateTimeHelper::millisecondsSinceEpoch();
+
+
+    // Update changes 
+    auto updateAccess = m_provider->getMDIBGateway()->makeUpdateAccess();
+
+    /*   
+        TODO 
+        Update the numeric metric values using the given update access,
+        e.g. MDC_OR_TABLE_HEIGHT to m_positions.get<Mdib::Height>()
+    */
+
+    ORTABLE_TRACE_SCOPE("provider", "commit");
+    auto result = m_provider->getMDIBGateway()->commit(std::move(updateAccess));
+    if (!result.success())
+    {
+        std::cout << "Update of values not successful: " + result.getError();
+    }
+}
+
+void ValueUpdater::applyAlarms()
+{
+    ORTABLE_TRACE_SCOPE("provider", "applyAlarms");
+    // Check the margins and trigger the alert conditions and signals. The engine skips conditions whose presence
+    // did not change, so only actual transitions are published. Transitions of several axes, e.g. after applying
+    // a predefined position, end up in one report
+    if(m_mdibReloaded.exchange(false))
+    {
+        resolveAlarmLimits();
+    }
+    const auto table = m_table->getTable();
+    for(const auto& entry : m_alarmLimits)
+    {
+        const auto value = table.*(entry.second.axis);
+        const bool present = value >= entry.second.lower && value <= entry.second.upper;
+        if(m_alerts->setConditionPresence(entry.first, present))
+        {
+            // Escalation runs on its own timers, the loop only reports the onset and end of a condition
+            m_escalator->onConditionPresence(entry.first, present);
+        }
+    }
+    m_aggregator->notify();
+}
+
+void ValueUpdater::notifyChanged()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_changed = true;
+    }
+    m_wakeUp.notify_one();
+}
+
+void ValueUpdater::onMdibReloaded()
+{
+    m_mdibReloaded = true;
+    notifyChanged();
+}
+
+void ValueUpdater::stop()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_wakeMutex);
+        m_running = false;
+    }
+    m_wakeUp.notify_one();
+    m_thread.join();
+}
+
+void ValueUpdater::run()
+{
+    m_thread = std::thread([&]() {
+        while(m_running)
+        {
+            applyChanges();
+            applyAlarms();
+
+            // With a table controller connected, telemetry wakes the loop right away
+            std::unique_lock<std::mutex> lock(m_wakeMutex);
+            m_wakeUp.wait_for(lock, std::chrono::milliseconds(500), [this]() { return m_changed || !m_running; });
+            m_changed = false;
+        }
+    });
+}
@@ -0,0 +1,84 @@
+/**
+ * @brief This class runs a task that updates the tables position values.
+ * The positions come from the table controller via the SerialBridge, or from the virtual table if there is none.
+ * In this case, the virtual table model is moved into SDC description. A pass without a changed position commits
+ * nothing. Each pass also checks the alarm limits of the axes and hands the resulting alert transitions to the
+ * escalator and the aggregator.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "ProviderAPI/SDCProvider.h"
+
+#include "AlertAggregator.h"
+#include "AlertEscalation.h"
+#include "AlertStateEngine.h"
+#include "MdibHandles.h"
+#include "VirtualORTable.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+class ValueUpdater
+{
+private:
+    // The alert condition is present while the axis value is within [lower, upper]
+    struct AlarmLimit
+    {
+        const char* conditionHandle;
+        double VirtualORTable::*axis;
+        double lower;
+        double upper;
+    };
+
+    ProviderAPI::SDCProvider* m_provider{nullptr};
+    std::shared_ptr<VirtualORTableModel> m_table;
+    std::shared_ptr<AlertStateEngine> m_alerts;
+    std::shared_ptr<AlertEscalator> m_escalator;
+    std::shared_ptr<AlertAggregator> m_aggregator;
+    // Limits with their condition resolved to the id of the engine, only used by the update loop
+    std::vector<std::pair<std::uint32_t, AlarmLimit>> m_alarmLimits;
+    // Positions of the last commit, only used by the update loop
+    ORTable::TypedStateTable<ORTable::NumericMetric> m_positions;
+    // Set by onMdibReloaded(), the loop resolves the limits again before its next pass
+    std::atomic<bool> m_mdibReloaded{false};
+
+    std::atomic<bool> m_running{true};
+    std::thread m_thread;
+
+    // Set by notifyChanged(), wakes the update loop before its regular interval
+    std::mutex m_wakeMutex;
+    std::condition_variable m_wakeUp;
+    bool m_changed{false};
+
+    void resolveAlarmLimits();
+
+public:
+    ValueUpdater(ProviderAPI::SDCProvider* p_provider,
+                 std::shared_ptr<VirtualORTableModel> p_table,
+                 std::shared_ptr<AlertStateEngine> p_alerts,
+                 std::shared_ptr<AlertEscalator> p_escalator,
+                 std::shared_ptr<AlertAggregator> p_aggregator);
+    ~ValueUpdater();
+
+    void applyChanges();
+    void applyAlarms();
+
+    // Called when the table reported new positions, so they are published without waiting for the next interval
+    void notifyChanged();
+
+    // Called after the AlertStateEngine took over a reloaded MDIB, conditions may have been added or removed
+    void onMdibReloaded();
+
+    void stop();
+    void run();
+};
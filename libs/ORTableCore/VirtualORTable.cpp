@@ -0,0 +1,117 @@
+#include "VirtualORTable.h"
+
+#include <algorithm>
+#include <cstddef>
+
+namespace
+{
+    struct AxisRange
+    {
+        double minimum;
+        double maximum;
+        // Units per second of the drive
+        double speed;
+    };
+
+    // Height, trend, tilt, backplate
+    constexpr AxisRange AXES[]{
+        {60, 140, 2.0},
+        {-45, 45, 3.0},
+        {-25, 25, 3.0},
+        {-40, 80, 5.0},
+    };
+
+    std::chrono::milliseconds fullTravel(const AxisRange& p_axis)
+    {
+        return std::chrono::milliseconds(static_cast<long long>((p_axis.maximum - p_axis.minimum) / p_axis.speed * 1000));
+    }
+} // namespace
+
+VirtualORTable VirtualORTableModel::getTable() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_table;
+}
+
+PredefinedPosition VirtualORTableModel::getPredefinedPosition() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_table.predefinedPosition;
+}
+
+void VirtualORTableModel::setPredefinedPosition(PredefinedPosition p_position)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.predefinedPosition = p_position;
+}
+
+void VirtualORTableModel::applyTelemetry(const ORTable::TableTelemetry& p_telemetry)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_table.height = p_telemetry.height;
+    m_table.trend = p_telemetry.trend;
+    m_table.tilt = p_telemetry.tilt;
+    m_table.backplate = p_telemetry.backplate;
+}
+
+bool VirtualORTableModel::apply(const ORTable::TableCommand& p_command)
+{
+    using ORTable::CommandCode;
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto move = [&p_command](double& p_axis, double p_minimum, double p_maximum) {
+        const auto value = p_axis + p_command.argument;
+        if(value < p_minimum || value > p_maximum)
+        {
+            return false;
+        }
+        p_axis = value;
+        return true;
+    };
+    switch(p_command.code)
+    {
+        case CommandCode::MoveHeight:
+            return move(m_table.height, AXES[0].minimum, AXES[0].maximum);
+        case CommandCode::MoveTrend:
+            return move(m_table.trend, AXES[1].minimum, AXES[1].maximum);
+        case CommandCode::MoveTilt:
+            return move(m_table.tilt, AXES[2].minimum, AXES[2].maximum);
+        case CommandCode::MoveBackplate:
+            return move(m_table.backplate, AXES[3].minimum, AXES[3].maximum);
+        case CommandCode::ApplyPosition:
+            // Null level: height 80, rest 0. Beach chair: height 80, trend 0, tilt 0, backplate 45
+            m_table.height = 80;
+            m_table.trend = 0;
+            m_table.tilt = 0;
+            m_table.backplate = m_table.predefinedPosition == PredefinedPosition::BeachChair ? 45 : 0;
+            return true;
+        default:
+            return false;
+    }
+}
+
+std::chrono::milliseconds VirtualORTableModel::travelTime(const ORTable::TableCommand& p_command)
+{
+    using ORTable::CommandCode;
+
+    switch(p_command.code)
+    {
+        case CommandCode::MoveHeight:
+        case CommandCode::MoveTrend:
+        case CommandCode::MoveTilt:
+        case CommandCode::MoveBackplate:
+            return fullTravel(AXES[static_cast<std::size_t>(p_command.code) - static_cast<std::size_t>(CommandCode::MoveHeight)]);
+        case CommandCode::ApplyPosition:
+        {
+            // All axes move at the same time
+            std::chrono::milliseconds longest{0};
+            for(const auto& axis : AXES)
+            {
+                longest = std::max(longest, fullTravel(axis));
+            }
+            return longest;
+        }
+        default:
+            return std::chrono::milliseconds(0);
+    }
+}
@@ -0,0 +1,56 @@
+/**
+ * @brief Model of the OR table: the value per axis and the selected predefined position. Without a table controller,
+ * Activate commands move the axes of the model directly, keeping their margins. With a controller, the axes follow
+ * its telemetry instead.
+ *
+ * Thread safe, the serial bridge writes the axes while the handlers and the ValueUpdater read them.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "TableProtocol.h"
+
+#include <chrono>
+#include <mutex>
+
+enum class PredefinedPosition
+{
+    NullLevel,
+    BeachChair
+};
+
+struct VirtualORTable
+{
+    double height = 80; // 60-140cm
+    double trend = 39.8; // -45 till +45 degrees
+    double tilt = 0; // -25 till +25 degrees
+    double backplate = 0; // -40 till +80 degrees
+    PredefinedPosition predefinedPosition = PredefinedPosition::NullLevel;
+};
+
+class VirtualORTableModel
+{
+private:
+    mutable std::mutex m_mutex;
+    VirtualORTable m_table;
+
+public:
+    // Copy of all axes, taken at once
+    VirtualORTable getTable() const;
+
+    PredefinedPosition getPredefinedPosition() const;
+    void setPredefinedPosition(PredefinedPosition p_position);
+
+    // Positions reported by the table controller
+    void applyTelemetry(const ORTable::TableTelemetry& p_telemetry);
+
+    // Moves the axes without a table controller, false if the command would leave the margins of the axis
+    bool apply(const ORTable::TableCommand& p_command);
+
+    // Longest time the table controller may take for the command: the whole range of the axes it moves at the speed
+    // of their drives. Moves of one axis complete one after the other, so a jog may wait for the ones before it
+    static std::chrono::milliseconds travelTime(const ORTable::TableCommand& p_command);
+};
@@ -0,0 +1,253 @@
+/**
+ * @brief Strongly typed MDIB handles. MdibHandles.h, generated from the MDIB at configure time, declares one tag per
+ * descriptor (e.g. Mdib::Height for MDC_OR_TABLE_HEIGHT) and specializes HandleTraits for it with the descriptor kind,
+ * the handle string and the slot of the handle among all handles of its kind. Code naming a handle by its tag fails to
+ * compile if the MDIB has no such descriptor or if it is of another kind, instead of failing a lookup at runtime.
+ *
+ *     Handle<NumericMetric, Mdib::Height>::value()   // "MDC_OR_TABLE_HEIGHT"
+ *
+ * TypedStateTable keeps the values of the states of some kinds in arrays indexed by slot, so update<Mdib::Height>(v),
+ * get<Mdib::Height>() and onUpdate<Mdib::Height>(cb) are plain array accesses. updateByHandle() is the runtime entry
+ * for handles that arrive as strings, e.g. in reports. Updates tell whether the value changed and only changes reach
+ * the callbacks, so the table also serves as a cheap change filter in front of commits and copies of the state.
+ *
+ * Not synchronized, the owner serializes access.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "StringView.h"
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ORTable
+{
+    // Descriptor kinds, named like the pm:*Descriptor types without the suffix
+    struct Mds {};
+    struct Vmd {};
+    struct Channel {};
+    struct Sco {};
+    struct SystemContext {};
+    struct PatientContext {};
+    struct LocationContext {};
+    struct EnsembleContext {};
+    struct WorkflowContext {};
+    struct OperatorContext {};
+    struct MeansContext {};
+    struct AlertSystem {};
+    struct AlertCondition {};
+    struct LimitAlertCondition {};
+    struct AlertSignal {};
+    struct NumericMetric {};
+    struct StringMetric {};
+    struct EnumStringMetric {};
+    struct RealTimeSampleArrayMetric {};
+    struct DistributionSampleArrayMetric {};
+    struct ActivateOperation {};
+    struct SetValueOperation {};
+    struct SetStringOperation {};
+    struct SetContextStateOperation {};
+    struct SetAlertStateOperation {};
+    struct SetComponentStateOperation {};
+    struct SetMetricStateOperation {};
+
+    // Specialized per tag by MdibHandles.h. An unknown tag ends up here and does not compile
+    template<typename Tag>
+    struct HandleTraits;
+
+    template<typename K, std::size_t Slot>
+    struct HandleDefinition
+    {
+        using Kind = K;
+        static constexpr std::size_t slot()
+        {
+            return Slot;
+        }
+    };
+
+    // Number of handles of a kind, specialized by MdibHandles.h for the kinds the MDIB has
+    template<typename Kind>
+    struct KindHandles : std::integral_constant<std::size_t, 0>
+    {
+        static const char* handle(std::size_t)
+        {
+            return nullptr;
+        }
+    };
+
+    template<typename Kind, typename Tag>
+    struct Handle
+    {
+        static_assert(std::is_same<typename HandleTraits<Tag>::Kind, Kind>::value, "The handle is of another descriptor kind");
+
+        static constexpr const char* value()
+        {
+            return HandleTraits<Tag>::handle();
+        }
+        static constexpr std::size_t slot()
+        {
+            return HandleTraits<Tag>::slot();
+        }
+    };
+
+    template<typename Tag>
+    constexpr const char* handleOf()
+    {
+        return HandleTraits<Tag>::handle();
+    }
+
+    // Slot of a handle given at runtime, KindHandles<Kind>::value if the MDIB has no such handle of that kind
+    template<typename Kind>
+    std::size_t slotOf(StringView p_handle)
+    {
+        std::size_t slot = 0;
+        for(; slot < KindHandles<Kind>::value; ++slot)
+        {
+            if(p_handle == KindHandles<Kind>::handle(slot))
+            {
+                break;
+            }
+        }
+        return slot;
+    }
+
+    // Value kept per state by TypedStateTable, only the kinds with a value can be put into one
+    template<typename Kind>
+    struct StateValue;
+    template<>
+    struct StateValue<NumericMetric>
+    {
+        using Type = double;
+    };
+    template<>
+    struct StateValue<StringMetric>
+    {
+        using Type = std::string;
+    };
+    template<>
+    struct StateValue<EnumStringMetric>
+    {
+        using Type = std::string;
+    };
+    // Presence of the signal, e.g. "On" or "Acknowledged"
+    template<>
+    struct StateValue<AlertSignal>
+    {
+        using Type = std::string;
+    };
+    // Presence of the condition
+    template<>
+    struct StateValue<AlertCondition>
+    {
+        using Type = bool;
+    };
+    template<>
+    struct StateValue<LimitAlertCondition>
+    {
+        using Type = bool;
+    };
+
+    template<typename Kind>
+    struct StateSlots
+    {
+        using Value = typename StateValue<Kind>::Type;
+        using Callback = std::function<void(const Value& p_value)>;
+
+        std::array<Value, KindHandles<Kind>::value> values{};
+        // False until the first update, so a first value equal to the default still counts as a change
+        std::array<bool, KindHandles<Kind>::value> known{};
+        std::array<std::vector<Callback>, KindHandles<Kind>::value> callbacks;
+    };
+
+    enum class StateUpdate
+    {
+        // The MDIB has no such handle of that kind
+        Unknown,
+        Unchanged,
+        Changed
+    };
+
+    template<typename... Kinds>
+    class TypedStateTable
+    {
+    public:
+        template<typename Tag>
+        using ValueOf = typename StateValue<typename HandleTraits<Tag>::Kind>::Type;
+        template<typename Tag>
+        using CallbackOf = std::function<void(const ValueOf<Tag>& p_value)>;
+
+    private:
+        std::tuple<StateSlots<Kinds>...> m_slots;
+
+        template<typename Kind>
+        StateSlots<Kind>& slotsOf()
+        {
+            return std::get<StateSlots<Kind>>(m_slots);
+        }
+        template<typename Kind>
+        const StateSlots<Kind>& slotsOf() const
+        {
+            return std::get<StateSlots<Kind>>(m_slots);
+        }
+
+        template<typename Kind>
+        bool store(std::size_t p_slot, typename StateValue<Kind>::Type p_value)
+        {
+            auto& slots = slotsOf<Kind>();
+            if(slots.known[p_slot] && slots.values[p_slot] == p_value)
+            {
+                return false;
+            }
+            slots.known[p_slot] = true;
+            slots.values[p_slot] = std::move(p_value);
+            for(const auto& callback : slots.callbacks[p_slot])
+            {
+                callback(slots.values[p_slot]);
+            }
+            return true;
+        }
+
+    public:
+        // Returns true if the value changed
+        template<typename Tag>
+        bool update(ValueOf<Tag> p_value)
+        {
+            return store<typename HandleTraits<Tag>::Kind>(HandleTraits<Tag>::slot(), std::move(p_value));
+        }
+
+        template<typename Tag>
+        const ValueOf<Tag>& get() const
+        {
+            return slotsOf<typename HandleTraits<Tag>::Kind>().values[HandleTraits<Tag>::slot()];
+        }
+
+        // Called with the new value whenever an update changes the state
+        template<typename Tag>
+        void onUpdate(CallbackOf<Tag> p_callback)
+        {
+            slotsOf<typename HandleTraits<Tag>::Kind>().callbacks[HandleTraits<Tag>::slot()].push_back(std::move(p_callback));
+        }
+
+        // For handles given at runtime
+        template<typename Kind>
+        StateUpdate updateByHandle(StringView p_handle, typename StateValue<Kind>::Type p_value)
+        {
+            const auto slot = slotOf<Kind>(p_handle);
+            if(slot == KindHandles<Kind>::value)
+            {
+                return StateUpdate::Unknown;
+            }
+            return store<Kind>(slot, std::move(p_value)) ? StateUpdate::Changed : StateUpdate::Unchanged;
+        }
+    };
+} // namespace ORTable
@@ -13,33 +13,40 @@
 #include "SDCCore/Core.h"
 #include "SDCCore/Prerequisites.h"
 #include "ProviderAPI/SDCProvider.h"
-#include "ProviderAPI/MDIBAccess/ProviderMDIBAccess.h"
-#include "ProviderAPI/ProviderCore/SetLayer/ProviderSetHandler.h"
-
-#include "Common/StringHelper.h"
-#include "Common/DateTimeHelper.h"
 
 #include "Logging/LogBroker.h"
 #include "Logging/Loggers/ConsoleLogger.h"
 #include "Logging/Loggers/FileLogger.h"
 
-#include "MessageModel/MSG/Activate.h"
-
-#include "ProviderAPI/StateHandler/ExternalControlHandler.h"
-#include "ProviderAPI/StateHandler/TransactionHandler.h"
-#include "ProviderAPI/StateHandler/SetOperationStatesContainer/SetValueStates.h"
-#include "ProviderAPI/StateHandler/SetOperationStatesContainer/SetStringStates.h"
-
-#include "ProviderAPI/StateHandler/SetOperationStatesContainer/ActivateStates.h"
-#include "ProviderAPI/StateHandler/DenyAllExternalControlHandler.h"
-
-#include "ParticipantModel/PM/StringMetricState.h"
+#include "AlertAggregator.h"
+#include "AlertEscalation.h"
+#include "AlertStateEngine.h"
+#include "CommandPipeline.h"
+#include "ContextCompactor.h"
+#include "ContextStateStore.h"
+#include "MdibCommits.h"
+#include "MdibDiff.h"
+#include "MdibIndex.h"
+#include "MdibModel.h"
+#include "MdibReloader.h"
+#include "MdibStreamLoader.h"
+#include "ORTableHandlers.h"
+#include "ProviderConfiguration.h"
+#include "TimerWheel.h"
+#include "Tracing.h"
+#include "ValueUpdater.h"
+#include "VirtualORTable.h"
+#ifdef ORTABLE_WITH_SERIAL_BRIDGE
+#include "SerialBridge.h"
+#endif
 
 #include <iostream>
 #include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
 #include <vector>
 #include <string>
-#include <thread>
 
 // Change this to a unique EPR
 const std::string PROVIDER_EPR("TODO");
@@ -47,321 +54,18 @@ const std::string PROVIDER_EPR("TODO");
 // In case the provider shall be started without TLS, set this variable to false
 constexpr bool ENABLE_TLS{true};
 
+// Serial port of the table controller, e.g. "/dev/ttyUSB0". Can be overridden by the environment variable
+// ORTABLE_SERIAL_DEVICE. Empty runs the virtual table without a controller
+const std::string SERIAL_DEVICE("");
+constexpr unsigned int SERIAL_BAUD_RATE{115200};
+// Time the controller may take to acknowledge a command on top of its movement
+constexpr std::chrono::milliseconds COMMAND_ACK_TIMEOUT{10000};
+
 // Using definitions for increased readability 
 using namespace Logging;
 using namespace ProviderAPI;
-using namespace ProviderAPI::StateHandler;
 using namespace std::chrono_literals;
 
-enum class PredefinedPosition
-{
-    NullLevel,
-    BeachChair
-};
-
-struct VirtualORTable
-{
-    double height = 80; // 60-140cm
-    double trend = 39.8; // -45 till +45
-    double tilt; // -25 till +25
-    double backplate; // -40 till +80
-    PredefinedPosition predefinedPosition;
-};
-
-// Global object for data access
-VirtualORTable virtualTable;
-
-/**
- * @brief This state handler is used for Activate requests. On each Activate request for an enabled operation,
- * the "onNewTransaction"-method is triggered. Here, the Activate is logged and the next mode is selected.
- */
-class ORTableSetStringHandler : public ExternalControlHandler<SetOperationStatesContainer::SetStringStates>
-{
-private:
-public:
-    ORTableSetStringHandler() = default;
-
-    // call to user code
-    virtual void
-        onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::SetStringStates>> p_transactionHandler) override
-    {
-        /* 
-        
-        TODO 
-        When receiving the MDC_OR_TABLE_SETSTRING_PREDEFINED_POSITIONS_SCO operation, set the virtualTable.predefinedPosition accordingly. Then, transition to "FIN" 
-        */
-    }
-};
-
-
-/**
- * @brief This state handler is used for Activate requests. On each Activate request for an enabled operation, 
- * the "onNewTransaction"-method is triggered. Here, the Activate is logged and the next mode is selected.
- */
-class ORTableActivateHandler : public ExternalControlHandler<SetOperationStatesContainer::ActivateStates>
-{
-private:
-public:
-    ORTableActivateHandler() = default;
-
-    // call to user code
-    virtual void 
-        onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::ActivateStates>> p_transactionHandler) override
-    {
-        /*
-            TODO
-            Upon receiving an activate on MDC_OR_TABLE_ACTIVATE_APPLY_PREDEFINED_POSITION, apply the predefined position in the virtual table
-            Nulllevel: Height 80, Rest 0
-            Beach Chair: Height 80, Trend 0, Tilt 0, Backplate 45
-
-            Upon receiving any other activate, increase/decrease the value by 1 (height), 0.1 (angles). Keep the margins in mind. 
-            Then, traverse directly to FIN
-        */
-    }
-};
-
-/**
- * @brief This state handler is used for SetContextState requests. On each SetContextState request for an enabled operation,
- * the "onNewTransaction"-method is triggered. Here, the SetContextState is logged and the next mode is selected.
- */
-class ORTableSetContextStateHandler : public ExternalControlHandler<SetOperationStatesContainer::SetContextStates>
-{
-private:
-public:
-    ORTableSetContextStateHandler() = default;
-
-    // call to user code
-    virtual void
-        onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::SetContextStates>> p_transactionHandler) override
-    {
-
-        p_transactionHandler->transitionFromEntryTo(UserInterfaces::Set::OnEntryInvocationState::Wait);
-        p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
-        p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fin);
-    }
-};
-
-
-/**
- * @brief This state handler is used for SetAlert requests. On each SetAlert request for an enabled operation,
- * the "onNewTransaction"-method is triggered. Here, the SetAlert is logged and the next mode is selected.
- */
-class ORTableSetAlertStateHandler : public ExternalControlHandler<SetOperationStatesContainer::SetAlertStates>
-{
-private:
-public:
-    ORTableSetAlertStateHandler() = default;
-
-    // call to user code
-    virtual void
-        onNewTransaction(std::shared_ptr<TransactionHandler<SetOperationStatesContainer::SetAlertStates>> p_transactionHandler) override
-    {
-
-        p_transactionHandler->transitionFromEntryTo(UserInterfaces::Set::OnEntryInvocationState::Wait);
-        p_transactionHandler->transitionFromWaitingTo(UserInterfaces::Set::OnWaitInvocationState::Start);
-        p_transactionHandler->transitionFromStartedTo(UserInterfaces::Set::OnStartedInvocationState::Fin);
-    }
-};
-
-
-// The model and device description data are send to a consumer answering Get Request (DPWS). 
-// They contain general information of the model, such as the model and manucaturers name and 
-// the device such as the serial number or firmware version
-std::shared_ptr<MessageModel::DPWS::ThisModel> prepareModelDescription()
-{
-    using namespace MessageModel::DPWS;
-
-    std::vector<ThisModel::Manufacturer> manufacturerNames;
-    manufacturerNames.push_back(ThisModel::Manufacturer{{"SurgiTAIX"}});
-
-    std::vector<ThisModel::ModelName> modelNames;
-    modelNames.push_back(ThisModel::ModelName{{"sdcX OR Table Demo Provider"}});
-
-    auto model = std::make_shared<ThisModel>(std::move(manufacturerNames), std::move(modelNames));
-    model->setModelUrl(XS::AnyURI("http://surgitaix.com"));
-    model->setPresentationUrl(ThisModel::PresentationUrl{"http://surgitaix.com"});
-    model->setManufacturerUrl(ThisModel::ManufacturerUrl{"http://surgitaix.com"});
-    model->setModelNumber(ThisModel::ModelNumber{"1234"});
-
-    return model;
-}
-std::shared_ptr<MessageModel::DPWS::ThisDevice> prepareDeviceDescription()
-{
-    using namespace MessageModel::DPWS;
-
-    std::vector<ThisDevice::FriendlyName> friendlyNames;
-    friendlyNames.emplace_back(std::string{"sdcX OR Table Demo Provider"});
-
-    auto device = std::make_shared<ThisDevice>(std::move(friendlyNames));
-    device->setSerialNumber(ThisDevice::SerialNumber("4567"));
-    device->setFirmwareVersion(ThisDevice::FirmwareVersion{"1.3.0"});
-    return device;
-}
-
-// generates config that contains the locations of the TLS-certificates
-std::shared_ptr<Config::TLSConfig> createTLSConfig()
-{
-    auto tlsConfig = std::make_shared<Config::TLSConfig>();
-
-    tlsConfig->setTrustedAuthorityLocation("./certificates/pat_ca.pem");
-    tlsConfig->setCertificateLocation("./certificates/pat_cert.pem");
-    tlsConfig->setPrivateKeyLocation("./certificates/pat_private.pem");
-
-    return tlsConfig;
-}
-
-// The Provider config contains all information needed to set up a provider. The configs content is described in the regarding class.
-std::shared_ptr<Config::ProviderConfig> createProviderConfig(std::shared_ptr<SDCCommon::DataTypes::NetworkInterface> p_networkInterface,
-                                                             const SDCCommon::DataTypes::NetworkAddress p_localAddress)
-{
-    auto config = std::make_shared<Config::ProviderConfig>(PROVIDER_EPR,
-                                                           (ENABLE_TLS ? createTLSConfig() : nullptr),
-                                                           prepareModelDescription(),
-                                                           prepareDeviceDescription(),
-                                                           p_localAddress,
-                                                           p_networkInterface);
-
-    return config;
-}
-
-
-// This class runs a task that updates the tables position values. 
-// Think of this as the RS232 connection that is regularly updated
-// In this case, the virtual table model is moved into SDC description
-class ValueUpdater
-{
-private:
-    ProviderAPI::SDCProvider* m_provider{nullptr};
-
-    std::atomic<bool> m_running{true};
-    std::thread m_thread;
-
-public:
-    
-    ValueUpdater(ProviderAPI::SDCProvider* p_provider)
-        : m_provider(p_provider)
-    {
-    }
-    ~ValueUpdater()
-    {
-        if(m_running)
-        {
-            stop();
-        }
-    }
-
-    void applyChanges()
-    {
-        auto time = DateTimeHelper::millisecondsSinceEpoch();
-
-
-        // Update changes 
-        auto updateAccess = m_provider->getMDIBGateway()->makeUpdateAccess();
-
-        /*   
-            TODO 
-            Update the numeric metric values using the given update access
-        */
-
-        auto result = m_provider->getMDIBGateway()->commit(std::move(updateAccess));
-        if (!result.success())
-        {
-            std::cout << "Update of values not successful: " + result.getError();
-        }
-    }
-
-    void applyAlarms()
-    {
-        auto time = DateTimeHelper::millisecondsSinceEpoch();
-
-        // Update changes 
-        auto updateAccess = m_provider->getMDIBGateway()->makeUpdateAccess();
-        
-        /*
-            TODO
-            Check the margins and trigger the alert conditions and signals
-            In case no alert is present, deactivate them
-        
-        */
-
-        // Height
-        if (virtualTable.height >= 135 && virtualTable.height <= 140)
-        {
-
-
-        }
-        else if (virtualTable.height <= 65 && virtualTable.height >= 60)
-        {
-
-        }
-        else
-        {
-        }
-        // Trend
-        if (virtualTable.trend >= 40 && virtualTable.trend <= 45)
-        {
-
-        }
-        else if (virtualTable.trend <= -40 && virtualTable.trend >= -45)
-        {
-
-        }
-        else
-        {
-        }
-        // Tilt
-        if (virtualTable.tilt >= 20 && virtualTable.tilt <= 25)
-        {
-
-        }
-        else if (virtualTable.tilt <= -20 && virtualTable.tilt >= -25)
-        {
-
-        }
-        else
-        {
-        }
-        // Back
-        if (virtualTable.backplate >= 75 && virtualTable.backplate <= 80)
-        {
-
-        }
-        else if (virtualTable.backplate <= -35 && virtualTable.backplate >= -40)
-        {
-
-        }
-        else
-        {
-        }
-
-        auto result = m_provider->getMDIBGateway()->commit(std::move(updateAccess));
-        if (!result.success())
-        {
-            std::cout << "Update of values not successful: " + result.getError();
-        }
-    }
-
-    void stop()
-    {
-        m_running = false;
-        m_thread.join();
-    }
-
-    void run()
-    {
-        m_thread = std::thread([&]() {
-            while(m_running)
-            {
-                applyChanges();
-                applyAlarms();
-
-                
-                std::this_thread::sleep_for(std::chrono::milliseconds(500));
-            }
-        });
-    }
-};
-
 int main()
 {
     /*
@@ -383,6 +87,12 @@ int main()
     // Log Level is managed centrally 
     LogBroker::getInstance().setLogLevel(Severity::Notice);
 
+    // Chrome trace of the run, if built with ORTABLE_TRACING and ORTABLE_TRACE_FILE is set
+    if(const char* traceFile = std::getenv("ORTABLE_TRACE_FILE"))
+    {
+        ORTABLE_TRACE_START(traceFile);
+    }
+
     
     // 
     // Configuration of network: select local address / interface
@@ -417,7 +127,7 @@ int main()
     LogBroker::getInstance().log(LogMessage("ORTableProvider", Severity::Notice, "Core created!"));
 
     // setting up the Provider
-    auto providerConfig{createProviderConfig(networkInterface, *localAddress)};
+    auto providerConfig{createProviderConfig(PROVIDER_EPR, ENABLE_TLS, networkInterface, *localAddress)};
     // default config. Local address to bind to must be specified
     auto discoveryConfig = std::make_shared<Config::DiscoveryConfig>(localAddress->getIPAddress());  
     discoveryConfig->setDiscoverySendingEndpointPort(5011);
@@ -430,7 +140,29 @@ int main()
     LogBroker::getInstance().log({"ORTableProvider", Severity::Notice, "Provider created!"});
     
     // Load MDIB from xml file (contained in <MdibResponse> element)
-    const auto mdibData = Common::StringHelper::loadFile("ORTableMDIB.xml");
+    // The file is streamed in chunks: the descriptor model is built on the fly and malformed files are reported with
+    // line and column. The provider only gets the compacted document (no indentation, no comments).
+    MdibModel mdibModel;
+    std::string mdibData;
+    const auto loadResult = MdibStreamLoader::loadFile("ORTableMDIB.xml", mdibModel, &mdibData);
+    if(!loadResult.success())
+    {
+        std::cout << "Failed to parse Mdib: ORTableMDIB.xml:" << loadResult.getError() << std::endl;
+        return -1;
+    }
+    LogBroker::getInstance().log({"ORTableProvider",
+                                  Severity::Notice,
+                                  "Parsed Mdib with " + std::to_string(mdibModel.descriptors.size()) + " descriptors and "
+                                      + std::to_string(mdibModel.states.size()) + " states"});
+
+    // Handle uniqueness, references and types are checked in parallel passes, the index is kept for fast lookups
+    auto mdibIndex = std::make_shared<MdibIndex>();
+    const auto validationResult = MdibIndex::build(std::move(mdibModel), *mdibIndex);
+    if(!validationResult.success())
+    {
+        std::cout << "Mdib validation failed:" << std::endl << validationResult.getError();
+        return -1;
+    }
     try
     {
         if(provider.get()->loadMdib(mdibData) == false)
@@ -449,12 +181,70 @@ int main()
     }
 
 
+    //
+    // Alert handling: the engine applies latching and acknowledgement, escalation and aggregation are driven by a
+    // timer wheel with 10 ms resolution, independent of the 500 ms update loop
+    auto alertStateEngine = std::make_shared<AlertStateEngine>(*mdibIndex);
+    TimerWheel timerWheel(std::chrono::milliseconds(10));
+    auto alertAggregator = std::make_shared<AlertAggregator>(
+        alertStateEngine, timerWheel, AlertAggregationConfig(), [&provider](const AlertStateChanges& p_changes) {
+            return commitAlertChanges(provider.get(), p_changes);
+        });
+    auto alertEscalator = std::make_shared<AlertEscalator>(
+        alertStateEngine, createEscalationTable(), timerWheel, [alertAggregator]() { alertAggregator->notify(); });
+
+    // The ValueUpdater publishes the positions of the table, the serial bridge wakes it on new telemetry
+    auto virtualTable = std::make_shared<VirtualORTableModel>();
+    auto valueUpdater =
+        std::make_unique<ValueUpdater>(provider.get(), virtualTable, alertStateEngine, alertEscalator, alertAggregator);
+
+    //
+    // Connection to the table controller: telemetry is applied to the virtual table as it arrives, activates become
+    // commands pipelined over the serial line. Without a controller, activates change the virtual table directly
+    std::shared_ptr<CommandPipeline> commandPipeline;
+#ifdef ORTABLE_WITH_SERIAL_BRIDGE
+    SerialBridgeConfig serialConfig;
+    serialConfig.device = std::getenv("ORTABLE_SERIAL_DEVICE") ? std::getenv("ORTABLE_SERIAL_DEVICE") : SERIAL_DEVICE;
+    serialConfig.baudRate = SERIAL_BAUD_RATE;
+    std::unique_ptr<SerialBridge> serialBridge;
+    if(!serialConfig.device.empty())
+    {
+        // A command may take as long as its movement across the whole range, e.g. a predefined position
+        CommandPipelineConfig pipelineConfig;
+        pipelineConfig.timeout = COMMAND_ACK_TIMEOUT;
+        pipelineConfig.movementTime = &VirtualORTableModel::travelTime;
+        commandPipeline = std::make_shared<CommandPipeline>(
+            timerWheel, pipelineConfig, [&serialBridge](const ORTable::TableCommand& p_command, std::uint16_t p_sequence) {
+                return serialBridge->send(p_command, p_sequence);
+            });
+        auto* updater = valueUpdater.get();
+        serialBridge = std::make_unique<SerialBridge>(
+            serialConfig,
+            [virtualTable, updater](const ORTable::TableTelemetry& p_telemetry) {
+                virtualTable->applyTelemetry(p_telemetry);
+                updater->notifyChanged();
+            },
+            [commandPipeline](std::uint16_t p_sequence, ORTable::AckStatus p_status) {
+                commandPipeline->onAck(p_sequence, p_status);
+            },
+            [commandPipeline](bool p_connected) {
+                if(!p_connected)
+                {
+                    commandPipeline->onConnectionLost();
+                }
+            });
+    }
+#endif
+
     //
     // Create Handlers to listen for events as needed
-    auto setStringHandler = std::make_shared<ORTableSetStringHandler>();
-    auto orTableActivateHandler = std::make_shared<ORTableActivateHandler>();
-    auto orTableSetAlertStateHandler = std::make_shared<ORTableSetAlertStateHandler>();
-    auto orTableSetContextStateHandler = std::make_shared<ORTableSetContextStateHandler>();
+    auto setStringHandler = std::make_shared<ORTableSetStringHandler>(virtualTable);
+    auto orTableActivateHandler = std::make_shared<ORTableActivateHandler>(virtualTable, commandPipeline);
+    auto orTableSetAlertStateHandler = std::make_shared<ORTableSetAlertStateHandler>(alertStateEngine, alertAggregator);
+    auto contextStateStore = std::make_shared<ContextStateStore>(*mdibIndex);
+    std::mutex contextCommitMutex;
+    auto orTableSetContextStateHandler =
+        std::make_shared<ORTableSetContextStateHandler>(provider.get(), contextStateStore, contextCommitMutex);
 
 
     provider->registerSetStringExternalControlHandler(setStringHandler);
@@ -462,6 +252,15 @@ int main()
     provider->registerSetAlertStateExternalControlHandler(orTableSetAlertStateHandler);
     provider->registerSetContextStateExternalControlHandler(orTableSetContextStateHandler);
 
+    /*
+        TODO
+        Consumers subscribe with an ORTable::SubscriptionFilter (dialect ORTable::SUBSCRIPTION_FILTER_DIALECT).
+        sdcX exposes neither the filters of the subscriptions nor the selection of the recipients of a report, so
+        reports still go to all subscribers. Once it does, decode each filter with SubscriptionFilter::decode()
+        (unknown dialects as SubscriptionFilter::all()) and send each report only to the subscriptions whose filter
+        matchesAny() of its states
+    */
+
     /*
     * 
     * RUNTIME
@@ -470,9 +269,48 @@ int main()
     // after setting up everything, the provider can be started
     // TODO
 
+    timerWheel.run();
+
     // start a thread that simulates an update of the values and notifies all connected consumers
-    auto valueUpdater = std::make_unique<ValueUpdater>(provider.get());
     valueUpdater->run();
+#ifdef ORTABLE_WITH_SERIAL_BRIDGE
+    if(serialBridge)
+    {
+        serialBridge->run();
+    }
+#endif
+
+
+    // Changes to ORTableMDIB.xml are applied while running instead of requiring a restart
+    auto mdibReloader = std::make_unique<MdibReloader>(
+        "ORTableMDIB.xml",
+        mdibIndex,
+        [&provider, &valueUpdater, &contextCommitMutex, alertStateEngine, alertEscalator, contextStateStore](
+            const MdibIndex& p_next, const std::vector<DescriptionModification>& p_modifications) {
+            if(!applyDescriptionModifications(provider.get(), p_next, p_modifications))
+            {
+                return false;
+            }
+            // The modules resolved their handles against the startup MDIB, they take over the new descriptors
+            alertStateEngine->reload(p_next);
+            alertEscalator->onMdibReloaded();
+            {
+                std::lock_guard<std::mutex> lock(contextCommitMutex);
+                contextStateStore->reload(p_next);
+            }
+            valueUpdater->onMdibReloaded();
+            return true;
+        });
+    mdibReloader->run(std::chrono::seconds(2));
+
+    // Expired context states are removed in the background, 50 per commit
+    auto contextCompactor = std::make_unique<ContextCompactor>(
+        contextStateStore,
+        createContextRetentionPolicy(),
+        50,
+        contextCommitMutex,
+        [&provider](const std::vector<std::string>& p_handles) { return removeContextStates(provider.get(), p_handles); });
+    contextCompactor->run(std::chrono::minutes(1));
 
 
     // Stop condition
@@ -481,7 +319,26 @@ int main()
 
 
     // Cleanup 
+#ifdef ORTABLE_WITH_SERIAL_BRIDGE
+    if(serialBridge)
+    {
+        serialBridge->stop();
+    }
+#endif
+    contextCompactor->stop();
+    mdibReloader->stop();
     valueUpdater->stop();
+    timerWheel.stop();
+
+    const auto alertCounters = alertAggregator->getCounters();
+    LogBroker::getInstance().log({"ORTableProvider",
+                                  Severity::Notice,
+                                  "Alert transitions: " + std::to_string(alertCounters.transitions) + ", reports: "
+                                      + std::to_string(alertCounters.reports) + ", coalesced: "
+                                      + std::to_string(alertCounters.coalesced) + ", suppressed: "
+                                      + std::to_string(alertCounters.suppressed) + ", failed: "
+                                      + std::to_string(alertCounters.failed)});
+    ORTABLE_TRACE_STOP();
     provider.reset();
     sdcCore.reset();
 
@@ -0,0 +1,379 @@
+#include "HttpSinks.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cctype>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+
+namespace
+{
+    constexpr int MAX_EVENTS{64};
+    const char ACCEPTED_RESPONSE[] = "HTTP/1.1 202 Accepted\r\nContent-Length: 0\r\n\r\n";
+
+    // Value of a header within the header block, case insensitive name, empty if missing
+    std::string headerValue(const std::string& p_headers, const char* p_name)
+    {
+        const std::size_t nameLength = std::strlen(p_name);
+        std::size_t lineStart = p_headers.find("\r\n");
+        while(lineStart != std::string::npos && lineStart + 2 < p_headers.size())
+        {
+            lineStart += 2;
+            const auto lineEnd = p_headers.find("\r\n", lineStart);
+            const auto line = p_headers.substr(lineStart, lineEnd == std::string::npos ? std::string::npos : lineEnd - lineStart);
+            if(line.size() > nameLength && line[nameLength] == ':'
+               && std::equal(p_name, p_name + nameLength, line.begin(), [](char p_a, char p_b) {
+                      return std::tolower(static_cast<unsigned char>(p_a)) == std::tolower(static_cast<unsigned char>(p_b));
+                  }))
+            {
+                const auto valueStart = line.find_first_not_of(' ', nameLength + 1);
+                return valueStart == std::string::npos ? std::string() : line.substr(valueStart);
+            }
+            lineStart = lineEnd;
+        }
+        return {};
+    }
+
+    bool containsToken(std::string p_value, const char* p_token)
+    {
+        std::transform(p_value.begin(), p_value.end(), p_value.begin(), [](unsigned char p_c) { return static_cast<char>(std::tolower(p_c)); });
+        return p_value.find(p_token) != std::string::npos;
+    }
+
+    /**
+     * Decodes a chunked body starting at p_offset.
+     * @return the offset behind the body, std::string::npos if the body is incomplete
+     */
+    std::size_t decodeChunked(const std::string& p_buffer, std::size_t p_offset, std::string& p_body)
+    {
+        p_body.clear();
+        while(true)
+        {
+            const auto sizeEnd = p_buffer.find("\r\n", p_offset);
+            if(sizeEnd == std::string::npos)
+            {
+                return std::string::npos;
+            }
+            const auto size = std::strtoul(p_buffer.c_str() + p_offset, nullptr, 16);
+            if(size == 0)
+            {
+                // No trailers are expected, just the final line break
+                const auto end = p_buffer.find("\r\n", sizeEnd + 2);
+                return end == std::string::npos ? std::string::npos : end + 2;
+            }
+            if(p_buffer.size() < sizeEnd + 2 + size + 2)
+            {
+                return std::string::npos;
+            }
+            p_body.append(p_buffer, sizeEnd + 2, size);
+            p_offset = sizeEnd + 2 + size + 2;
+        }
+    }
+} // namespace
+
+HttpSinks::HttpSinks(CommitTimeFunction p_commitTime, SequenceFunction p_sequence)
+    : m_commitTime(std::move(p_commitTime))
+    , m_sequence(std::move(p_sequence))
+{
+}
+
+HttpSinks::~HttpSinks()
+{
+    if(m_running)
+    {
+        stop();
+    }
+    for(auto& connection : m_connections)
+    {
+        if(connection->fd >= 0)
+        {
+            ::close(connection->fd);
+        }
+    }
+    if(m_wakeUp >= 0)
+    {
+        ::close(m_wakeUp);
+    }
+    if(m_epoll >= 0)
+    {
+        ::close(m_epoll);
+    }
+}
+
+bool HttpSinks::open(std::string& p_error)
+{
+    m_epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    m_wakeUp = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if(m_epoll < 0 || m_wakeUp < 0)
+    {
+        p_error = std::string("epoll setup failed: ") + std::strerror(errno);
+        return false;
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = nullptr;
+    if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, m_wakeUp, &event) != 0)
+    {
+        p_error = std::string("epoll setup failed: ") + std::strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+std::uint16_t HttpSinks::addSink()
+{
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        return 0;
+    }
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    address.sin_port = 0;
+    socklen_t length = sizeof(address);
+    if(::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 || ::listen(fd, 64) != 0
+       || ::getsockname(fd, reinterpret_cast<sockaddr*>(&address), &length) != 0)
+    {
+        ::close(fd);
+        return 0;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto listener = std::make_unique<Connection>();
+    listener->fd = fd;
+    listener->sink = m_sinks.size();
+    listener->listening = true;
+
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.ptr = listener.get();
+    if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+    {
+        ::close(fd);
+        return 0;
+    }
+    m_connections.push_back(std::move(listener));
+    m_sinks.emplace_back();
+    m_sinks.back().port = ntohs(address.sin_port);
+    return m_sinks.back().port;
+}
+
+std::size_t HttpSinks::size() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sinks.size();
+}
+
+void HttpSinks::accept(Connection& p_listener)
+{
+    while(true)
+    {
+        const int fd = ::accept4(p_listener.fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if(fd < 0)
+        {
+            return;
+        }
+        const int noDelay{1};
+        ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &noDelay, sizeof(noDelay));
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto connection = std::make_unique<Connection>();
+        connection->fd = fd;
+        connection->sink = p_listener.sink;
+
+        epoll_event event{};
+        event.events = EPOLLIN | EPOLLRDHUP;
+        event.data.ptr = connection.get();
+        if(::epoll_ctl(m_epoll, EPOLL_CTL_ADD, fd, &event) != 0)
+        {
+            ::close(fd);
+            continue;
+        }
+        m_connections.push_back(std::move(connection));
+    }
+}
+
+bool HttpSinks::receive(Connection& p_connection)
+{
+    char chunk[16 * 1024];
+    while(true)
+    {
+        const auto count = ::recv(p_connection.fd, chunk, sizeof(chunk), 0);
+        if(count > 0)
+        {
+            p_connection.buffer.append(chunk, static_cast<std::size_t>(count));
+            continue;
+        }
+        if(count < 0 && (errno == EAGAIN || errno == EWOULDBLOCK))
+        {
+            return process(p_connection);
+        }
+        if(count < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        // Closed by the provider, handle what arrived before
+        process(p_connection);
+        return false;
+    }
+}
+
+bool HttpSinks::process(Connection& p_connection)
+{
+    std::string body;
+    while(true)
+    {
+        const auto headerEnd = p_connection.buffer.find("\r\n\r\n");
+        if(headerEnd == std::string::npos)
+        {
+            return true;
+        }
+        const auto headers = p_connection.buffer.substr(0, headerEnd);
+        const auto bodyStart = headerEnd + 4;
+        std::size_t requestEnd{0};
+        if(containsToken(headerValue(headers, "Transfer-Encoding"), "chunked"))
+        {
+            requestEnd = decodeChunked(p_connection.buffer, bodyStart, body);
+            if(requestEnd == std::string::npos)
+            {
+                return true;
+            }
+        }
+        else
+        {
+            const auto contentLength = std::strtoull(headerValue(headers, "Content-Length").c_str(), nullptr, 10);
+            if(p_connection.buffer.size() < bodyStart + contentLength)
+            {
+                return true;
+            }
+            body.assign(p_connection.buffer, bodyStart, contentLength);
+            requestEnd = bodyStart + contentLength;
+        }
+
+        onReport(p_connection.sink, body, Clock::now());
+        p_connection.buffer.erase(0, requestEnd);
+
+        // Loopback sockets take the short response at once
+        if(::send(p_connection.fd, ACCEPTED_RESPONSE, sizeof(ACCEPTED_RESPONSE) - 1, MSG_NOSIGNAL) < 0)
+        {
+            return false;
+        }
+        if(containsToken(headerValue(headers, "Connection"), "close"))
+        {
+            return false;
+        }
+    }
+}
+
+void HttpSinks::onReport(std::size_t p_sink, const std::string& p_body, Clock::time_point p_received)
+{
+    std::uint64_t sequence{0};
+    const bool known = m_sequence(p_body, sequence);
+    const auto committed = known ? m_commitTime(sequence) : Clock::time_point();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto& sink = m_sinks[p_sink];
+    ++sink.reports;
+    sink.bytes += p_body.size();
+    if(committed == Clock::time_point())
+    {
+        ++m_unmatched;
+        return;
+    }
+    sink.latencies.record(p_received - committed);
+}
+
+void HttpSinks::close(Connection& p_connection)
+{
+    ::epoll_ctl(m_epoll, EPOLL_CTL_DEL, p_connection.fd, nullptr);
+    ::close(p_connection.fd);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const auto it = std::find_if(m_connections.begin(), m_connections.end(), [&p_connection](const std::unique_ptr<Connection>& p_entry) {
+        return p_entry.get() == &p_connection;
+    });
+    if(it != m_connections.end())
+    {
+        m_connections.erase(it);
+    }
+}
+
+void HttpSinks::takePhase(ORTable::LatencyRecorder& p_latencies, std::vector<std::uint64_t>& p_reportsPerSink)
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    p_reportsPerSink.clear();
+    for(auto& sink : m_sinks)
+    {
+        p_latencies.merge(sink.latencies);
+        sink.latencies.clear();
+        p_reportsPerSink.push_back(sink.reports);
+        sink.reports = 0;
+    }
+}
+
+std::uint64_t HttpSinks::getUnmatched() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_unmatched;
+}
+
+std::chrono::microseconds HttpSinks::getCpuTime() const
+{
+    return std::chrono::microseconds(m_threadCpuTime.load() / 1000);
+}
+
+void HttpSinks::run()
+{
+    m_running = true;
+    m_thread = std::thread([this]() {
+        epoll_event events[MAX_EVENTS];
+        while(m_running)
+        {
+            const int count = ::epoll_wait(m_epoll, events, MAX_EVENTS, 100);
+            for(int i = 0; i < count; ++i)
+            {
+                auto* connection = static_cast<Connection*>(events[i].data.ptr);
+                if(connection == nullptr)
+                {
+                    // stop()
+                    continue;
+                }
+                if(connection->listening)
+                {
+                    accept(*connection);
+                }
+                else if(!receive(*connection))
+                {
+                    close(*connection);
+                }
+            }
+
+            timespec cpuTime{};
+            ::clock_gettime(CLOCK_THREAD_CPUTIME_ID, &cpuTime);
+            m_threadCpuTime = static_cast<std::int64_t>(cpuTime.tv_sec) * 1000000000 + cpuTime.tv_nsec;
+        }
+    });
+}
+
+void HttpSinks::stop()
+{
+    m_running = false;
+    const std::uint64_t one{1};
+    if(::write(m_wakeUp, &one, sizeof(one)) < 0)
+    {
+        // The loop wakes up within 100 ms anyway
+    }
+    if(m_thread.joinable())
+    {
+        m_thread.join();
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @brief Lightweight report subscribers for the fan-out benchmark. Every sink is an HTTP endpoint on the loopback
+ * interface that accepts the notifications of the provider, answers 202 and records the delivery latency of each
+ * report. All sinks share one epoll thread, so even 200 subscribers cost the machine little next to the provider.
+ * The CPU time of that thread is tracked, so the benchmark can subtract it from the CPU time of the process.
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#pragma once
+
+#include "LatencyRecorder.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+class HttpSinks
+{
+public:
+    using Clock = std::chrono::steady_clock;
+    // Commit time of the report carrying the given sequence number, Clock::time_point() if unknown
+    using CommitTimeFunction = std::function<Clock::time_point(std::uint64_t p_sequence)>;
+    // Sequence number carried by a report body, false if there is none
+    using SequenceFunction = std::function<bool(const std::string& p_body, std::uint64_t& p_sequence)>;
+
+private:
+    struct Connection
+    {
+        int fd{-1};
+        std::size_t sink{0};
+        bool listening{false};
+        std::string buffer;
+    };
+
+    struct Sink
+    {
+        std::uint16_t port{0};
+        std::uint64_t reports{0};
+        std::uint64_t bytes{0};
+        ORTable::LatencyRecorder latencies;
+    };
+
+    CommitTimeFunction m_commitTime;
+    SequenceFunction m_sequence;
+
+    int m_epoll{-1};
+    int m_wakeUp{-1};
+
+    mutable std::mutex m_mutex;
+    std::vector<Sink> m_sinks;
+    // Owned here, the epoll events point to them
+    std::vector<std::unique_ptr<Connection>> m_connections;
+    std::uint64_t m_unmatched{0};
+
+    std::atomic<bool> m_running{false};
+    std::atomic<std::int64_t> m_threadCpuTime{0};
+    std::thread m_thread;
+
+    void accept(Connection& p_listener);
+    // False if the connection was closed
+    bool receive(Connection& p_connection);
+    // Handles all complete requests in the buffer, false if the peer asked to close
+    bool process(Connection& p_connection);
+    void onReport(std::size_t p_sink, const std::string& p_body, Clock::time_point p_received);
+    void close(Connection& p_connection);
+
+public:
+    HttpSinks(CommitTimeFunction p_commitTime, SequenceFunction p_sequence);
+    ~HttpSinks();
+
+    bool open(std::string& p_error);
+    // Adds a sink on an ephemeral loopback port, returns the port or 0
+    std::uint16_t addSink();
+    std::size_t size() const;
+
+    /**
+     * @brief Hands out the latencies and report counts recorded since the last call and starts a new phase.
+     * @param p_reportsPerSink reports received by each sink during the phase
+     */
+    void takePhase(ORTable::LatencyRecorder& p_latencies, std::vector<std::uint64_t>& p_reportsPerSink);
+    // Notifications whose sequence number was unknown, e.g. reports of commits before the phase
+    std::uint64_t getUnmatched() const;
+    // CPU time spent by the sink thread so far
+    std::chrono::microseconds getCpuTime() const;
+
+    void run();
+    void stop();
+};
@@ -0,0 +1,510 @@
+/**
+ * @file main.cpp
+ * @brief Report fan-out benchmark of the OR table provider. Starts the provider with the OR table MDIB (without TLS,
+ * on the loopback interface) and K in-process subscribers, each one a local HTTP sink subscribed for
+ * EpisodicMetricReports. The height metric is then committed at increasing rates, its value carrying the sequence
+ * number of the commit, so every sink can match a notification to the time of its commit.
+ *
+ * For every number of subscribers and every rate one CSV line is written: achieved commit rate, delivered reports,
+ * report throughput, delivery latency percentiles and the CPU time of the provider per delivered report (CPU time of
+ * the process minus the CPU time of the sinks).
+ *
+ * @copyright 2023 SurgiTAIX AG
+ *
+ */
+
+#include "SDCCore/Core.h"
+#include "SDCCore/Prerequisites.h"
+#include "ProviderAPI/SDCProvider.h"
+#include "ProviderAPI/MDIBAccess/ProviderMDIBAccess.h"
+
+#include "ParticipantModel/PM/NumericMetricState.h"
+
+#include "Logging/LogBroker.h"
+#include "Logging/Loggers/ConsoleLogger.h"
+
+#include "HttpSinks.h"
+#include "LatencyRecorder.h"
+#include "SubscriptionFilter.h"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace Logging;
+using Clock = std::chrono::steady_clock;
+
+namespace
+{
+    const std::string PROVIDER_EPR("urn:uuid:4f6e6c79-2d62-656e-6368-6d61726b0000");
+    const std::string BENCHMARK_HANDLE("MDC_OR_TABLE_HEIGHT");
+
+    struct BenchmarkConfig
+    {
+        std::vector<std::size_t> subscribers{1, 2, 5, 10, 20, 50, 100, 200};
+        std::vector<unsigned int> rates{10, 50, 100, 200, 500, 1000};
+        std::chrono::seconds phaseDuration{5};
+        // Time for the last notifications of a phase to arrive
+        std::chrono::milliseconds drainTime{1000};
+        unsigned int providerPort{10100};
+        // Path of the event source of the provider, see the hosted services in its GetMetadata response
+        std::string subscribePath{"/StateEventService"};
+        std::string mdibFile{"ORTableMDIB.xml"};
+        std::string output;
+    };
+
+    void printUsage()
+    {
+        std::cout << "Usage: ORTableProviderBenchmark [options]\n"
+                  << "  --subscribers LIST    numbers of subscribers, ascending (default 1,2,5,10,20,50,100,200)\n"
+                  << "  --rates LIST          commit rates in Hz (default 10,50,100,200,500,1000)\n"
+                  << "  --phase-duration S    duration of every rate (default 5)\n"
+                  << "  --drain MS            wait for late notifications after a phase (default 1000)\n"
+                  << "  --port N              port of the provider (default 10100)\n"
+                  << "  --subscribe-path P    path of the event source (default /StateEventService)\n"
+                  << "  --mdib FILE           MDIB to load (default ORTableMDIB.xml)\n"
+                  << "  --output FILE         CSV file, default is standard output\n";
+    }
+
+    template<typename T>
+    std::vector<T> parseList(const std::string& p_value)
+    {
+        std::vector<T> values;
+        std::istringstream stream(p_value);
+        std::string item;
+        while(std::getline(stream, item, ','))
+        {
+            values.push_back(static_cast<T>(std::stoul(item)));
+        }
+        return values;
+    }
+
+    bool parseArguments(int p_argc, char* p_argv[], BenchmarkConfig& p_config)
+    {
+        for(int i = 1; i < p_argc; ++i)
+        {
+            const std::string option(p_argv[i]);
+            if(i + 1 >= p_argc)
+            {
+                return false;
+            }
+            const std::string value(p_argv[++i]);
+            if(option == "--subscribers")
+            {
+                p_config.subscribers = parseList<std::size_t>(value);
+            }
+            else if(option == "--rates")
+            {
+                p_config.rates = parseList<unsigned int>(value);
+            }
+            else if(option == "--phase-duration")
+            {
+                p_config.phaseDuration = std::chrono::seconds(std::stoul(value));
+            }
+            else if(option == "--drain")
+            {
+                p_config.drainTime = std::chrono::milliseconds(std::stoul(value));
+            }
+            else if(option == "--port")
+            {
+                p_config.providerPort = static_cast<unsigned int>(std::stoul(value));
+            }
+            else if(option == "--subscribe-path")
+            {
+                p_config.subscribePath = value;
+            }
+            else if(option == "--mdib")
+            {
+                p_config.mdibFile = value;
+            }
+            else if(option == "--output")
+            {
+                p_config.output = value;
+            }
+            else
+            {
+                return false;
+            }
+        }
+        return !p_config.subscribers.empty() && !p_config.rates.empty();
+    }
+
+    // Commit times by sequence number, in nanoseconds since the epoch of the steady clock
+    class CommitLog
+    {
+    private:
+        std::unique_ptr<std::atomic<std::int64_t>[]> m_times;
+        std::size_t m_capacity;
+
+    public:
+        explicit CommitLog(std::size_t p_capacity)
+            : m_times(new std::atomic<std::int64_t>[p_capacity])
+            , m_capacity(p_capacity)
+        {
+            for(std::size_t i = 0; i < m_capacity; ++i)
+            {
+                m_times[i] = 0;
+            }
+        }
+
+        void set(std::uint64_t p_sequence, Clock::time_point p_time)
+        {
+            m_times[p_sequence % m_capacity] = p_time.time_since_epoch().count();
+        }
+
+        Clock::time_point get(std::uint64_t p_sequence) const
+        {
+            return Clock::time_point(Clock::duration(m_times[p_sequence % m_capacity].load()));
+        }
+    };
+
+    // The sequence number is the value of the metric: <pm:MetricValue ... Value="42">
+    bool extractSequence(const std::string& p_body, std::uint64_t& p_sequence)
+    {
+        const auto metricValue = p_body.find("MetricValue");
+        if(metricValue == std::string::npos)
+        {
+            return false;
+        }
+        const char attribute[] = " Value=\"";
+        const auto value = p_body.find(attribute, metricValue);
+        if(value == std::string::npos)
+        {
+            return false;
+        }
+        char* end{nullptr};
+        p_sequence = std::strtoull(p_body.c_str() + value + sizeof(attribute) - 1, &end, 10);
+        return end != p_body.c_str() + value + sizeof(attribute) - 1;
+    }
+
+    std::shared_ptr<MessageModel::DPWS::ThisModel> prepareModelDescription()
+    {
+        using namespace MessageModel::DPWS;
+
+        std::vector<ThisModel::Manufacturer> manufacturerNames;
+        manufacturerNames.push_back(ThisModel::Manufacturer{{"SurgiTAIX"}});
+        std::vector<ThisModel::ModelName> modelNames;
+        modelNames.push_back(ThisModel::ModelName{{"sdcX OR Table Provider Benchmark"}});
+        return std::make_shared<ThisModel>(std::move(manufacturerNames), std::move(modelNames));
+    }
+
+    std::shared_ptr<MessageModel::DPWS::ThisDevice> prepareDeviceDescription()
+    {
+        using namespace MessageModel::DPWS;
+
+        std::vector<ThisDevice::FriendlyName> friendlyNames;
+        friendlyNames.emplace_back(std::string{"sdcX OR Table Provider Benchmark"});
+        return std::make_shared<ThisDevice>(std::move(friendlyNames));
+    }
+
+    std::string readFile(const std::string& p_path)
+    {
+        std::ifstream file(p_path, std::ios::binary);
+        std::ostringstream content;
+        content << file.rdbuf();
+        return content.str();
+    }
+
+    // Blocking HTTP POST on the loopback interface, returns the response or an empty string
+    std::string post(unsigned int p_port, const std::string& p_path, const std::string& p_body)
+    {
+        const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if(fd < 0)
+        {
+            return {};
+        }
+        sockaddr_in address{};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(static_cast<std::uint16_t>(p_port));
+        if(::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0)
+        {
+            ::close(fd);
+            return {};
+        }
+
+        const auto request = "POST " + p_path + " HTTP/1.1\r\nHost: 127.0.0.1:" + std::to_string(p_port)
+                             + "\r\nContent-Type: application/soap+xml; charset=utf-8\r\nContent-Length: "
+                             + std::to_string(p_body.size()) + "\r\nConnection: close\r\n\r\n" + p_body;
+        std::size_t sent{0};
+        while(sent < request.size())
+        {
+            const auto count = ::send(fd, request.data() + sent, request.size() - sent, MSG_NOSIGNAL);
+            if(count <= 0)
+            {
+                ::close(fd);
+                return {};
+            }
+            sent += static_cast<std::size_t>(count);
+        }
+
+        std::string response;
+        char chunk[4096];
+        ssize_t count{0};
+        while((count = ::recv(fd, chunk, sizeof(chunk), 0)) > 0)
+        {
+            response.append(chunk, static_cast<std::size_t>(count));
+        }
+        ::close(fd);
+        return response;
+    }
+
+    // True once the port accepts connections on the loopback interface
+    bool waitForPort(unsigned int p_port, std::chrono::milliseconds p_timeout)
+    {
+        const auto deadline = std::chrono::steady_clock::now() + p_timeout;
+        do
+        {
+            const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+            if(fd < 0)
+            {
+                return false;
+            }
+            sockaddr_in address{};
+            address.sin_family = AF_INET;
+            address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+            address.sin_port = htons(static_cast<std::uint16_t>(p_port));
+            const bool connected = ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+            ::close(fd);
+            if(connected)
+            {
+                return true;
+            }
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        } while(std::chrono::steady_clock::now() < deadline);
+        return false;
+    }
+
+    std::string messageId(std::uint64_t p_number)
+    {
+        char id[64];
+        std::snprintf(id, sizeof(id), "urn:uuid:00000000-0000-4000-8000-%012llx", static_cast<unsigned long long>(p_number));
+        return id;
+    }
+
+    // WS-Eventing Subscribe for EpisodicMetricReports, delivered to the sink on the given port
+    bool subscribe(const BenchmarkConfig& p_config, std::uint16_t p_sinkPort, std::uint64_t p_messageNumber)
+    {
+        const auto eventSource = "http://127.0.0.1:" + std::to_string(p_config.providerPort) + p_config.subscribePath;
+        const ORTable::SubscriptionFilter filter({ORTable::ReportAction::EpisodicMetric});
+        const auto envelope =
+            "<?xml version=\"1.0\" encoding=\"UTF-8\"?>"
+            "<s12:Envelope xmlns:s12=\"http://www.w3.org/2003/05/soap-envelope\" xmlns:wsa=\"http://www.w3.org/2005/08/addressing\" "
+            "xmlns:wse=\"http://schemas.xmlsoap.org/ws/2004/08/eventing\">"
+            "<s12:Header>"
+            "<wsa:Action>http://schemas.xmlsoap.org/ws/2004/08/eventing/Subscribe</wsa:Action>"
+            "<wsa:MessageID>"
+            + messageId(p_messageNumber)
+            + "</wsa:MessageID>"
+              "<wsa:To>"
+            + eventSource
+            + "</wsa:To>"
+              "</s12:Header>"
+              "<s12:Body><wse:Subscribe>"
+              "<wse:Delivery><wse:NotifyTo><wsa:Address>http://127.0.0.1:"
+            + std::to_string(p_sinkPort)
+            + "/</wsa:Address></wse:NotifyTo></wse:Delivery>"
+              "<wse:Expires>PT1H</wse:Expires>"
+              "<wse:Filter Dialect=\"http://docs.oasis-open.org/ws-dd/ns/dpws/2009/01/Action\">"
+            + filter.encode()
+            + "</wse:Filter>"
+              "</wse:Subscribe></s12:Body></s12:Envelope>";
+
+        const auto response = post(p_config.providerPort, p_config.subscribePath, envelope);
+        return response.compare(0, 12, "HTTP/1.1 200") == 0 && response.find("SubscribeResponse") != std::string::npos;
+    }
+
+    std::chrono::microseconds processCpuTime()
+    {
+        rusage usage{};
+        ::getrusage(RUSAGE_SELF, &usage);
+        return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec)
+               + std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+    }
+
+    bool commitSequence(ProviderAPI::SDCProvider& p_provider, std::uint64_t p_sequence)
+    {
+        using namespace ParticipantModel::PM;
+
+        auto updateAccess = p_provider.getMDIBGateway()->makeUpdateAccess();
+        auto state = updateAccess->getState<NumericMetricState>(BENCHMARK_HANDLE);
+        NumericMetricValue metricValue(MetricQuality(MeasurementValidity::Vld));
+        metricValue.setValue(Decimal(std::to_string(p_sequence)));
+        state->setMetricValue(metricValue);
+        updateAccess->updateState(state);
+
+        auto result = p_provider.getMDIBGateway()->commit(std::move(updateAccess));
+        if(!result.success())
+        {
+            std::cout << "Update of values not successful: " + result.getError();
+            return false;
+        }
+        return true;
+    }
+} // namespace
+
+int main(int argc, char* argv[])
+{
+    BenchmarkConfig config;
+    if(!parseArguments(argc, argv, config))
+    {
+        printUsage();
+        return 1;
+    }
+
+    std::ofstream outputFile;
+    if(!config.output.empty())
+    {
+        outputFile.open(config.output);
+        if(!outputFile)
+        {
+            std::cerr << "Cannot write " << config.output << std::endl;
+            return 1;
+        }
+    }
+    std::ostream& csv = config.output.empty() ? std::cout : outputFile;
+
+    // Only errors, logging every notification would measure the logger
+    auto consoleLogger = std::make_shared<Loggers::ConsoleLogger>();
+    LogBroker::getInstance().registerLogger("console", consoleLogger);
+    LogBroker::getInstance().setLogLevel(Severity::Error);
+
+    auto coreConfig = std::make_unique<Config::CoreConfig>();
+    auto sdcCore = SDCCore::Core::createInstance(std::move(coreConfig));
+
+    // Loopback only, without TLS: the benchmark measures the report path, not the handshakes
+    auto networkInterface = std::make_shared<SDCCommon::DataTypes::NetworkInterface>(SDCCore::enumerateNetworkInterfaces()[0]);
+    SDCCommon::DataTypes::NetworkAddress localAddress(SDCCommon::DataTypes::IPAddress("127.0.0.1"), config.providerPort);
+    auto providerConfig = std::make_shared<Config::ProviderConfig>(PROVIDER_EPR,
+                                                                   nullptr,
+                                                                   prepareModelDescription(),
+                                                                   prepareDeviceDescription(),
+                                                                   localAddress,
+                                                                   networkInterface);
+    auto discoveryConfig = std::make_shared<Config::DiscoveryConfig>(localAddress.getIPAddress());
+    auto provider = std::make_unique<ProviderAPI::SDCProvider>(sdcCore, providerConfig, discoveryConfig);
+    if(!provider->loadMdib(readFile(config.mdibFile)))
+    {
+        std::cerr << "Could not load Mdib " << config.mdibFile << std::endl;
+        return 1;
+    }
+    try
+    {
+        provider->startup();
+    }
+    catch(const ProviderAPI::ProviderAPIException& e)
+    {
+        std::cerr << "Could not start the provider: " << e.what() << std::endl;
+        return 1;
+    }
+    // Subscribing before the provider listens would fail every sink
+    if(!waitForPort(config.providerPort, std::chrono::seconds(10)))
+    {
+        std::cerr << "Provider does not accept connections on port " << config.providerPort << std::endl;
+        provider->shutdown();
+        return 1;
+    }
+
+    // Sized for the longest phase at the highest rate, older entries are overwritten
+    unsigned int maximumRate{0};
+    for(const auto rate : config.rates)
+    {
+        maximumRate = std::max(maximumRate, rate);
+    }
+    CommitLog commitLog(static_cast<std::size_t>(maximumRate) * static_cast<std::size_t>(config.phaseDuration.count() + 10) + 1);
+
+    HttpSinks sinks([&commitLog](std::uint64_t p_sequence) { return commitLog.get(p_sequence); }, extractSequence);
+    std::string error;
+    if(!sinks.open(error))
+    {
+        std::cerr << error << std::endl;
+        return 1;
+    }
+    sinks.run();
+
+    csv << "subscribers,target_rate_hz,achieved_rate_hz,commits,reports_expected,reports_received,reports_per_s,"
+           "latency_p50_us,latency_p90_us,latency_p99_us,latency_max_us,provider_cpu_us_per_report\n";
+
+    std::uint64_t sequence{0};
+    std::uint64_t messageNumber{0};
+    for(const auto subscriberCount : config.subscribers)
+    {
+        // Subscribers are only added, so every step reuses the ones before
+        while(sinks.size() < subscriberCount)
+        {
+            const auto port = sinks.addSink();
+            if(port == 0 || !subscribe(config, port, ++messageNumber))
+            {
+                std::cerr << "Could not subscribe sink " << sinks.size() << std::endl;
+                return 1;
+            }
+        }
+
+        for(const auto rate : config.rates)
+        {
+            // Start the phase clean: notifications of the previous phase are drained and dropped
+            std::this_thread::sleep_for(config.drainTime);
+            ORTable::LatencyRecorder discarded;
+            std::vector<std::uint64_t> reportsPerSink;
+            sinks.takePhase(discarded, reportsPerSink);
+
+            const auto cpuStart = processCpuTime();
+            const auto sinkCpuStart = sinks.getCpuTime();
+            const auto interval = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rate));
+            const auto start = Clock::now();
+            const auto end = start + config.phaseDuration;
+            auto next = start;
+            std::uint64_t commits{0};
+            while(Clock::now() < end)
+            {
+                ++sequence;
+                commitLog.set(sequence, Clock::now());
+                if(commitSequence(*provider, sequence))
+                {
+                    ++commits;
+                }
+                // Paced against the schedule, a provider falling behind shows as a lower achieved rate
+                next += interval;
+                std::this_thread::sleep_until(next);
+            }
+            const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+            std::this_thread::sleep_for(config.drainTime);
+            ORTable::LatencyRecorder latencies;
+            sinks.takePhase(latencies, reportsPerSink);
+            const auto providerCpu = (processCpuTime() - cpuStart) - (sinks.getCpuTime() - sinkCpuStart);
+
+            std::uint64_t received{0};
+            for(const auto reports : reportsPerSink)
+            {
+                received += reports;
+            }
+            const auto summary = latencies.summarize();
+            csv << subscriberCount << ',' << rate << ',' << (commits / elapsed) << ',' << commits << ',' << commits * subscriberCount
+                << ',' << received << ',' << (received / elapsed) << ',' << summary.p50.count() << ',' << summary.p90.count() << ','
+                << summary.p99.count() << ',' << summary.maximum.count() << ','
+                << (received > 0 ? static_cast<double>(providerCpu.count()) / static_cast<double>(received) : 0.0) << std::endl;
+        }
+    }
+
+    sinks.stop();
+    provider->shutdown();
+    provider.reset();
+    sdcCore.reset();
+    LogBroker::getInstance().unregisterLogger("console");
+    return 0;
+}
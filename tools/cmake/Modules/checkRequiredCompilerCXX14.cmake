@@ -18,6 +18,27 @@ else()
     message(FATAL_ERROR "No supported Compiler detected. Checked for GCC(5.1+), Clang(3.4+) or MSVC(19.0+).")
 endif()
 
+# std::string_view and if constexpr for C++17, std::span for C++20. Coroutines are used only where the compiler
+# provides them (ORTABLE_COROUTINES), so they do not raise the minimum
+if(CMAKE_CXX_STANDARD EQUAL 17)
+    set(ORTABLE_MIN_GCC 7.1)
+    set(ORTABLE_MIN_CLANG 5.0)
+    set(ORTABLE_MIN_MSVC 19.14)
+elseif(CMAKE_CXX_STANDARD EQUAL 20)
+    set(ORTABLE_MIN_GCC 10.1)
+    set(ORTABLE_MIN_CLANG 10.0)
+    set(ORTABLE_MIN_MSVC 19.29)
+endif()
+if(ORTABLE_MIN_GCC)
+    if("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU" AND CMAKE_CXX_COMPILER_VERSION VERSION_LESS ${ORTABLE_MIN_GCC})
+        message(FATAL_ERROR "GCC version must be at least ${ORTABLE_MIN_GCC} for C++${CMAKE_CXX_STANDARD}!")
+    elseif("${CMAKE_CXX_COMPILER_ID}" STREQUAL "Clang" AND CMAKE_CXX_COMPILER_VERSION VERSION_LESS ${ORTABLE_MIN_CLANG})
+        message(FATAL_ERROR "Clang version must be at least ${ORTABLE_MIN_CLANG} for C++${CMAKE_CXX_STANDARD}!")
+    elseif("${CMAKE_CXX_COMPILER_ID}" STREQUAL "MSVC" AND CMAKE_CXX_COMPILER_VERSION VERSION_LESS ${ORTABLE_MIN_MSVC})
+        message(FATAL_ERROR "MSVC version must be at least ${ORTABLE_MIN_MSVC} for C++${CMAKE_CXX_STANDARD}!")
+    endif()
+endif()
+
 # Fix linking on 10.14+. See https://stackoverflow.com/questions/54068035
 IF(APPLE)
     set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} -I/usr/local/include -I/usr/local/opt/openssl@1.1/include")
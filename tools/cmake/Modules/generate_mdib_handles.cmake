@@ -0,0 +1,143 @@
+################################################################################
+# Typed MDIB handles
+#
+# ortable_generate_mdib_handles(<mdib> <output>)
+#   Writes a header with one tag per descriptor of the MDIB description and
+#   the HandleTraits/KindHandles specializations of TypedHandles.h. The tag is
+#   the handle without the first matching prefix of ORTABLE_HANDLE_PREFIXES,
+#   in CamelCase: MDC_OR_TABLE_HEIGHT_UPPER becomes Mdib::HeightUpper.
+#   The header is only rewritten if it changed, and the configuration reruns
+#   when the MDIB changes.
+################################################################################
+set(ORTABLE_HANDLE_PREFIXES "MDC_DEV_OR_TABLE_;MDC_OR_TABLE_;MDC_" CACHE STRING "Prefixes stripped from handles for the tag names")
+
+function(ortable_generate_mdib_handles mdib output)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS ${mdib})
+    file(READ ${mdib} content)
+    # ; separates CMake list elements
+    string(REPLACE ";" " " content "${content}")
+
+    # States may carry handles too, only the description declares descriptors
+    string(FIND "${content}" "MdState" stateStart)
+    if(stateStart GREATER -1)
+        string(SUBSTRING "${content}" 0 ${stateStart} content)
+    endif()
+
+    string(REGEX MATCHALL "<[A-Za-z0-9_]+:[A-Za-z]+[^>]*[ \t\r\n]Handle=\"[^\"]+\"[^>]*>" elements "${content}")
+
+    set(tags "")
+    set(kinds "")
+    set(traits "")
+    foreach(element ${elements})
+        string(REGEX REPLACE "^<[A-Za-z0-9_]+:([A-Za-z]+).*$" "\\1" kind "${element}")
+        if(element MATCHES "xsi:type=\"([A-Za-z0-9_]+:)?([A-Za-z]+)Descriptor\"")
+            set(kind ${CMAKE_MATCH_2})
+        endif()
+        string(REGEX REPLACE "^.*[ \t\r\n]Handle=\"([^\"]+)\".*$" "\\1" handle "${element}")
+
+        set(name ${handle})
+        foreach(prefix ${ORTABLE_HANDLE_PREFIXES})
+            string(LENGTH "${prefix}" prefixLength)
+            string(SUBSTRING "${name}" 0 ${prefixLength} start)
+            if(start STREQUAL prefix)
+                string(SUBSTRING "${name}" ${prefixLength} -1 name)
+                break()
+            endif()
+        endforeach()
+        string(TOLOWER "${name}" name)
+        string(REPLACE "_" ";" words "${name}")
+        set(tag "")
+        foreach(word ${words})
+            string(SUBSTRING "${word}" 0 1 first)
+            string(SUBSTRING "${word}" 1 -1 rest)
+            string(TOUPPER "${first}" first)
+            set(tag "${tag}${first}${rest}")
+        endforeach()
+        if(NOT tag MATCHES "^[A-Za-z][A-Za-z0-9]*$")
+            message(FATAL_ERROR "Handle ${handle} in ${mdib} gives no valid tag name (${tag})")
+        endif()
+        list(FIND tags ${tag} duplicate)
+        if(duplicate GREATER -1)
+            message(FATAL_ERROR "Handles in ${mdib} give the tag ${tag} twice, adjust ORTABLE_HANDLE_PREFIXES")
+        endif()
+        list(APPEND tags ${tag})
+
+        list(FIND kinds ${kind} kindIndex)
+        if(kindIndex EQUAL -1)
+            list(APPEND kinds ${kind})
+            set(handles_${kind} "")
+        endif()
+        list(LENGTH handles_${kind} slot)
+        list(APPEND handles_${kind} ${handle})
+
+        string(APPEND traits
+               "    template<>\n"
+               "    struct HandleTraits<Mdib::${tag}> : HandleDefinition<${kind}, ${slot}>\n"
+               "    {\n"
+               "        static constexpr const char* handle()\n"
+               "        {\n"
+               "            return \"${handle}\";\n"
+               "        }\n"
+               "    };\n")
+    endforeach()
+
+    list(LENGTH tags tagCount)
+    if(tagCount EQUAL 0)
+        message(FATAL_ERROR "No descriptor handles found in ${mdib}")
+    endif()
+
+    set(declarations "")
+    foreach(tag ${tags})
+        string(APPEND declarations "        struct ${tag};\n")
+    endforeach()
+
+    set(kindHandles "")
+    foreach(kind ${kinds})
+        list(LENGTH handles_${kind} count)
+        set(names "")
+        foreach(handle ${handles_${kind}})
+            string(APPEND names "\"${handle}\", ")
+        endforeach()
+        string(REGEX REPLACE ", $" "" names "${names}")
+        string(APPEND kindHandles
+               "    template<>\n"
+               "    struct KindHandles<${kind}> : std::integral_constant<std::size_t, ${count}>\n"
+               "    {\n"
+               "        static const char* handle(std::size_t p_slot)\n"
+               "        {\n"
+               "            static const char* const handles[]{${names}};\n"
+               "            return handles[p_slot];\n"
+               "        }\n"
+               "    };\n")
+    endforeach()
+
+    get_filename_component(mdibName ${mdib} NAME)
+    string(CONCAT header
+        "/**\n"
+        " * @brief Typed handles of ${mdibName}, generated by generate_mdib_handles.cmake. Do not edit.\n"
+        " */\n"
+        "\n"
+        "#pragma once\n"
+        "\n"
+        "#include \"TypedHandles.h\"\n"
+        "\n"
+        "namespace ORTable\n"
+        "{\n"
+        "    namespace Mdib\n"
+        "    {\n"
+        "${declarations}"
+        "    } // namespace Mdib\n"
+        "\n"
+        "${traits}"
+        "\n"
+        "${kindHandles}"
+        "} // namespace ORTable\n")
+
+    if(EXISTS ${output})
+        file(READ ${output} previous)
+    endif()
+    if(NOT "${previous}" STREQUAL "${header}")
+        file(WRITE ${output} "${header}")
+    endif()
+    message(STATUS "Generated ${tagCount} typed handles of ${mdibName}")
+endfunction()
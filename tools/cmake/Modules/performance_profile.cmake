@@ -0,0 +1,138 @@
+################################################################################
+# Performance build profile
+#
+# ORTABLE_PERFORMANCE_PROFILE=ON
+#   Release by default, link-time optimization where the toolchain supports it
+#   and the per-target architecture flags below.
+#
+# ORTABLE_PGO=GENERATE|USE (profile-guided optimization, GCC and Clang)
+#   1. configure with -DORTABLE_PGO=GENERATE and build: instrumented binaries
+#   2. build the target pgo-train: runs the benchmarks (ORTABLE_BENCHMARKS=ON)
+#      and the provider against the controller simulator (Linux) as training
+#      load, see pgo_train_provider.cmake. Profiles end up in ORTABLE_PGO_DIR.
+#      Running the provider and consumer against each other adds to them
+#   3. reconfigure with -DORTABLE_PGO=USE and rebuild. With Clang, the raw
+#      profiles are merged with llvm-profdata first (target pgo-merge)
+#
+# <Target>_ARCH, e.g. ORTableDemoProvider_ARCH=x86-64-v3
+#   -march of that target, empty builds for the default of the compiler. Only
+#   set it for the machines the binary is shipped to. MSVC takes its /arch
+#   values (AVX, AVX2, AVX512), x86-64-v3 and x86-64-v4 are mapped to AVX2 and
+#   AVX512. x86-64 and x86-64-v2 are the x64 default of MSVC and add nothing.
+################################################################################
+# ORTABLE_PERFORMANCE_PROFILE is declared in the root CMakeLists.txt, it decides the default build type
+set(ORTABLE_PGO "OFF" CACHE STRING "Profile-guided optimization: OFF, GENERATE or USE")
+set_property(CACHE ORTABLE_PGO PROPERTY STRINGS "OFF" "GENERATE" "USE")
+set(ORTABLE_PGO_DIR "${CMAKE_BINARY_DIR}/pgo" CACHE PATH "Directory of the PGO profiles")
+set(ORTABLE_PGO_TRAIN_PROVIDER "${CMAKE_CURRENT_LIST_DIR}/pgo_train_provider.cmake")
+
+if(ORTABLE_PERFORMANCE_PROFILE)
+    include(CheckIPOSupported)
+    check_ipo_supported(RESULT ORTABLE_IPO_SUPPORTED OUTPUT ORTABLE_IPO_OUTPUT LANGUAGES CXX)
+    if(ORTABLE_IPO_SUPPORTED)
+        set(CMAKE_INTERPROCEDURAL_OPTIMIZATION_RELEASE ON)
+    else()
+        message(WARNING "Link-time optimization not supported: ${ORTABLE_IPO_OUTPUT}")
+    endif()
+    message(STATUS "Performance profile: LTO=${ORTABLE_IPO_SUPPORTED} PGO=${ORTABLE_PGO}")
+endif()
+
+if(NOT ORTABLE_PGO STREQUAL "OFF")
+    if(NOT ("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU" OR "${CMAKE_CXX_COMPILER_ID}" MATCHES "Clang"))
+        message(FATAL_ERROR "ORTABLE_PGO needs GCC or Clang")
+    endif()
+    set(ORTABLE_PGO_PROFDATA "${ORTABLE_PGO_DIR}/merged.profdata")
+
+    if(ORTABLE_PGO STREQUAL "GENERATE")
+        file(MAKE_DIRECTORY ${ORTABLE_PGO_DIR})
+        if("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU")
+            set(ORTABLE_PGO_FLAGS -fprofile-generate -fprofile-dir=${ORTABLE_PGO_DIR} -fprofile-update=atomic)
+        else()
+            set(ORTABLE_PGO_FLAGS -fprofile-instr-generate=${ORTABLE_PGO_DIR}/%p.profraw)
+        endif()
+    elseif(ORTABLE_PGO STREQUAL "USE")
+        if("${CMAKE_CXX_COMPILER_ID}" STREQUAL "GNU")
+            # Code changed since the training run only loses its profile, it does not fail the build
+            set(ORTABLE_PGO_FLAGS -fprofile-use -fprofile-dir=${ORTABLE_PGO_DIR} -fprofile-correction -Wno-missing-profile)
+        else()
+            if(NOT EXISTS ${ORTABLE_PGO_PROFDATA})
+                message(WARNING "${ORTABLE_PGO_PROFDATA} missing, build the target pgo-merge after the training run")
+            endif()
+            set(ORTABLE_PGO_FLAGS -fprofile-instr-use=${ORTABLE_PGO_PROFDATA} -Wno-profile-instr-unprofiled)
+        endif()
+    else()
+        message(FATAL_ERROR "ORTABLE_PGO must be OFF, GENERATE or USE, not ${ORTABLE_PGO}")
+    endif()
+
+    if("${CMAKE_CXX_COMPILER_ID}" MATCHES "Clang")
+        find_program(LLVM_PROFDATA NAMES llvm-profdata)
+        if(LLVM_PROFDATA)
+            add_custom_target(pgo-merge
+                              COMMAND ${LLVM_PROFDATA} merge -output=${ORTABLE_PGO_PROFDATA} ${ORTABLE_PGO_DIR}/*.profraw
+                              COMMENT "Merging the PGO profiles"
+                              VERBATIM)
+        endif()
+    endif()
+endif()
+
+# Applies the profile to a target: PGO flags for every target, -march from <Target>_ARCH
+function(ortable_performance_profile target)
+    if(ORTABLE_PGO_FLAGS)
+        target_compile_options(${target} PRIVATE ${ORTABLE_PGO_FLAGS})
+        # Static libraries are linked into the executables, which need the flags for the runtime
+        get_target_property(targetType ${target} TYPE)
+        if(NOT targetType STREQUAL "STATIC_LIBRARY")
+            target_link_libraries(${target} PRIVATE ${ORTABLE_PGO_FLAGS})
+        endif()
+    endif()
+
+    set(${target}_ARCH "" CACHE STRING "-march of ${target}, empty for the compiler default")
+    if(ORTABLE_PERFORMANCE_PROFILE AND ${target}_ARCH)
+        if(MSVC)
+            set(arch ${${target}_ARCH})
+            if(arch STREQUAL "x86-64-v3")
+                set(arch AVX2)
+            elseif(arch STREQUAL "x86-64-v4")
+                set(arch AVX512)
+            elseif(arch STREQUAL "x86-64" OR arch STREQUAL "x86-64-v2")
+                set(arch "")
+            endif()
+            if(arch)
+                target_compile_options(${target} PRIVATE /arch:${arch})
+            endif()
+        else()
+            target_compile_options(${target} PRIVATE -march=${${target}_ARCH})
+        endif()
+    endif()
+endfunction()
+
+# Training run of step 2, after all targets are known
+function(ortable_add_pgo_training)
+    if(NOT ORTABLE_PGO STREQUAL "GENERATE")
+        return()
+    endif()
+    set(trainingCommands "")
+    if(TARGET ORTableConsumerBenchmark)
+        list(APPEND trainingCommands COMMAND $<TARGET_FILE:ORTableConsumerBenchmark> --reports 200000)
+    endif()
+    if(TARGET ORTableProviderBenchmark)
+        list(APPEND trainingCommands COMMAND $<TARGET_FILE:ORTableProviderBenchmark> --subscribers 1,10,50 --rates 100,500 --phase-duration 3)
+    endif()
+    # The benchmarks only cover the report paths, the provider run trains ORTableCore
+    if(TARGET ORTableDemoProvider)
+        set(simulator "")
+        if(TARGET ORTableControllerSimulator)
+            set(simulator -DSIMULATOR=$<TARGET_FILE:ORTableControllerSimulator>)
+        endif()
+        list(APPEND trainingCommands COMMAND ${CMAKE_COMMAND} -DPROVIDER=$<TARGET_FILE:ORTableDemoProvider> ${simulator}
+             -P ${ORTABLE_PGO_TRAIN_PROVIDER})
+    endif()
+    if(NOT trainingCommands)
+        message(WARNING "No training load for ORTABLE_PGO=GENERATE, enable ORTABLE_BENCHMARKS or build ORTableDemoProvider")
+        return()
+    endif()
+    add_custom_target(pgo-train ${trainingCommands}
+                      WORKING_DIRECTORY ${CMAKE_BINARY_DIR}/bin
+                      COMMENT "PGO training run, profiles go to ${ORTABLE_PGO_DIR}"
+                      VERBATIM)
+endfunction()
@@ -0,0 +1,41 @@
+################################################################################
+# PGO training run of the provider, script mode of the target pgo-train
+#
+# cmake -DPROVIDER=<file> [-DSIMULATOR=<file>] [-DDURATION=<s>] -P pgo_train_provider.cmake
+#   Runs ORTableDemoProvider for DURATION seconds (default 30): MDIB loading,
+#   the ValueUpdater with its alarm limits, the alert engine and aggregator.
+#   With SIMULATOR, the provider talks to ORTableControllerSimulator over a
+#   pseudo terminal, which adds the serial bridge and the frame parser. The
+#   simulator sends telemetry at a high rate and injects corrupted frames and
+#   garbage, so the resynchronization paths are trained as well.
+#
+#   The commands form one pipeline: the provider waits for a key on stdin and
+#   stops on end of file, which comes when the sleep in front of it exits.
+################################################################################
+if(NOT PROVIDER)
+    message(FATAL_ERROR "PROVIDER not set")
+endif()
+if(NOT DURATION)
+    set(DURATION 30)
+endif()
+# The provider outlives the simulator, so the final output of the simulator still finds a reader
+math(EXPR providerDuration "${DURATION} + 2")
+
+if(SIMULATOR)
+    # Script mode: relative to the working directory of pgo-train
+    set(device "${CMAKE_CURRENT_BINARY_DIR}/ortable-pgo-tty")
+    execute_process(COMMAND ${SIMULATOR} --link ${device} --duration ${DURATION} --idle-interval 10
+                            --telemetry-interval 10 --speed-factor 20 --corrupt-rate 0.01 --garbage-rate 0.01
+                    COMMAND ${CMAKE_COMMAND} -E sleep ${providerDuration}
+                    COMMAND ${CMAKE_COMMAND} -E env ORTABLE_SERIAL_DEVICE=${device} ${PROVIDER}
+                    RESULTS_VARIABLE results)
+else()
+    execute_process(COMMAND ${CMAKE_COMMAND} -E sleep ${providerDuration}
+                    COMMAND ${PROVIDER}
+                    RESULTS_VARIABLE results)
+endif()
+
+list(GET results -1 providerResult)
+if(NOT providerResult EQUAL 0)
+    message(FATAL_ERROR "Provider training run failed: ${results}")
+endif()